@@ -30,6 +30,14 @@ enum WebviewPermissionKind {
 
 enum WebviewPermissionDecision { none, allow, deny }
 
+/// The frame rate level chosen by the adaptive FPS governor.
+///
+/// [full] doesn't limit the frame rate.
+/// [reduced] limits it while frames are rarely consumed or rarely change.
+/// [idle] limits it further if that continues.
+// Order must match FpsGovernor::Level (see fps_governor.h)
+enum FpsGovernorLevel { full, reduced, idle }
+
 /// The policy for popup requests.
 ///
 /// [allow] allows popups and will create new windows.
@@ -49,6 +57,27 @@ enum WebviewPopupWindowPolicy { allow, deny, sameWindow }
 // Order must match WebviewHostResourceAccessKind (see webview.h)
 enum WebviewHostResourceAccessKind { deny, allow, denyCors }
 
+/// How frames are handed to the Flutter texture.
+///
+/// [gpuSurface] shares a DXGI surface with Flutter's compositor.
+/// [pixelBuffer] copies each frame into system memory, which is slower but
+/// works where Flutter can't use shared GPU surfaces.
+// Order must match TextureMode (see texture_bridge.h)
+enum TextureMode { gpuSurface, pixelBuffer }
+
+/// The format in which frames are captured.
+///
+/// [bgra8] is supported everywhere. [rgba16Float] keeps HDR content in
+/// linear scRGB. Readbacks such as [WebviewController.capturePixels] always
+/// return RGBA8.
+// Order must match PixelFormat (see util/pixel_format.h)
+enum FramePixelFormat {
+  bgra8,
+  @Deprecated('Frames are never captured as RGBA8, this is the same as bgra8.')
+  rgba8,
+  rgba16Float
+}
+
 enum WebErrorStatus {
   WebErrorStatusUnknown,
   WebErrorStatusCertificateCommonNameIsIncorrect,
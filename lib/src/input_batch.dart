@@ -0,0 +1,83 @@
+import 'dart:typed_data';
+
+import 'enums.dart';
+
+// Record kinds, must match InputBatch::Kind (see input_batch.h)
+const _kindCursorPos = 0;
+const _kindPointerUpdate = 1;
+const _kindPointerButton = 2;
+const _kindScrollDelta = 3;
+
+/// Packs input events into the record format decoded by the
+/// `sendInputBatch` method, see input_batch.h for the layout.
+class InputBatch {
+  static const recordSize = 48;
+
+  ByteData _data = ByteData(recordSize * 64);
+  int _length = 0;
+  int _lastSequence = 0;
+
+  bool get isEmpty => _length == 0;
+
+  /// The sequence number of the latest event added, 0 if none.
+  ///
+  /// Events are numbered from 1, wrapping around after 2^32 - 1.
+  int get lastSequence => _lastSequence;
+
+  void addCursorPos(double x, double y, Duration timeStamp) {
+    _add(_kindCursorPos, 0, 0, x, y, 0, 0, 0, timeStamp);
+  }
+
+  void addPointerUpdate(WebviewPointerEventKind kind, int pointer, double x,
+      double y, double size, double pressure, Duration timeStamp) {
+    _add(_kindPointerUpdate, kind.index, pointer, x, y, size, pressure, 0,
+        timeStamp);
+  }
+
+  void addPointerButton(
+      PointerButton button, bool isDown, Duration timeStamp) {
+    // Flutter's button bits: primary is 1, secondary 2 and tertiary 4.
+    final mask = button.index > 0 ? 1 << (button.index - 1) : 0;
+    _add(_kindPointerButton, button.index, 0, 0, 0, 0, 0, isDown ? mask : 0,
+        timeStamp);
+  }
+
+  /// [dx] and [dy] are in physical pixels.
+  void addScrollDelta(double dx, double dy, Duration timeStamp) {
+    _add(_kindScrollDelta, 0, 0, dx, dy, 0, 0, 0, timeStamp);
+  }
+
+  /// Returns the records added so far and starts a new batch.
+  Uint8List takeBytes() {
+    final bytes = Uint8List.fromList(
+        Uint8List.sublistView(_data, 0, _length));
+    _length = 0;
+    return bytes;
+  }
+
+  void _add(int kind, int event, int pointer, double x, double y,
+      double size, double pressure, int buttons, Duration timeStamp) {
+    if (_length + recordSize > _data.lengthInBytes) {
+      final grown = ByteData(_data.lengthInBytes * 2);
+      Uint8List.sublistView(grown)
+          .setRange(0, _length, Uint8List.sublistView(_data));
+      _data = grown;
+    }
+
+    _lastSequence = _lastSequence == 0xffffffff ? 1 : _lastSequence + 1;
+    final offset = _length;
+    _data
+      ..setUint8(offset, kind)
+      ..setUint8(offset + 1, event)
+      ..setUint16(offset + 2, 0, Endian.little)
+      ..setInt32(offset + 4, pointer, Endian.little)
+      ..setFloat64(offset + 8, x, Endian.little)
+      ..setFloat64(offset + 16, y, Endian.little)
+      ..setFloat32(offset + 24, size, Endian.little)
+      ..setFloat32(offset + 28, pressure, Endian.little)
+      ..setUint32(offset + 32, buttons, Endian.little)
+      ..setUint32(offset + 36, _lastSequence, Endian.little)
+      ..setInt64(offset + 40, timeStamp.inMicroseconds, Endian.little);
+    _length += recordSize;
+  }
+}
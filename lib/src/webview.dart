@@ -1,5 +1,6 @@
 import 'dart:async';
 import 'dart:convert';
+import 'dart:typed_data';
 import 'dart:ui';
 
 import 'package:flutter/gestures.dart';
@@ -9,6 +10,7 @@ import 'package:flutter/widgets.dart';
 
 import 'cursor.dart';
 import 'enums.dart';
+import 'input_batch.dart';
 
 class HistoryChanged {
   final bool canGoBack;
@@ -31,6 +33,236 @@ class WebviewDownloadEvent {
   );
 }
 
+class FpsGovernorDecision {
+  final FpsGovernorLevel level;
+
+  /// The frame rate cap applied at [level], [null] if uncapped.
+  final double? maxFps;
+  const FpsGovernorDecision(this.level, this.maxFps);
+}
+
+/// A histogram of durations with power-of-two buckets.
+class LatencyHistogram {
+  final int count;
+  final Duration mean;
+  final Duration max;
+
+  /// Percentiles, rounded up to the upper limit of their bucket.
+  final Duration p50;
+  final Duration p90;
+  final Duration p99;
+
+  /// The exclusive upper limits of all buckets but the last, open-ended one.
+  final List<Duration> bucketLimits;
+  final List<int> bucketCounts;
+
+  const LatencyHistogram(this.count, this.mean, this.max, this.p50, this.p90,
+      this.p99, this.bucketLimits, this.bucketCounts);
+
+  factory LatencyHistogram._fromMap(Map<dynamic, dynamic> map) {
+    return LatencyHistogram(
+      map['count'],
+      Duration(microseconds: map['meanUs']),
+      Duration(microseconds: map['maxUs']),
+      Duration(microseconds: map['p50Us']),
+      Duration(microseconds: map['p90Us']),
+      Duration(microseconds: map['p99Us']),
+      (map['bucketLimitsUs'] as List<dynamic>)
+          .map((e) => Duration(microseconds: e))
+          .toList(),
+      (map['bucketCounts'] as List<dynamic>).cast<int>(),
+    );
+  }
+}
+
+/// Counters describing the frame pipeline of a [WebviewController] since it
+/// was created.
+class FrameStats {
+  final int framesArrived;
+
+  /// Frames dropped due to the FPS limit.
+  final int framesDropped;
+
+  /// Frames Flutter wasn't asked to draw since they looked the same as the
+  /// previous one. See `suppressStaticFrames` in
+  /// [WebviewController.initialize].
+  final int framesSuppressed;
+
+  /// How often Flutter was asked to draw a new frame.
+  final int framesSignaled;
+
+  /// Requests to draw a new frame which were merged into a previous one,
+  /// since Flutter hadn't picked that one up yet.
+  final int signalsCoalesced;
+
+  /// How often Flutter asked for the texture.
+  final int descriptorRequests;
+  final int copiesMade;
+
+  /// Texture requests served without a copy since the texture already
+  /// contained the latest frame.
+  final int copiesSkipped;
+  final int resizeRecreations;
+
+  /// Tiles compared against the previous frame and how many of them had
+  /// changed. With [TextureMode.gpuSurface], only frames whose tiles were
+  /// fingerprinted in time count.
+  final int tilesChecked;
+  final int tilesDirty;
+
+  /// Resize requests received from [WebviewController] and how many of them
+  /// were collapsed into a later one, so that resizing happens at most once
+  /// per frame.
+  final int resizesRequested;
+  final int resizesCollapsed;
+
+  /// Input events received and how many pointer moves were merged into a
+  /// later one, since the WebView hadn't rendered a frame in between.
+  final int inputEventsQueued;
+  final int inputEventsCoalesced;
+
+  /// Time from a frame being captured to it being copied into the texture.
+  final LatencyHistogram captureToDescriptorLatency;
+
+  /// How late frames were shown which looked unchanged at first but turned
+  /// out to differ from the previous one. See `suppressStaticFrames` in
+  /// [WebviewController.initialize].
+  final LatencyHistogram heldFrameLatency;
+
+  const FrameStats(
+      this.framesArrived,
+      this.framesDropped,
+      this.framesSuppressed,
+      this.framesSignaled,
+      this.signalsCoalesced,
+      this.descriptorRequests,
+      this.copiesMade,
+      this.copiesSkipped,
+      this.resizeRecreations,
+      this.tilesChecked,
+      this.tilesDirty,
+      this.resizesRequested,
+      this.resizesCollapsed,
+      this.inputEventsQueued,
+      this.inputEventsCoalesced,
+      this.captureToDescriptorLatency,
+      this.heldFrameLatency);
+
+  factory FrameStats._fromMap(Map<dynamic, dynamic> map) {
+    return FrameStats(
+      map['framesArrived'],
+      map['framesDropped'],
+      map['framesSuppressed'],
+      map['framesSignaled'],
+      map['signalsCoalesced'],
+      map['descriptorRequests'],
+      map['copiesMade'],
+      map['copiesSkipped'],
+      map['resizeRecreations'],
+      map['tilesChecked'],
+      map['tilesDirty'],
+      map['resizesRequested'],
+      map['resizesCollapsed'],
+      map['inputEventsQueued'],
+      map['inputEventsCoalesced'],
+      LatencyHistogram._fromMap(map['captureToDescriptorLatency']),
+      LatencyHistogram._fromMap(map['heldFrameLatency']),
+    );
+  }
+}
+
+/// Time from input reaching a [WebviewController] to the first frame captured
+/// after the WebView received it, split into stages.
+class InputLatencyStats {
+  final int inputsReceived;
+
+  /// Input followed by a frame and input no frame followed in time, usually
+  /// because it didn't change anything visible or the WebView was gone.
+  final int inputsMatched;
+  final int inputsUnmatched;
+
+  /// The [WebviewController.lastInputSequence] of the latest input matched to
+  /// a frame, 0 if none.
+  final int lastMatchedSequence;
+
+  /// From the event's timestamp to the plugin receiving it. Only recorded for
+  /// input sent along with its timestamp.
+  final LatencyHistogram deliveryLatency;
+
+  /// From the plugin receiving the input to sending it to the WebView.
+  final LatencyHistogram queueLatency;
+
+  /// From sending the input to the WebView to the next frame being captured.
+  final LatencyHistogram renderLatency;
+
+  /// From the event's timestamp, if known, to the next frame being captured.
+  final LatencyHistogram totalLatency;
+
+  const InputLatencyStats(
+      this.inputsReceived,
+      this.inputsMatched,
+      this.inputsUnmatched,
+      this.lastMatchedSequence,
+      this.deliveryLatency,
+      this.queueLatency,
+      this.renderLatency,
+      this.totalLatency);
+
+  factory InputLatencyStats._fromMap(Map<dynamic, dynamic> map) {
+    return InputLatencyStats(
+      map['inputsReceived'],
+      map['inputsMatched'],
+      map['inputsUnmatched'],
+      map['lastMatchedSequence'],
+      LatencyHistogram._fromMap(map['deliveryLatency']),
+      LatencyHistogram._fromMap(map['queueLatency']),
+      LatencyHistogram._fromMap(map['renderLatency']),
+      LatencyHistogram._fromMap(map['totalLatency']),
+    );
+  }
+}
+
+/// Pixels read back by [WebviewController.capturePixels].
+class CapturedPixels {
+  final int width;
+  final int height;
+
+  /// Tightly packed RGBA, suitable for [decodeImageFromPixels] with
+  /// [PixelFormat.rgba8888].
+  final Uint8List pixels;
+
+  const CapturedPixels(this.width, this.height, this.pixels);
+
+  factory CapturedPixels._fromMap(Map<dynamic, dynamic> map) {
+    return CapturedPixels(map['width'], map['height'], map['pixels']);
+  }
+}
+
+class GpuMemoryUsage {
+  /// The budget set by [WebviewController.setGpuMemoryBudget], [null] if
+  /// unlimited.
+  final int? budget;
+  final int total;
+
+  /// Bytes held by each WebView, keyed by [WebviewController.textureId].
+  final Map<int, int> instances;
+  const GpuMemoryUsage(this.budget, this.total, this.instances);
+}
+
+/// How often touch input could reuse a pointer object of the WebView
+/// environment instead of creating one.
+class PointerInfoPoolStats {
+  final int hits;
+  final int misses;
+  final int failures;
+
+  /// Objects assigned to touch points in contact and objects kept for reuse.
+  final int active;
+  final int idle;
+  const PointerInfoPoolStats(
+      this.hits, this.misses, this.failures, this.active, this.idle);
+}
+
 typedef PermissionRequestedDelegate
     = FutureOr<WebviewPermissionDecision> Function(
         String url, WebviewPermissionKind permissionKind, bool isUserInitiated);
@@ -106,14 +338,57 @@ class WebviewController extends ValueNotifier<WebviewValue> {
     return _pluginChannel.invokeMethod<String>('getWebViewVersion');
   }
 
+  /// Limits the video memory held by all WebViews to [bytes].
+  ///
+  /// While over budget, cached surfaces are released first, followed by all
+  /// resources of suspended WebViews and of WebViews whose visible rect is
+  /// empty (see [WebviewController.setVisibleRect]), which get recreated once
+  /// shown again. Passing [null] removes the limit.
+  static Future<void> setGpuMemoryBudget(int? bytes) async {
+    return _pluginChannel.invokeMethod('setGpuMemoryBudget', bytes);
+  }
+
+  /// Returns the video memory held by all WebViews.
+  static Future<GpuMemoryUsage> getGpuMemoryUsage() async {
+    final map = await _pluginChannel
+        .invokeMapMethod<String, dynamic>('getGpuMemoryUsage');
+    return GpuMemoryUsage(
+        map!['budget'],
+        map['total'],
+        (map['instances'] as Map<dynamic, dynamic>)
+            .map((key, value) => MapEntry(key as int, value as int)));
+  }
+
+  /// Returns [null] until the WebView environment is initialized.
+  static Future<PointerInfoPoolStats?> getPointerInfoPoolStats() async {
+    final map = await _pluginChannel
+        .invokeMapMethod<String, dynamic>('getPointerInfoPoolStats');
+    return map != null
+        ? PointerInfoPoolStats(map['hits'], map['misses'], map['failures'],
+            map['active'], map['idle'])
+        : null;
+  }
+
   late Completer<void> _creatingCompleter;
   int _textureId = 0;
+  FramePixelFormat _pixelFormat = FramePixelFormat.bgra8;
   bool _isDisposed = false;
 
   Future<void> get ready => _creatingCompleter.future;
 
+  /// Identifies this WebView, e.g. in [GpuMemoryUsage.instances].
+  int get textureId => _textureId;
+
+  /// The format frames are captured in, negotiated from the one requested
+  /// in [initialize].
+  FramePixelFormat get pixelFormat => _pixelFormat;
+
   PermissionRequestedDelegate? _permissionRequested;
 
+  // Input events are sent once the current pointer packet is dispatched.
+  final InputBatch _inputBatch = InputBatch();
+  bool _inputFlushScheduled = false;
+
   late MethodChannel _methodChannel;
   late EventChannel _eventChannel;
   StreamSubscription? _eventStreamSubscription;
@@ -181,19 +456,78 @@ class WebviewController extends ValueNotifier<WebviewValue> {
   Stream<bool> get containsFullScreenElementChanged =>
       _containsFullScreenElementChangedStreamController.stream;
 
+  final StreamController<FpsGovernorDecision>
+      _fpsGovernorDecisionStreamController =
+      StreamController<FpsGovernorDecision>.broadcast();
+
+  /// A stream reflecting the decisions of the adaptive FPS governor.
+  ///
+  /// See [setAdaptiveFps].
+  Stream<FpsGovernorDecision> get fpsGovernorDecision =>
+      _fpsGovernorDecisionStreamController.stream;
+
+  final StreamController<FrameStats> _frameStatsStreamController =
+      StreamController<FrameStats>.broadcast();
+
+  /// A stream of frame statistics.
+  ///
+  /// See [setFrameStatsInterval].
+  Stream<FrameStats> get frameStats => _frameStatsStreamController.stream;
+
+  final StreamController<CapturedPixels> _thumbnailStreamController =
+      StreamController<CapturedPixels>.broadcast();
+
+  /// A stream of thumbnails.
+  ///
+  /// See [setThumbnailMode].
+  Stream<CapturedPixels> get thumbnails => _thumbnailStreamController.stream;
+
   WebviewController() : super(WebviewValue.uninitialized());
 
   /// Initializes the underlying platform view.
-  Future<void> initialize() async {
+  ///
+  /// [frameBufferCount] sets how many captured frames are buffered between
+  /// the WebView and the Flutter texture (1 = single, 2 = double,
+  /// 3 = triple buffering). Deeper buffering reduces dropped frames on busy
+  /// pages at the cost of some video memory. Valid values are 1 to 4.
+  ///
+  /// With [freeThreadedCapture], captured frames are received and paced on a
+  /// dedicated thread rather than the platform thread, which keeps the
+  /// platform thread responsive when many WebViews are visible.
+  ///
+  /// [textureMode] selects how frames are handed to the Flutter texture.
+  ///
+  /// With [suppressStaticFrames], captured frames are fingerprinted and
+  /// Flutter only redraws the texture if the content changed. Frames are
+  /// still redrawn at least once per second in case a change was too subtle
+  /// to be detected. The first change after a static period is shown a
+  /// little late, once the frame's fingerprint is known, which
+  /// [FrameStats.heldFrameLatency] measures.
+  ///
+  /// [pixelFormat] requests the format frames are captured in. See
+  /// [WebviewController.pixelFormat] for the one actually used.
+  Future<void> initialize(
+      {int frameBufferCount = 1,
+      bool freeThreadedCapture = false,
+      TextureMode textureMode = TextureMode.gpuSurface,
+      bool suppressStaticFrames = false,
+      FramePixelFormat pixelFormat = FramePixelFormat.bgra8}) async {
     if (_isDisposed) {
       return Future<void>.value();
     }
     _creatingCompleter = Completer<void>();
     try {
-      final reply =
-          await _pluginChannel.invokeMapMethod<String, dynamic>('initialize');
+      final reply = await _pluginChannel.invokeMapMethod<String, dynamic>(
+          'initialize', <String, dynamic>{
+        'frameBufferCount': frameBufferCount,
+        'freeThreadedCapture': freeThreadedCapture,
+        'textureMode': textureMode.index,
+        'suppressStaticFrames': suppressStaticFrames,
+        'pixelFormat': pixelFormat.index,
+      });
 
       _textureId = reply!['textureId'];
+      _pixelFormat = FramePixelFormat.values[reply['pixelFormat']];
       _methodChannel = MethodChannel('$_pluginChannelPrefix/$_textureId');
       _eventChannel = EventChannel('$_pluginChannelPrefix/$_textureId/events');
       _eventStreamSubscription =
@@ -246,6 +580,19 @@ class WebviewController extends ValueNotifier<WebviewValue> {
           case 'containsFullScreenElementChanged':
             _containsFullScreenElementChangedStreamController.add(map['value']);
             break;
+          case 'fpsGovernorChanged':
+            final value = FpsGovernorDecision(
+                FpsGovernorLevel.values[map['value']['level']],
+                map['value']['maxFps']);
+            _fpsGovernorDecisionStreamController.add(value);
+            break;
+          case 'frameStats':
+            _frameStatsStreamController.add(FrameStats._fromMap(map['value']));
+            break;
+          case 'thumbnail':
+            _thumbnailStreamController
+                .add(CapturedPixels._fromMap(map['value']));
+            break;
         }
       });
 
@@ -544,44 +891,269 @@ class WebviewController extends ValueNotifier<WebviewValue> {
     return _methodChannel.invokeMethod('setFpsLimit', maxFps);
   }
 
-  /// Sends a Pointer (Touch) update
-  Future<void> _setPointerUpdate(WebviewPointerEventKind kind, int pointer,
-      Offset position, double size, double pressure) async {
+  /// Tells the plugin which part of the WebView is on screen, in physical
+  /// pixels relative to its top left corner, e.g. while it's partially
+  /// scrolled out of view in a list.
+  ///
+  /// Only the visible part of each frame is copied into the texture, so
+  /// the rest of it may show stale content and must be clipped. While [rect]
+  /// is empty, Flutter isn't asked to redraw the texture at all. Passing
+  /// [null] marks the whole WebView as visible again.
+  Future<void> setVisibleRect(Rect? rect) async {
     if (_isDisposed) {
       return;
     }
     assert(value.isInitialized);
-    return _methodChannel.invokeMethod('setPointerUpdate',
-        [pointer, kind.index, position.dx, position.dy, size, pressure]);
+    if (rect == null) {
+      return _methodChannel.invokeMethod('setVisibleRect', null);
+    }
+
+    // Round outwards to whole pixels and drop the part left of or above
+    // the WebView.
+    const maxInt32 = 0x7fffffff;
+    final left = rect.left.floor().clamp(0, maxInt32);
+    final top = rect.top.floor().clamp(0, maxInt32);
+    final right = rect.right.ceil().clamp(left, maxInt32);
+    final bottom = rect.bottom.ceil().clamp(top, maxInt32);
+    return _methodChannel.invokeMethod(
+        'setVisibleRect', [left, top, right - left, bottom - top]);
   }
 
-  /// Moves the virtual cursor to [position].
-  Future<void> _setCursorPos(Offset position) async {
+  /// Lets the frame rate drop automatically while the WebView's frames
+  /// aren't consumed or its content rarely changes.
+  ///
+  /// Input and navigation restore the full frame rate. A limit set by
+  /// [setFpsLimit] still applies on top.
+  Future<void> setAdaptiveFps(bool enabled) async {
     if (_isDisposed) {
       return;
     }
     assert(value.isInitialized);
-    return _methodChannel
-        .invokeMethod('setCursorPos', [position.dx, position.dy]);
+    return _methodChannel.invokeMethod('setAdaptiveFps', enabled);
   }
 
-  /// Indicates whether the specified [button] is currently down.
-  Future<void> _setPointerButtonState(PointerButton button, bool isDown) async {
+  /// Lets the WebView render at a reduced resolution while it's being
+  /// resized or can't keep up with its animations.
+  ///
+  /// The texture gets upscaled in the meantime and full resolution returns
+  /// shortly after things settle down.
+  Future<void> setDynamicResolution(bool enabled) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod('setDynamicResolution', enabled);
+  }
+
+  /// Returns statistics about the frames captured from the WebView.
+  Future<FrameStats?> getFrameStats() async {
+    if (_isDisposed) {
+      return null;
+    }
+    assert(value.isInitialized);
+    final map = await _methodChannel
+        .invokeMethod<Map<dynamic, dynamic>>('getFrameStats');
+    return map != null ? FrameStats._fromMap(map) : null;
+  }
+
+  /// The sequence number of the latest input event queued for the WebView, to
+  /// compare with [InputLatencyStats.lastMatchedSequence]. 0 if none.
+  int get lastInputSequence => _inputBatch.lastSequence;
+
+  /// Returns how long input took to show up in a captured frame.
+  Future<InputLatencyStats?> getInputLatency() async {
+    if (_isDisposed) {
+      return null;
+    }
+    assert(value.isInitialized);
+    final map = await _methodChannel
+        .invokeMethod<Map<dynamic, dynamic>>('getInputLatency');
+    return map != null ? InputLatencyStats._fromMap(map) : null;
+  }
+
+  /// Publishes [FrameStats] on [frameStats] every [interval].
+  ///
+  /// Passing [null] stops publishing.
+  Future<void> setFrameStatsInterval(Duration? interval) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod(
+        'setFrameStatsInterval', interval?.inMilliseconds ?? 0);
+  }
+
+  /// Reads back the newest frame captured from the WebView, which may not
+  /// have been drawn by Flutter yet.
+  ///
+  /// The frame is copied on the GPU and read back once the copy finished,
+  /// so this doesn't stall rendering. Throws a [PlatformException] if no
+  /// frame has been captured yet or the WebView is suspended.
+  Future<CapturedPixels?> capturePixels() async {
+    if (_isDisposed) {
+      return null;
+    }
+    assert(value.isInitialized);
+    final map = await _methodChannel
+        .invokeMapMethod<dynamic, dynamic>('capturePixels');
+    return map != null ? CapturedPixels._fromMap(map) : null;
+  }
+
+  /// Publishes downscaled copies of the WebView's content on [thumbnails].
+  ///
+  /// Thumbnails fit into [maxSize], in physical pixels, and are refreshed
+  /// every [interval], independently of the frame rate. They are scaled on
+  /// the CPU, which is far cheaper than scaling the full-size texture in
+  /// Flutter when many WebViews are shown at once.
+  ///
+  /// Passing [null] stops publishing.
+  Future<void> setThumbnailMode(Size? maxSize,
+      {Duration interval = const Duration(seconds: 1)}) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod(
+        'setThumbnailMode',
+        maxSize != null
+            ? [
+                maxSize.width.round(),
+                maxSize.height.round(),
+                interval.inMilliseconds
+              ]
+            : null);
+  }
+
+  /// Starts recording the last [duration] of frames into a ring file at
+  /// [path] for diagnostics.
+  ///
+  /// Frames are downscaled to fit into [maxSize], in physical pixels, and
+  /// sampled [framesPerSecond] times per second. The file is preallocated
+  /// for the whole duration and overwritten once full. A recording already
+  /// in progress is replaced.
+  ///
+  /// [maxSize] is limited to 4096 pixels in either dimension, [duration] to
+  /// 10 minutes and the file to 1 GiB. Exceeding them throws a
+  /// [PlatformException].
+  ///
+  /// Use [dumpFrameRecording] to save a consistent copy and
+  /// `tool/extract_frames.dart` to turn it into PNG files.
+  Future<void> startFrameRecording(String path,
+      {Size maxSize = const Size(640, 360),
+      int framesPerSecond = 10,
+      Duration duration = const Duration(seconds: 10)}) async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod('startFrameRecording', [
+      path,
+      maxSize.width.round(),
+      maxSize.height.round(),
+      framesPerSecond,
+      duration.inSeconds
+    ]);
+  }
+
+  /// Stops recording frames. The ring file is left in place.
+  Future<void> stopFrameRecording() async {
+    if (_isDisposed) {
+      return;
+    }
+    assert(value.isInitialized);
+    return _methodChannel.invokeMethod('stopFrameRecording');
+  }
+
+  /// Copies the frames recorded so far to [path].
+  ///
+  /// Throws a [PlatformException] if no recording is in progress or it is
+  /// stopped before the copy is complete.
+  Future<void> dumpFrameRecording(String path) async {
     if (_isDisposed) {
       return;
     }
     assert(value.isInitialized);
-    return _methodChannel.invokeMethod('setPointerButton',
-        <String, dynamic>{'button': button.index, 'isDown': isDown});
+    return _methodChannel.invokeMethod('dumpFrameRecording', path);
   }
 
-  /// Sets the horizontal and vertical scroll delta.
-  Future<void> _setScrollDelta(double dx, double dy) async {
+  /// Returns the regions, in physical pixels, in which the frame last shown
+  /// differed from the one before.
+  ///
+  /// With [TextureMode.gpuSurface], changes are detected from averages of
+  /// 64x64 pixel tiles, so subtle ones may be missed, and the whole frame
+  /// counts as changed if those weren't computed in time. Returns [null] if
+  /// the [TextureMode] doesn't track changed regions.
+  Future<List<Rect>?> getDirtyRects() async {
+    if (_isDisposed) {
+      return null;
+    }
+    assert(value.isInitialized);
+    final list =
+        await _methodChannel.invokeListMethod<dynamic>('getDirtyRects');
+    return list
+        ?.map((rect) => Rect.fromLTWH(
+            (rect['x'] as int).toDouble(),
+            (rect['y'] as int).toDouble(),
+            (rect['width'] as int).toDouble(),
+            (rect['height'] as int).toDouble()))
+        .toList();
+  }
+
+  /// Sends a Pointer (Touch) update
+  void _setPointerUpdate(WebviewPointerEventKind kind, int pointer,
+      Offset position, double size, double pressure, Duration timeStamp) {
+    _inputBatch.addPointerUpdate(
+        kind, pointer, position.dx, position.dy, size, pressure, timeStamp);
+    _scheduleInputFlush();
+  }
+
+  /// Moves the virtual cursor to [position].
+  void _setCursorPos(Offset position, Duration timeStamp) {
+    _inputBatch.addCursorPos(position.dx, position.dy, timeStamp);
+    _scheduleInputFlush();
+  }
+
+  /// Indicates whether the specified [button] is currently down.
+  void _setPointerButtonState(
+      PointerButton button, bool isDown, Duration timeStamp) {
+    _inputBatch.addPointerButton(button, isDown, timeStamp);
+    _scheduleInputFlush();
+  }
+
+  /// Sets the horizontal and vertical scroll delta, in logical pixels of a
+  /// view with the given [devicePixelRatio].
+  void _setScrollDelta(
+      double dx, double dy, double devicePixelRatio, Duration timeStamp) {
+    // Undo the framework's conversion to logical pixels, so that the native
+    // side can recover whole wheel notches.
+    _inputBatch.addScrollDelta(
+        dx * devicePixelRatio, dy * devicePixelRatio, timeStamp);
+    _scheduleInputFlush();
+  }
+
+  /// Sends all input events of the pointer packet being dispatched in one
+  /// call, rather than one call per event.
+  void _scheduleInputFlush() {
+    if (_inputFlushScheduled) {
+      return;
+    }
+    _inputFlushScheduled = true;
+    scheduleMicrotask(() {
+      _inputFlushScheduled = false;
+      unawaited(_flushInput());
+    });
+  }
+
+  Future<void> _flushInput() async {
+    if (_inputBatch.isEmpty) {
+      return;
+    }
+    final bytes = _inputBatch.takeBytes();
     if (_isDisposed) {
       return;
     }
     assert(value.isInitialized);
-    return _methodChannel.invokeMethod('setScrollDelta', [dx, dy]);
+    return _methodChannel.invokeMethod('sendInputBatch', bytes);
   }
 
   /// Sets the surface size to the provided [size].
@@ -666,6 +1238,9 @@ class _WebviewState extends State<Webview> {
   }
 
   Widget _buildInner() {
+    // The ratio of the view the webview is shown in, which Flutter used to
+    // convert the pointer events to logical pixels.
+    final devicePixelRatio = MediaQuery.of(context).devicePixelRatio;
     return NotificationListener<SizeChangedLayoutNotification>(
         onNotification: (notification) {
           _reportSurfaceSize();
@@ -681,7 +1256,8 @@ class _WebviewState extends State<Webview> {
                         // Ignoring hover events on touch for now
                         return;
                       }
-                      _controller._setCursorPos(ev.localPosition);
+                      _controller._setCursorPos(
+                          ev.localPosition, ev.timeStamp);
                     },
                     onPointerDown: (ev) {
                       _pointerKind = ev.kind;
@@ -691,12 +1267,14 @@ class _WebviewState extends State<Webview> {
                             ev.pointer,
                             ev.localPosition,
                             ev.size,
-                            ev.pressure);
+                            ev.pressure,
+                            ev.timeStamp);
                         return;
                       }
                       final button = getButton(ev.buttons);
                       _downButtons[ev.pointer] = button;
-                      _controller._setPointerButtonState(button, true);
+                      _controller._setPointerButtonState(
+                          button, true, ev.timeStamp);
                     },
                     onPointerUp: (ev) {
                       _pointerKind = ev.kind;
@@ -706,19 +1284,34 @@ class _WebviewState extends State<Webview> {
                             ev.pointer,
                             ev.localPosition,
                             ev.size,
-                            ev.pressure);
+                            ev.pressure,
+                            ev.timeStamp);
                         return;
                       }
                       final button = _downButtons.remove(ev.pointer);
                       if (button != null) {
-                        _controller._setPointerButtonState(button, false);
+                        _controller._setPointerButtonState(
+                            button, false, ev.timeStamp);
                       }
                     },
                     onPointerCancel: (ev) {
                       _pointerKind = ev.kind;
+                      if (ev.kind == PointerDeviceKind.touch) {
+                        // Lift the touch point so that WebView2 doesn't
+                        // consider it in contact anymore.
+                        _controller._setPointerUpdate(
+                            WebviewPointerEventKind.up,
+                            ev.pointer,
+                            ev.localPosition,
+                            ev.size,
+                            ev.pressure,
+                            ev.timeStamp);
+                        return;
+                      }
                       final button = _downButtons.remove(ev.pointer);
                       if (button != null) {
-                        _controller._setPointerButtonState(button, false);
+                        _controller._setPointerButtonState(
+                            button, false, ev.timeStamp);
                       }
                     },
                     onPointerMove: (ev) {
@@ -729,22 +1322,29 @@ class _WebviewState extends State<Webview> {
                             ev.pointer,
                             ev.localPosition,
                             ev.size,
-                            ev.pressure);
+                            ev.pressure,
+                            ev.timeStamp);
                       } else {
-                        _controller._setCursorPos(ev.localPosition);
+                        _controller._setCursorPos(
+                            ev.localPosition, ev.timeStamp);
                       }
                     },
                     onPointerSignal: (signal) {
                       if (signal is PointerScrollEvent) {
                         _controller._setScrollDelta(
-                            -signal.scrollDelta.dx, -signal.scrollDelta.dy);
+                            -signal.scrollDelta.dx,
+                            -signal.scrollDelta.dy,
+                            devicePixelRatio,
+                            signal.timeStamp);
                       }
                     },
                     onPointerPanZoomUpdate: (signal) {
                       if (signal.panDelta.dx.abs() > signal.panDelta.dy.abs()) {
-                        _controller._setScrollDelta(-signal.panDelta.dx, 0);
+                        _controller._setScrollDelta(-signal.panDelta.dx, 0,
+                            devicePixelRatio, signal.timeStamp);
                       } else {
-                        _controller._setScrollDelta(0, signal.panDelta.dy);
+                        _controller._setScrollDelta(0, signal.panDelta.dy,
+                            devicePixelRatio, signal.timeStamp);
                       }
                     },
                     child: MouseRegion(
@@ -0,0 +1,141 @@
+// Extracts the frames stored by WebviewController.startFrameRecording into
+// PNG files.
+//
+// Usage: dart run tool/extract_frames.dart <recording> <output directory>
+//
+// See windows/frame_recorder.h for the file format.
+
+import 'dart:io';
+import 'dart:typed_data';
+
+const _magic = 'WVFRAMES';
+const _version = 1;
+const _pixelFormatRgba = 1;
+
+class _Frame {
+  final int sequence;
+  final int timestampUs;
+  final int width;
+  final int height;
+  final Uint8List pixels;
+
+  _Frame(this.sequence, this.timestampUs, this.width, this.height,
+      this.pixels);
+}
+
+List<_Frame> _readFrames(Uint8List bytes) {
+  final data = ByteData.sublistView(bytes);
+  if (bytes.length < 64 ||
+      String.fromCharCodes(bytes.sublist(0, 8)) != _magic) {
+    throw const FormatException('Not a frame recording');
+  }
+
+  final version = data.getUint32(8, Endian.little);
+  final headerSize = data.getUint32(12, Endian.little);
+  final slotHeaderSize = data.getUint32(16, Endian.little);
+  final slotCount = data.getUint32(20, Endian.little);
+  final slotSize = data.getUint32(24, Endian.little);
+  final pixelFormat = data.getUint32(36, Endian.little);
+  if (version != _version || pixelFormat != _pixelFormatRgba) {
+    throw FormatException('Unsupported version $version or format '
+        '$pixelFormat');
+  }
+  if (bytes.length < headerSize + slotCount * slotSize) {
+    throw const FormatException('Truncated recording');
+  }
+
+  final frames = <_Frame>[];
+  for (var i = 0; i < slotCount; i++) {
+    final offset = headerSize + i * slotSize;
+    final sequence = data.getUint64(offset, Endian.little);
+    if (sequence == 0) {
+      continue;
+    }
+    final width = data.getUint32(offset + 16, Endian.little);
+    final height = data.getUint32(offset + 20, Endian.little);
+    final length = width * height * 4;
+    if (slotHeaderSize + length > slotSize) {
+      throw FormatException('Slot $i exceeds the slot size');
+    }
+    final start = offset + slotHeaderSize;
+    frames.add(_Frame(
+        sequence,
+        data.getInt64(offset + 8, Endian.little),
+        width,
+        height,
+        Uint8List.sublistView(bytes, start, start + length)));
+  }
+  frames.sort((a, b) => a.sequence.compareTo(b.sequence));
+  return frames;
+}
+
+final _crcTable = List<int>.generate(256, (n) {
+  var c = n;
+  for (var k = 0; k < 8; k++) {
+    c = (c & 1) != 0 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+  }
+  return c;
+});
+
+int _crc32(List<int> bytes) {
+  var crc = 0xffffffff;
+  for (final byte in bytes) {
+    crc = _crcTable[(crc ^ byte) & 0xff] ^ (crc >> 8);
+  }
+  return crc ^ 0xffffffff;
+}
+
+void _writeChunk(BytesBuilder out, String type, List<int> payload) {
+  final length = ByteData(4)..setUint32(0, payload.length);
+  final body = [...type.codeUnits, ...payload];
+  final crc = ByteData(4)..setUint32(0, _crc32(body));
+  out
+    ..add(length.buffer.asUint8List())
+    ..add(body)
+    ..add(crc.buffer.asUint8List());
+}
+
+Uint8List _encodePng(_Frame frame) {
+  final header = ByteData(13)
+    ..setUint32(0, frame.width)
+    ..setUint32(4, frame.height)
+    ..setUint8(8, 8) // bit depth
+    ..setUint8(9, 6); // RGBA
+
+  // Every row is prefixed by filter type 0 (none).
+  final stride = frame.width * 4;
+  final raw = Uint8List((stride + 1) * frame.height);
+  for (var y = 0; y < frame.height; y++) {
+    raw.setRange(y * (stride + 1) + 1, (y + 1) * (stride + 1), frame.pixels,
+        y * stride);
+  }
+
+  final out = BytesBuilder(copy: false)
+    ..add(const [0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a]);
+  _writeChunk(out, 'IHDR', header.buffer.asUint8List());
+  _writeChunk(out, 'IDAT', ZLibEncoder().convert(raw));
+  _writeChunk(out, 'IEND', const []);
+  return out.takeBytes();
+}
+
+void main(List<String> args) {
+  if (args.length != 2) {
+    stderr.writeln(
+        'Usage: dart run tool/extract_frames.dart <recording> <output dir>');
+    exitCode = 64;
+    return;
+  }
+
+  final frames = _readFrames(File(args[0]).readAsBytesSync());
+  final directory = Directory(args[1])..createSync(recursive: true);
+  for (final frame in frames) {
+    final time =
+        DateTime.fromMicrosecondsSinceEpoch(frame.timestampUs, isUtc: true);
+    final name = 'frame_${frame.sequence.toString().padLeft(6, '0')}.png';
+    File('${directory.path}${Platform.pathSeparator}$name')
+        .writeAsBytesSync(_encodePng(frame));
+    stdout.writeln('$name ${frame.width}x${frame.height} '
+        '${time.toIso8601String()}');
+  }
+  stdout.writeln('Extracted ${frames.length} frames.');
+}
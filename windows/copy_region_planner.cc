@@ -0,0 +1,106 @@
+#include "copy_region_planner.h"
+
+#include <algorithm>
+
+CopyRegionPlanner::Rect CopyRegionPlanner::Intersect(const Rect& a,
+                                                     const Rect& b) {
+  // 64-bit, so that rects reaching past 2^32 don't wrap around.
+  const auto left = std::max<uint64_t>(a.x, b.x);
+  const auto top = std::max<uint64_t>(a.y, b.y);
+  const auto right = std::min<uint64_t>(uint64_t{a.x} + a.width,
+                                        uint64_t{b.x} + b.width);
+  const auto bottom = std::min<uint64_t>(uint64_t{a.y} + a.height,
+                                         uint64_t{b.y} + b.height);
+  if (left >= right || top >= bottom) {
+    return {};
+  }
+  return {static_cast<uint32_t>(left), static_cast<uint32_t>(top),
+          static_cast<uint32_t>(right - left),
+          static_cast<uint32_t>(bottom - top)};
+}
+
+std::vector<CopyRegionPlanner::Rect> CopyRegionPlanner::Subtract(
+    const Rect& a, const Rect& b) {
+  if (a.IsEmpty()) {
+    return {};
+  }
+  const auto overlap = Intersect(a, b);
+  if (overlap.IsEmpty()) {
+    return {a};
+  }
+
+  // Full-width bands above and below the overlap, then the parts left and
+  // right of it.
+  std::vector<Rect> result;
+  const auto a_bottom = a.y + a.height;
+  const auto overlap_bottom = overlap.y + overlap.height;
+  if (overlap.y > a.y) {
+    result.push_back({a.x, a.y, a.width, overlap.y - a.y});
+  }
+  if (a_bottom > overlap_bottom) {
+    result.push_back({a.x, overlap_bottom, a.width, a_bottom - overlap_bottom});
+  }
+  if (overlap.x > a.x) {
+    result.push_back({a.x, overlap.y, overlap.x - a.x, overlap.height});
+  }
+  const auto a_right = a.x + a.width;
+  const auto overlap_right = overlap.x + overlap.width;
+  if (a_right > overlap_right) {
+    result.push_back(
+        {overlap_right, overlap.y, a_right - overlap_right, overlap.height});
+  }
+  return result;
+}
+
+std::vector<CopyRegionPlanner::Rect> CopyRegionPlanner::Plan(
+    uint64_t generation, uint32_t width, uint32_t height,
+    const std::vector<Rect>* changed) {
+  const auto target = GetTarget(width, height);
+  std::vector<Rect> regions;
+  if (target.IsEmpty()) {
+    // Leave the surface as is, it's not shown anyway.
+  } else if (width != width_ || height != height_ ||
+             (generation != generation_ && !changed)) {
+    regions.push_back(target);
+  } else if (generation != generation_) {
+    // The rest of |valid_| already matches the new frame.
+    regions = Subtract(target, valid_);
+    for (const auto& rect : *changed) {
+      const auto region = Intersect(Intersect(rect, target), valid_);
+      if (!region.IsEmpty()) {
+        regions.push_back(region);
+      }
+    }
+  } else {
+    regions = Subtract(target, valid_);
+  }
+
+  generation_ = generation;
+  width_ = width;
+  height_ = height;
+  // Parts of |valid_| outside |target| are forgotten, which keeps it a
+  // single rect at the cost of occasionally copying them again.
+  valid_ = target;
+  return regions;
+}
+
+bool CopyRegionPlanner::IsUpToDate() const {
+  if (generation_ == 0) {
+    return false;
+  }
+  const auto target = GetTarget(width_, height_);
+  return target.IsEmpty() || Intersect(target, valid_) == target;
+}
+
+void CopyRegionPlanner::Invalidate() {
+  generation_ = 0;
+  width_ = 0;
+  height_ = 0;
+  valid_ = {};
+}
+
+CopyRegionPlanner::Rect CopyRegionPlanner::GetTarget(uint32_t width,
+                                                     uint32_t height) const {
+  const Rect frame = {0, 0, width, height};
+  return visible_ ? Intersect(*visible_, frame) : frame;
+}
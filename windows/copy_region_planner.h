@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Plans which parts of a captured frame have to be copied into the surface
+// shown by Flutter.
+//
+// Only the visible rect of each new frame is copied, to the same position in
+// the surface. The rest of the surface keeps stale content, which is fine as
+// long as it's clipped away. If the visible rect grows while the frame stays
+// the same, only the newly exposed parts are copied. If it's known which
+// parts of a new frame changed, only those and the newly exposed parts are.
+//
+// Not thread-safe.
+class CopyRegionPlanner {
+ public:
+  struct Rect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+
+    bool IsEmpty() const { return width == 0 || height == 0; }
+    bool operator==(const Rect& other) const {
+      return x == other.x && y == other.y && width == other.width &&
+             height == other.height;
+    }
+  };
+
+  // Returns the overlap of |a| and |b|, which is empty if there is none.
+  static Rect Intersect(const Rect& a, const Rect& b);
+
+  // Returns up to four disjoint rects covering the parts of |a| outside |b|.
+  static std::vector<Rect> Subtract(const Rect& a, const Rect& b);
+
+  // |rect| is in frame pixels, std::nullopt if the whole frame is visible.
+  void SetVisibleRect(const std::optional<Rect>& rect) { visible_ = rect; }
+  const std::optional<Rect>& visible_rect() const { return visible_; }
+
+  // Returns the regions of the |width| x |height| frame |generation| to copy
+  // and considers them copied. Empty if the surface is up to date or nothing
+  // is visible. |changed|, if given, covers all parts of |generation| which
+  // differ from the frame |generation()|.
+  std::vector<Rect> Plan(uint64_t generation, uint32_t width, uint32_t height,
+                         const std::vector<Rect>* changed = nullptr);
+
+  // Returns true if |Plan| has nothing to copy for the frame last planned.
+  bool IsUpToDate() const;
+
+  // Forgets what the surface holds, e.g. after it got replaced.
+  void Invalidate();
+
+  // The frame the surface holds parts of, 0 if none.
+  uint64_t generation() const { return generation_; }
+
+ private:
+  std::optional<Rect> visible_;
+  // The frame the surface holds parts of, 0 if none.
+  uint64_t generation_ = 0;
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  // The part of the surface holding |generation_|.
+  Rect valid_ = {};
+
+  // The visible part of a |width| x |height| frame.
+  Rect GetTarget(uint32_t width, uint32_t height) const;
+};
@@ -0,0 +1,76 @@
+#include "d3d_readback_device.h"
+
+#include <iostream>
+
+#include "util/d3dutil.h"
+
+D3DReadbackDevice::D3DReadbackDevice(const GraphicsContext* graphics_context,
+                                     util::PixelFormat pixel_format)
+    : graphics_context_(graphics_context),
+      format_(ToDxgiFormat(pixel_format)) {
+  graphics_context_->EnableMultithreadProtection();
+}
+
+std::optional<D3DReadbackDevice::Staging> D3DReadbackDevice::CreateStaging(
+    size_t width, size_t height) {
+  D3D11_TEXTURE2D_DESC desc = {};
+  desc.ArraySize = 1;
+  desc.MipLevels = 1;
+  desc.BindFlags = 0;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+  desc.Format = format_;
+  desc.Width = static_cast<UINT>(width);
+  desc.Height = static_cast<UINT>(height);
+  desc.MiscFlags = 0;
+  desc.SampleDesc.Count = 1;
+  desc.SampleDesc.Quality = 0;
+  desc.Usage = D3D11_USAGE_STAGING;
+
+  Staging staging;
+  if (FAILED(graphics_context_->d3d_device()->CreateTexture2D(
+          &desc, nullptr, staging.put()))) {
+    std::cerr << "Creating readback texture failed" << std::endl;
+    return std::nullopt;
+  }
+  return staging;
+}
+
+bool D3DReadbackDevice::Copy(const Source& source, Staging& staging,
+                             size_t width, size_t height) {
+  D3D11_TEXTURE2D_DESC desc;
+  source->GetDesc(&desc);
+  if (desc.Format != format_ || width > desc.Width ||
+      height > desc.Height) {
+    return false;
+  }
+
+  auto device_context = graphics_context_->d3d_device_context();
+  const D3D11_BOX box = {0, 0, 0, static_cast<UINT>(width),
+                         static_cast<UINT>(height), 1};
+  device_context->CopySubresourceRegion(staging.get(), 0, 0, 0, 0, source, 0,
+                                        &box);
+  // Get the copy going so that it has finished by the time it's polled.
+  device_context->Flush();
+  return true;
+}
+
+ReadbackMapStatus D3DReadbackDevice::TryMap(Staging& staging,
+                                            ReadbackMapping* mapping) {
+  D3D11_MAPPED_SUBRESOURCE mapped;
+  const auto hr = graphics_context_->d3d_device_context()->Map(
+      staging.get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+  if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+    return ReadbackMapStatus::kPending;
+  }
+  if (FAILED(hr)) {
+    return ReadbackMapStatus::kFailed;
+  }
+
+  mapping->data = static_cast<const uint8_t*>(mapped.pData);
+  mapping->stride = mapped.RowPitch;
+  return ReadbackMapStatus::kReady;
+}
+
+void D3DReadbackDevice::Unmap(Staging& staging) {
+  graphics_context_->d3d_device_context()->Unmap(staging.get(), 0);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <d3d11.h>
+#include <winrt/base.h>
+
+#include <optional>
+
+#include "graphics_context.h"
+#include "readback_scheduler.h"
+#include "util/pixel_format.h"
+
+// Implements the |ReadbackScheduler| device for Direct3D 11 textures.
+//
+// Used on the platform thread, so it enables multithread protection on the
+// shared device.
+class D3DReadbackDevice {
+ public:
+  typedef ID3D11Texture2D* Source;
+  typedef winrt::com_ptr<ID3D11Texture2D> Staging;
+
+  // Reads back textures in |pixel_format|.
+  D3DReadbackDevice(const GraphicsContext* graphics_context,
+                    util::PixelFormat pixel_format);
+
+  std::optional<Staging> CreateStaging(size_t width, size_t height);
+  bool Copy(const Source& source, Staging& staging, size_t width,
+            size_t height);
+  ReadbackMapStatus TryMap(Staging& staging, ReadbackMapping* mapping);
+  void Unmap(Staging& staging);
+
+ private:
+  const GraphicsContext* graphics_context_;
+  DXGI_FORMAT format_;
+};
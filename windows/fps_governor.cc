@@ -0,0 +1,106 @@
+#include "fps_governor.h"
+
+FpsGovernor::FpsGovernor(Clock clock) : FpsGovernor(Config{}, clock) {}
+
+FpsGovernor::FpsGovernor(const Config& config, Clock clock)
+    : config_(config), clock_(std::move(clock)) {}
+
+void FpsGovernor::SetEnabled(bool enabled) {
+  enabled_ = enabled;
+  window_start_.reset();
+  activity_until_.reset();
+  SetLevel(Level::kFull);
+}
+
+void FpsGovernor::OnFrameArrived(bool delivered) {
+  frames_arrived_++;
+  if (delivered) {
+    frames_delivered_++;
+  }
+}
+
+void FpsGovernor::OnFramesConsumed(uint64_t count) {
+  frames_consumed_ += count;
+}
+
+bool FpsGovernor::OnActivity() {
+  if (!enabled_) {
+    return false;
+  }
+
+  const auto now = clock_();
+  activity_until_ = now + config_.activity_hold;
+  ResetWindow(now);
+  return SetLevel(Level::kFull);
+}
+
+bool FpsGovernor::Update() {
+  if (!enabled_) {
+    return false;
+  }
+
+  const auto now = clock_();
+  if (!window_start_.has_value()) {
+    ResetWindow(now);
+    return false;
+  }
+
+  const auto elapsed = now - *window_start_;
+  if (elapsed < config_.window) {
+    return false;
+  }
+
+  if (activity_until_.has_value() && now < *activity_until_) {
+    ResetWindow(now);
+    return SetLevel(Level::kFull);
+  }
+
+  const auto seconds = std::chrono::duration<double>(elapsed).count();
+  const auto arrival_fps = frames_arrived_ / seconds;
+  const auto consumed_ratio =
+      frames_delivered_ > 0
+          ? static_cast<double>(frames_consumed_) / frames_delivered_
+          : 1.0;
+  ResetWindow(now);
+
+  const auto level = decision_.level;
+  if (consumed_ratio < config_.min_consumed_ratio ||
+      arrival_fps < config_.rare_arrival_fps) {
+    return SetLevel(level == Level::kFull ? Level::kReduced : Level::kIdle);
+  }
+
+  // The content produces frames faster than the cap allows and the consumer
+  // keeps up, so allow more.
+  if (decision_.max_fps.has_value() && arrival_fps > *decision_.max_fps) {
+    return SetLevel(level == Level::kIdle ? Level::kReduced : Level::kFull);
+  }
+
+  return false;
+}
+
+bool FpsGovernor::SetLevel(Level level) {
+  Decision decision = {level, std::nullopt};
+  switch (level) {
+    case Level::kReduced:
+      decision.max_fps = config_.reduced_fps;
+      break;
+    case Level::kIdle:
+      decision.max_fps = config_.idle_fps;
+      break;
+    default:
+      break;
+  }
+
+  if (decision == decision_) {
+    return false;
+  }
+  decision_ = decision;
+  return true;
+}
+
+void FpsGovernor::ResetWindow(TimePoint now) {
+  window_start_ = now;
+  frames_arrived_ = 0;
+  frames_delivered_ = 0;
+  frames_consumed_ = 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+// Lowers the capture rate of webviews whose frames aren't needed.
+//
+// Frame arrivals and consumption are sampled over fixed windows. The
+// governor steps down one level per window while most delivered frames go
+// unconsumed (e.g. the texture isn't painted) or frames arrive only rarely
+// (mostly static content), and steps back up while the content animates
+// and the consumer keeps up. Input and navigation snap it back to full rate
+// immediately and hold it there for a while.
+//
+// Not thread-safe.
+class FpsGovernor {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::function<TimePoint()> Clock;
+
+  enum class Level { kFull, kReduced, kIdle };
+
+  struct Decision {
+    Level level;
+    // The frame rate cap for |level|, std::nullopt for no cap.
+    std::optional<double> max_fps;
+
+    bool operator==(const Decision& other) const {
+      return level == other.level && max_fps == other.max_fps;
+    }
+  };
+
+  struct Config {
+    double reduced_fps = 30;
+    double idle_fps = 5;
+    std::chrono::milliseconds window{1000};
+    // How long to stay at full rate after input or navigation.
+    std::chrono::milliseconds activity_hold{2000};
+    // Step down if less than this share of delivered frames got consumed.
+    double min_consumed_ratio = 0.5;
+    // Step down if frames arrive at a lower rate than this.
+    double rare_arrival_fps = 2;
+  };
+
+  explicit FpsGovernor(Clock clock = std::chrono::steady_clock::now);
+  FpsGovernor(const Config& config, Clock clock);
+
+  void SetEnabled(bool enabled);
+  bool enabled() const { return enabled_; }
+
+  // Records a captured frame. |delivered| is false if it got dropped by the
+  // frame pacer.
+  void OnFrameArrived(bool delivered);
+
+  // Records |count| frames picked up by the consumer.
+  void OnFramesConsumed(uint64_t count);
+
+  // Records input or navigation and switches to full rate.
+  // Returns true if the decision changed.
+  bool OnActivity();
+
+  // Evaluates the current window if it has elapsed.
+  // Returns true if the decision changed.
+  bool Update();
+
+  const Decision& decision() const { return decision_; }
+
+ private:
+  Config config_;
+  Clock clock_;
+  bool enabled_ = false;
+  Decision decision_ = {Level::kFull, std::nullopt};
+
+  std::optional<TimePoint> window_start_;
+  std::optional<TimePoint> activity_until_;
+  uint64_t frames_arrived_ = 0;
+  uint64_t frames_delivered_ = 0;
+  uint64_t frames_consumed_ = 0;
+
+  bool SetLevel(Level level);
+  void ResetWindow(TimePoint now);
+};
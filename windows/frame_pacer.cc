@@ -0,0 +1,78 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// The weight of a new sample in the jitter average.
+constexpr double kJitterSmoothing = 1.0 / 16;
+}  // namespace
+
+FramePacer::FramePacer(Clock clock) : clock_(std::move(clock)) {}
+
+void FramePacer::SetTargetFps(std::optional<double> fps) {
+  if (fps.has_value() && *fps > 0) {
+    target_fps_ = fps;
+    period_ = Duration(1000.0 / *fps);
+  } else {
+    target_fps_.reset();
+    period_ = Duration(0);
+  }
+  Reset();
+}
+
+void FramePacer::Reset() {
+  next_slot_.reset();
+  last_accepted_.reset();
+  last_interval_.reset();
+}
+
+bool FramePacer::ShouldAcceptFrame() {
+  if (!target_fps_.has_value()) {
+    stats_.frames_accepted++;
+    return true;
+  }
+
+  const auto now = clock_();
+  const auto tolerance =
+      std::chrono::duration_cast<TimePoint::duration>(period_ * kSlotTolerance);
+  const auto period = std::chrono::duration_cast<TimePoint::duration>(period_);
+
+  if (next_slot_.has_value() && now + tolerance < *next_slot_) {
+    stats_.frames_dropped++;
+    return false;
+  }
+
+  if (!next_slot_.has_value()) {
+    next_slot_ = now;
+  }
+
+  // Advance to the first slot this frame doesn't account for. Skipping
+  // multiple slots at once keeps the grid intact after a stall.
+  const auto behind = now + tolerance - *next_slot_;
+  *next_slot_ += period * (behind / period + 1);
+
+  // Carry small errors, but move the grid if it's running ahead of the
+  // source (e.g. a 59.94 Hz source at 60 FPS) so that the phase doesn't
+  // drift.
+  if (behind % period > tolerance * 2) {
+    next_slot_ = now + period;
+  }
+
+  // Interarrival jitter as in RFC 3550, i.e. how much consecutive intervals
+  // between accepted frames differ.
+  if (last_accepted_.has_value()) {
+    const auto interval = Duration(now - *last_accepted_);
+    if (last_interval_.has_value()) {
+      const auto jitter =
+          Duration(std::abs((interval - *last_interval_).count()));
+      stats_.mean_jitter += (jitter - stats_.mean_jitter) * kJitterSmoothing;
+      stats_.max_jitter = std::max(stats_.max_jitter, jitter);
+    }
+    last_interval_ = interval;
+  }
+  last_accepted_ = now;
+
+  stats_.frames_accepted++;
+  return true;
+}
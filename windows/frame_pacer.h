@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+// Decides which captured frames get delivered when an FPS limit is set.
+//
+// Accepted frames are aligned to a fixed-period grid anchored at the first
+// accepted frame. Frames arriving slightly early or late are snapped to the
+// closest grid slot so that the error doesn't accumulate and the delivered
+// cadence stays even, e.g. every other frame of a 60 Hz source at 30 FPS.
+//
+// Not thread-safe.
+class FramePacer {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::function<TimePoint()> Clock;
+  typedef std::chrono::duration<double, std::milli> Duration;
+
+  struct Stats {
+    uint64_t frames_accepted;
+    uint64_t frames_dropped;
+    // Smoothed variation between consecutive intervals of accepted frames.
+    Duration mean_jitter;
+    Duration max_jitter;
+  };
+
+  // The fraction of a period by which a frame may miss its slot and still
+  // count for it.
+  static constexpr double kSlotTolerance = 0.25;
+
+  explicit FramePacer(Clock clock = std::chrono::steady_clock::now);
+
+  // Sets the target frame rate. |std::nullopt| or a non-positive value
+  // disables pacing.
+  void SetTargetFps(std::optional<double> fps);
+  std::optional<double> target_fps() const { return target_fps_; }
+
+  // Returns true if a frame arriving now should be delivered.
+  bool ShouldAcceptFrame();
+
+  // Forgets the grid so that the next frame is accepted and starts a new one.
+  void Reset();
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  Clock clock_;
+  std::optional<double> target_fps_;
+  Duration period_{0};
+  std::optional<TimePoint> next_slot_;
+  std::optional<TimePoint> last_accepted_;
+  std::optional<Duration> last_interval_;
+  Stats stats_ = {};
+};
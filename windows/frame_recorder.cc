@@ -0,0 +1,177 @@
+#include "frame_recorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include "util/string_converter.h"
+#endif
+
+namespace {
+
+// Small enough that cancelling a dump doesn't keep the destructor waiting.
+constexpr size_t kDumpChunkSize = 1 << 20;
+
+// The format is little-endian, as is every platform we build for.
+template <typename T>
+void Store(uint8_t* dst, T value) {
+  std::memcpy(dst, &value, sizeof(value));
+}
+
+// Marks the slot as being written before any of its contents change.
+void ClearSequence(uint8_t* slot) {
+  Store<uint64_t>(slot, 0);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+// Publishes the slot's sequence number after its contents.
+void StoreSequence(uint8_t* slot, uint64_t sequence) {
+  std::atomic_thread_fence(std::memory_order_release);
+  Store<uint64_t>(slot, sequence);
+}
+
+}  // namespace
+
+bool FrameRecorder::IsValid(const Config& config) {
+  if (config.max_width == 0 || config.max_height == 0 ||
+      config.slot_count == 0 || config.max_width > kMaxDimension ||
+      config.max_height > kMaxDimension) {
+    return false;
+  }
+
+  const auto slot_size = kSlotHeaderSize +
+                         static_cast<uint64_t>(config.max_width) *
+                             config.max_height * 4;
+  return kHeaderSize + slot_size * config.slot_count <= kMaxFileSize;
+}
+
+std::unique_ptr<FrameRecorder> FrameRecorder::Create(const Config& config) {
+  if (!IsValid(config)) {
+    return nullptr;
+  }
+
+  const auto slot_size = kSlotHeaderSize +
+                         static_cast<size_t>(config.max_width) *
+                             config.max_height * 4;
+  auto file = util::MappedFile::Create(
+      config.path, kHeaderSize + slot_size * config.slot_count);
+  if (!file) {
+    return nullptr;
+  }
+  return std::unique_ptr<FrameRecorder>(
+      new FrameRecorder(config, std::move(file)));
+}
+
+FrameRecorder::FrameRecorder(const Config& config,
+                             std::unique_ptr<util::MappedFile> file)
+    : config_(config),
+      slot_size_(kSlotHeaderSize +
+                 static_cast<size_t>(config.max_width) * config.max_height *
+                     4),
+      file_(std::move(file)) {
+  WriteHeader();
+  writer_ = std::make_unique<FrameWorker>([this]() { ProcessJobs(); });
+}
+
+FrameRecorder::~FrameRecorder() {
+  is_stopping_ = true;
+  writer_->Stop();
+  for (auto& job : jobs_) {
+    if (job.dump) {
+      job.dump->callback(false);
+    }
+  }
+}
+
+void FrameRecorder::WriteHeader() {
+  const auto header = file_->data();
+  std::memcpy(header, "WVFRAMES", 8);
+  Store<uint32_t>(header + 8, kVersion);
+  Store<uint32_t>(header + 12, static_cast<uint32_t>(kHeaderSize));
+  Store<uint32_t>(header + 16, static_cast<uint32_t>(kSlotHeaderSize));
+  Store<uint32_t>(header + 20, config_.slot_count);
+  Store<uint32_t>(header + 24, static_cast<uint32_t>(slot_size_));
+  Store<uint32_t>(header + 28, config_.max_width);
+  Store<uint32_t>(header + 32, config_.max_height);
+  Store<uint32_t>(header + 36, kPixelFormatRgba);
+}
+
+bool FrameRecorder::Record(std::vector<uint8_t> pixels, uint32_t width,
+                           uint32_t height, int64_t timestamp_us) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (width > config_.max_width || height > config_.max_height ||
+      pixels.size() != static_cast<size_t>(width) * height * 4 ||
+      queued_frames_ >= config_.max_queued) {
+    stats_.frames_dropped++;
+    return false;
+  }
+
+  jobs_.push_back({{std::move(pixels), width, height, timestamp_us}, nullptr});
+  queued_frames_++;
+  writer_->Signal();
+  return true;
+}
+
+void FrameRecorder::Dump(std::string path, DumpCallback callback) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  jobs_.push_back({{}, std::make_unique<PendingDump>(PendingDump{
+                           std::move(path), std::move(callback)})});
+  writer_->Signal();
+}
+
+FrameRecorder::Stats FrameRecorder::GetStats() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void FrameRecorder::ProcessJobs() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!jobs_.empty() && !is_stopping_) {
+    auto job = std::move(jobs_.front());
+    jobs_.pop_front();
+    lock.unlock();
+
+    if (job.dump) {
+      job.dump->callback(WriteDump(job.dump->path));
+      lock.lock();
+    } else {
+      WriteFrame(job.frame);
+      lock.lock();
+      queued_frames_--;
+      stats_.frames_recorded++;
+    }
+  }
+}
+
+void FrameRecorder::WriteFrame(const Frame& frame) {
+  const auto sequence = next_sequence_++;
+  auto slot = file_->data() + kHeaderSize +
+              ((sequence - 1) % config_.slot_count) * slot_size_;
+
+  ClearSequence(slot);
+  Store<int64_t>(slot + 8, frame.timestamp_us);
+  Store<uint32_t>(slot + 16, frame.width);
+  Store<uint32_t>(slot + 20, frame.height);
+  std::memcpy(slot + kSlotHeaderSize, frame.pixels.data(),
+              frame.pixels.size());
+  StoreSequence(slot, sequence);
+}
+
+bool FrameRecorder::WriteDump(const std::string& path) {
+#ifdef _WIN32
+  std::ofstream out(util::Utf16FromUtf8(path), std::ios::binary);
+#else
+  std::ofstream out(path, std::ios::binary);
+#endif
+  size_t offset = 0;
+  while (offset < file_->size() && out && !is_stopping_) {
+    const auto size = std::min(kDumpChunkSize, file_->size() - offset);
+    out.write(reinterpret_cast<const char*>(file_->data() + offset),
+              static_cast<std::streamsize>(size));
+    offset += size;
+  }
+  out.close();
+  return offset == file_->size() && !out.fail();
+}
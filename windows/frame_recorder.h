@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "frame_worker.h"
+#include "util/mapped_file.h"
+
+// Keeps the most recent frames in a memory-mapped ring file so that they can
+// be inspected after the fact.
+//
+// File format, all integers little-endian:
+//
+//   File header (64 bytes):
+//     0  char[8] magic "WVFRAMES"
+//     8  u32     version (1)
+//    12  u32     header size (64)
+//    16  u32     slot header size (32)
+//    20  u32     slot count
+//    24  u32     slot size in bytes, including the slot header
+//    28  u32     max width
+//    32  u32     max height
+//    36  u32     pixel format (1 = RGBA, 8 bits per channel)
+//    40          reserved, zero
+//
+//   Followed by |slot count| slots of |slot size| bytes each:
+//     0  u64     sequence number, starting at 1. 0 if the slot is empty or
+//                being written.
+//     8  i64     timestamp in microseconds since the Unix epoch
+//    16  u32     width
+//    20  u32     height
+//    24          reserved, zero
+//    32  u8[]    width * height * 4 bytes of tightly packed pixels
+//
+// Frame N is written to slot (N - 1) % slot count. The sequence number is
+// cleared before and set after writing the pixels, so a torn slot reads as
+// empty. Readers sort the non-empty slots by sequence number.
+//
+// Frames are written on a dedicated thread. |Record| only queues them and
+// drops frames rather than waiting if the writer falls behind. Dumps are
+// written in chunks, so that destroying the recorder cancels a running one
+// instead of waiting for it.
+class FrameRecorder {
+ public:
+  // Invoked on the writer thread.
+  typedef std::function<void(bool success)> DumpCallback;
+
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kHeaderSize = 64;
+  static constexpr size_t kSlotHeaderSize = 32;
+  static constexpr uint32_t kPixelFormatRgba = 1;
+  // Keeps the slot size within its 32 bit header field.
+  static constexpr uint32_t kMaxDimension = 4096;
+  // The file is allocated up front, so it's capped well below what fits
+  // into memory.
+  static constexpr uint64_t kMaxFileSize = uint64_t{1} << 30;
+
+  struct Config {
+    // UTF-8.
+    std::string path;
+    uint32_t max_width = 640;
+    uint32_t max_height = 360;
+    uint32_t slot_count = 100;
+    // Frames waiting for the writer beyond which new ones get dropped.
+    size_t max_queued = 4;
+  };
+
+  struct Stats {
+    uint64_t frames_recorded;
+    uint64_t frames_dropped;
+  };
+
+  // Returns false if |config| has an empty ring or exceeds |kMaxDimension|
+  // or |kMaxFileSize|.
+  static bool IsValid(const Config& config);
+
+  // Creates the ring file. Returns nullptr on failure or if |config| isn't
+  // valid.
+  static std::unique_ptr<FrameRecorder> Create(const Config& config);
+
+  // Stops the writer without waiting for a running dump. Pending dumps fail,
+  // possibly leaving a partial file behind.
+  ~FrameRecorder();
+
+  // Queues a frame of tightly packed RGBA pixels. Never blocks on I/O.
+  // Returns false if the frame got dropped because it exceeds the maximum
+  // size or the writer is behind. May be called from any thread.
+  bool Record(std::vector<uint8_t> pixels, uint32_t width, uint32_t height,
+              int64_t timestamp_us);
+
+  // Copies the ring file to |path| (UTF-8) once the frames queued so far are
+  // written. May be called from any thread.
+  void Dump(std::string path, DumpCallback callback);
+
+  // May be called from any thread.
+  Stats GetStats();
+
+  const Config& config() const { return config_; }
+
+ private:
+  struct Frame {
+    std::vector<uint8_t> pixels;
+    uint32_t width;
+    uint32_t height;
+    int64_t timestamp_us;
+  };
+
+  struct PendingDump {
+    std::string path;
+    DumpCallback callback;
+  };
+
+  // Either a frame or a dump, processed in order.
+  struct Job {
+    Frame frame;
+    std::unique_ptr<PendingDump> dump;
+  };
+
+  FrameRecorder(const Config& config, std::unique_ptr<util::MappedFile> file);
+
+  Config config_;
+  size_t slot_size_;
+  std::unique_ptr<util::MappedFile> file_;
+  // Only used on the writer thread.
+  uint64_t next_sequence_ = 1;
+
+  std::mutex mutex_;
+  std::deque<Job> jobs_;
+  size_t queued_frames_ = 0;
+  Stats stats_ = {};
+  // Set once the writer should stop.
+  std::atomic<bool> is_stopping_ = false;
+
+  // Declared last so that it's stopped before the members it uses go away.
+  std::unique_ptr<FrameWorker> writer_;
+
+  void WriteHeader();
+  void ProcessJobs();
+  void WriteFrame(const Frame& frame);
+  bool WriteDump(const std::string& path);
+};
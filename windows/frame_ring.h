@@ -0,0 +1,295 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+// A source of captured frames such as a Direct3D11CaptureFramePool.
+template <typename Frame>
+class FrameSource {
+ public:
+  virtual ~FrameSource() = default;
+
+  // Returns the next pending frame or std::nullopt if there is none.
+  virtual std::optional<Frame> TryGetNextFrame() = 0;
+};
+
+// A fixed-depth ring of frames shared between a single producer (the capture
+// callback) and a single consumer (the Flutter raster thread).
+//
+// Each slot is owned by exactly one side at a time:
+// - The producer claims free slots or, if there are none, the oldest
+//   published one. Overwriting a frame which was never read counts as a drop.
+// - The consumer claims the newest published slot and hands it back once
+//   it's done reading.
+// The newest frame stays readable after it has been consumed so the consumer
+// is always able to repopulate its surface.
+//
+// Ownership is handed over by compare-and-swapping a per-slot state word, so
+// neither side ever blocks on the other. With a depth of 3 this degenerates
+// into a classic triple buffer.
+template <typename Frame>
+class FrameRing {
+ public:
+  struct Stats {
+    uint64_t frames_published;
+    uint64_t frames_dropped;
+    // The number of failed compare-and-swap attempts, i.e. how often both
+    // sides raced for the same slot.
+    uint64_t contentions;
+  };
+
+  // Grants the consumer exclusive access to a slot until destroyed.
+  class ReadLock {
+   public:
+    ReadLock() = default;
+    ReadLock(FrameRing* ring, size_t index, uint64_t generation)
+        : ring_(ring), index_(index), generation_(generation) {}
+    ~ReadLock() { Reset(); }
+
+    ReadLock(ReadLock&& other) noexcept
+        : ring_(std::exchange(other.ring_, nullptr)),
+          index_(other.index_),
+          generation_(other.generation_) {}
+    ReadLock& operator=(ReadLock&& other) noexcept {
+      if (this != &other) {
+        Reset();
+        ring_ = std::exchange(other.ring_, nullptr);
+        index_ = other.index_;
+        generation_ = other.generation_;
+      }
+      return *this;
+    }
+
+    ReadLock(const ReadLock&) = delete;
+    ReadLock& operator=(const ReadLock&) = delete;
+
+    explicit operator bool() const { return ring_ != nullptr; }
+
+    const Frame& frame() const { return ring_->slots_[index_].frame; }
+    const Frame* operator->() const { return &frame(); }
+
+    // The sequence number assigned to the frame when it was published.
+    uint64_t generation() const { return generation_; }
+
+    void Reset() {
+      if (ring_) {
+        ring_->Release(index_);
+        ring_ = nullptr;
+      }
+    }
+
+   private:
+    FrameRing* ring_ = nullptr;
+    size_t index_ = 0;
+    uint64_t generation_ = 0;
+  };
+
+  explicit FrameRing(size_t depth)
+      : depth_(depth > 0 ? depth : 1),
+        slots_(std::make_unique<Slot[]>(depth_)) {}
+
+  size_t depth() const { return depth_; }
+
+  // The generation of the most recently published frame, 0 if none.
+  uint64_t latest_generation() const {
+    return latest_generation_.load(std::memory_order_acquire);
+  }
+
+  // Producer side: Stores |frame| as the newest frame.
+  // Returns false if every slot is owned by the consumer, in which case
+  // |frame| is dropped.
+  bool Publish(Frame frame) {
+    size_t index;
+    uint64_t word;
+    if (!Claim(index, word)) {
+      frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    if (StateOf(word) == SlotState::kReady && !IsConsumed(word)) {
+      frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto& slot = slots_[index];
+    // The evicted frame is released once |frame| goes out of scope.
+    std::swap(slot.frame, frame);
+    const auto generation =
+        generation_.fetch_add(1, std::memory_order_relaxed) + 1;
+    slot.word.store(MakeWord(generation, false, SlotState::kReady),
+                    std::memory_order_release);
+    latest_generation_.store(generation, std::memory_order_release);
+    frames_published_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Consumer side: Claims the newest published frame.
+  // Returns an empty lock if nothing has been published yet.
+  ReadLock AcquireLatest() {
+    for (;;) {
+      size_t latest = depth_;
+      uint64_t latest_word = 0;
+      for (size_t i = 0; i < depth_; i++) {
+        const auto word = slots_[i].word.load(std::memory_order_acquire);
+        if (StateOf(word) == SlotState::kReady &&
+            (latest == depth_ ||
+             GenerationOf(word) > GenerationOf(latest_word))) {
+          latest = i;
+          latest_word = word;
+        }
+      }
+
+      if (latest == depth_) {
+        return {};
+      }
+
+      auto expected = latest_word;
+      if (slots_[latest].word.compare_exchange_strong(
+              expected,
+              MakeWord(GenerationOf(latest_word), true, SlotState::kReading),
+              std::memory_order_acquire, std::memory_order_relaxed)) {
+        readers_.fetch_add(1);
+        return ReadLock(this, latest, GenerationOf(latest_word));
+      }
+      // The producer recycled the slot in the meantime.
+      contentions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns the newest published frame without claiming it, so that it
+  // neither counts as consumed nor keeps the producer from recycling its
+  // slot, or nullptr if nothing has been published yet. Only the producer
+  // modifies frames, so this mustn't race with it: The frame stays valid
+  // until the producer publishes or clears again.
+  const Frame* PeekLatest() const {
+    const Slot* latest = nullptr;
+    uint64_t latest_generation = 0;
+    for (size_t i = 0; i < depth_; i++) {
+      const auto word = slots_[i].word.load(std::memory_order_acquire);
+      const auto state = StateOf(word);
+      if ((state == SlotState::kReady || state == SlotState::kReading) &&
+          GenerationOf(word) > latest_generation) {
+        latest = &slots_[i];
+        latest_generation = GenerationOf(word);
+      }
+    }
+    return latest ? &latest->frame : nullptr;
+  }
+
+  // Drops all frames which aren't currently owned by the consumer.
+  void Clear() {
+    for (size_t i = 0; i < depth_; i++) {
+      auto& slot = slots_[i];
+      auto word = slot.word.load(std::memory_order_acquire);
+      if (StateOf(word) == SlotState::kReady &&
+          slot.word.compare_exchange_strong(
+              word, MakeWord(0, false, SlotState::kWriting),
+              std::memory_order_acquire, std::memory_order_relaxed)) {
+        slot.frame = Frame{};
+        slot.word.store(MakeWord(0, false, SlotState::kFree),
+                        std::memory_order_release);
+      }
+    }
+  }
+
+  Stats stats() const {
+    return {frames_published_.load(std::memory_order_relaxed),
+            frames_dropped_.load(std::memory_order_relaxed),
+            contentions_.load(std::memory_order_relaxed)};
+  }
+
+ private:
+  enum class SlotState : uint64_t { kFree, kWriting, kReady, kReading };
+
+  // Each slot's state word packs the slot state (2 bits), whether the
+  // consumer has read the frame (1 bit) and the frame's generation.
+  static constexpr uint64_t kStateMask = 0x3;
+  static constexpr uint64_t kConsumedBit = 0x4;
+  static constexpr int kGenerationShift = 3;
+
+  static constexpr uint64_t MakeWord(uint64_t generation, bool consumed,
+                                     SlotState state) {
+    return (generation << kGenerationShift) | (consumed ? kConsumedBit : 0) |
+           static_cast<uint64_t>(state);
+  }
+  static constexpr SlotState StateOf(uint64_t word) {
+    return static_cast<SlotState>(word & kStateMask);
+  }
+  static constexpr bool IsConsumed(uint64_t word) {
+    return (word & kConsumedBit) != 0;
+  }
+  static constexpr uint64_t GenerationOf(uint64_t word) {
+    return word >> kGenerationShift;
+  }
+
+  struct Slot {
+    std::atomic<uint64_t> word{MakeWord(0, false, SlotState::kFree)};
+    Frame frame{};
+  };
+
+  const size_t depth_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> generation_ = 0;
+  std::atomic<uint64_t> latest_generation_ = 0;
+  std::atomic<uint64_t> frames_published_ = 0;
+  std::atomic<uint64_t> frames_dropped_ = 0;
+  std::atomic<uint64_t> contentions_ = 0;
+  // The number of slots owned by the consumer. Raised after a slot was
+  // claimed and lowered before it's handed back, so it never exceeds the
+  // actual number.
+  std::atomic<size_t> readers_ = 0;
+
+  // Moves a free slot or the oldest published one into the kWriting state.
+  bool Claim(size_t& index, uint64_t& word) {
+    for (;;) {
+      size_t target = depth_;
+      uint64_t target_word = 0;
+      for (size_t i = 0; i < depth_; i++) {
+        const auto current = slots_[i].word.load(std::memory_order_acquire);
+        if (StateOf(current) == SlotState::kFree) {
+          target = i;
+          target_word = current;
+          break;
+        }
+        if (StateOf(current) == SlotState::kReady &&
+            (target == depth_ ||
+             GenerationOf(current) < GenerationOf(target_word))) {
+          target = i;
+          target_word = current;
+        }
+      }
+
+      if (target == depth_) {
+        // The scan isn't atomic. The consumer may have handed back a slot
+        // which was already scanned and claimed one which wasn't yet.
+        if (readers_.load() < depth_) {
+          contentions_.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        return false;
+      }
+
+      auto expected = target_word;
+      if (slots_[target].word.compare_exchange_strong(
+              expected, MakeWord(0, false, SlotState::kWriting),
+              std::memory_order_acquire, std::memory_order_relaxed)) {
+        index = target;
+        word = target_word;
+        return true;
+      }
+      // The consumer claimed the slot in the meantime.
+      contentions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void Release(size_t index) {
+    auto& slot = slots_[index];
+    const auto word = slot.word.load(std::memory_order_relaxed);
+    readers_.fetch_sub(1);
+    slot.word.store(MakeWord(GenerationOf(word), true, SlotState::kReady),
+                    std::memory_order_release);
+  }
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "latency_histogram.h"
+
+// Counters describing the frame pipeline of a texture bridge.
+//
+// Updated from the capture callback and the raster thread without locking so
+// that collecting them doesn't slow down either.
+class FrameStats {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+
+  struct Snapshot {
+    uint64_t frames_arrived;
+    uint64_t frames_dropped;
+    // Frames not signaled to Flutter since their content didn't change.
+    uint64_t frames_suppressed;
+    // Frames Flutter was asked to draw, and signals held back since Flutter
+    // hadn't requested the texture since the previous one yet.
+    uint64_t frames_signaled;
+    uint64_t signals_coalesced;
+    uint64_t descriptor_requests;
+    uint64_t copies_made;
+    // Descriptor requests which didn't need a copy since the surface
+    // already contained the latest frame.
+    uint64_t copies_skipped;
+    uint64_t resize_recreations;
+    // Tiles compared against the previous frame and how many of them
+    // changed. Only tracked by bridges converting frames on the CPU.
+    uint64_t tiles_checked;
+    uint64_t tiles_dirty;
+    // Time from a frame arriving in the capture pool to it being copied in
+    // response to a descriptor request.
+    LatencyHistogram::Snapshot capture_to_descriptor_latency;
+    // Time from a frame held back by static frame suppression arriving to it
+    // being signaled, since its fingerprint showed that it changed after all.
+    LatencyHistogram::Snapshot held_frame_latency;
+  };
+
+  // |dropped| is true if the frame pacer dropped the frame.
+  void RecordFrameArrived(bool dropped) {
+    Increment(frames_arrived_);
+    if (dropped) {
+      Increment(frames_dropped_);
+    }
+  }
+
+  void RecordFramesSuppressed(uint64_t count) {
+    frames_suppressed_.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  void RecordHeldFrameSignaled(TimePoint arrival_time) {
+    held_frame_latency_.Record(std::chrono::steady_clock::now() -
+                               arrival_time);
+  }
+
+  void RecordFrameSignaled() { Increment(frames_signaled_); }
+
+  void RecordSignalCoalesced() { Increment(signals_coalesced_); }
+
+  void RecordDescriptorRequest() { Increment(descriptor_requests_); }
+
+  void RecordCopyMade(TimePoint arrival_time) {
+    Increment(copies_made_);
+    capture_to_descriptor_latency_.Record(std::chrono::steady_clock::now() -
+                                          arrival_time);
+  }
+
+  void RecordCopySkipped() { Increment(copies_skipped_); }
+
+  void RecordResizeRecreation() { Increment(resize_recreations_); }
+
+  void RecordTileDiff(size_t checked, size_t dirty) {
+    tiles_checked_.fetch_add(checked, std::memory_order_relaxed);
+    tiles_dirty_.fetch_add(dirty, std::memory_order_relaxed);
+  }
+
+  Snapshot GetSnapshot() const {
+    return {Load(frames_arrived_),
+            Load(frames_dropped_),
+            Load(frames_suppressed_),
+            Load(frames_signaled_),
+            Load(signals_coalesced_),
+            Load(descriptor_requests_),
+            Load(copies_made_),
+            Load(copies_skipped_),
+            Load(resize_recreations_),
+            Load(tiles_checked_),
+            Load(tiles_dirty_),
+            capture_to_descriptor_latency_.GetSnapshot(),
+            held_frame_latency_.GetSnapshot()};
+  }
+
+ private:
+  std::atomic<uint64_t> frames_arrived_ = 0;
+  std::atomic<uint64_t> frames_dropped_ = 0;
+  std::atomic<uint64_t> frames_suppressed_ = 0;
+  std::atomic<uint64_t> frames_signaled_ = 0;
+  std::atomic<uint64_t> signals_coalesced_ = 0;
+  std::atomic<uint64_t> descriptor_requests_ = 0;
+  std::atomic<uint64_t> copies_made_ = 0;
+  std::atomic<uint64_t> copies_skipped_ = 0;
+  std::atomic<uint64_t> resize_recreations_ = 0;
+  std::atomic<uint64_t> tiles_checked_ = 0;
+  std::atomic<uint64_t> tiles_dirty_ = 0;
+  LatencyHistogram capture_to_descriptor_latency_;
+  LatencyHistogram held_frame_latency_;
+
+  static void Increment(std::atomic<uint64_t>& counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static uint64_t Load(const std::atomic<uint64_t>& counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+};
@@ -0,0 +1,59 @@
+#include "frame_worker.h"
+
+#include <cassert>
+
+FrameWorker::FrameWorker(Task task, Task on_start, Task on_exit)
+    : task_(std::move(task)),
+      on_start_(std::move(on_start)),
+      on_exit_(std::move(on_exit)) {
+  thread_ = std::thread(&FrameWorker::Run, this);
+}
+
+FrameWorker::~FrameWorker() { Stop(); }
+
+void FrameWorker::Signal() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    signaled_ = true;
+  }
+  condition_.notify_one();
+}
+
+void FrameWorker::Stop() {
+  assert(!IsCurrentThread());
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  condition_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void FrameWorker::Run() {
+  if (on_start_) {
+    on_start_();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    condition_.wait(lock, [this] { return signaled_ || stopped_; });
+    if (stopped_) {
+      break;
+    }
+    signaled_ = false;
+
+    lock.unlock();
+    task_();
+    lock.lock();
+  }
+  lock.unlock();
+
+  if (on_exit_) {
+    on_exit_();
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// A dedicated thread running a task whenever it gets signaled.
+//
+// Signals arriving while the task runs are coalesced into a single rerun, so
+// the task should process all pending work each time it runs.
+class FrameWorker {
+ public:
+  typedef std::function<void()> Task;
+
+  // |on_start| and |on_exit| run on the worker thread before the first and
+  // after the last invocation of |task|.
+  explicit FrameWorker(Task task, Task on_start = nullptr,
+                       Task on_exit = nullptr);
+  ~FrameWorker();
+
+  // Schedules a run of the task. May be called from any thread and is a
+  // no-op after |Stop|.
+  void Signal();
+
+  // Waits for a running task to finish and joins the thread. Must not be
+  // called from the worker thread or while holding a lock the task takes.
+  void Stop();
+
+  bool IsCurrentThread() const {
+    return std::this_thread::get_id() == thread_.get_id();
+  }
+
+ private:
+  Task task_;
+  Task on_start_;
+  Task on_exit_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool signaled_ = false;
+  bool stopped_ = false;
+  std::thread thread_;
+
+  void Run();
+};
@@ -0,0 +1,97 @@
+#include "gpu_memory_budget.h"
+
+#include <algorithm>
+#include <vector>
+
+GpuMemoryBudget::GpuMemoryBudget(Clock clock) : clock_(std::move(clock)) {}
+
+void GpuMemoryBudget::AddClient(int64_t id, Client* client) {
+  clients_[id] = {client, 0, false, false, client->GetFramesShown(), clock_()};
+}
+
+void GpuMemoryBudget::RemoveClient(int64_t id) {
+  const auto it = clients_.find(id);
+  if (it != clients_.end()) {
+    total_usage_ -= it->second.usage;
+    clients_.erase(it);
+  }
+}
+
+void GpuMemoryBudget::SetBudget(std::optional<size_t> budget) {
+  budget_ = budget;
+}
+
+size_t GpuMemoryBudget::Update() {
+  const auto now = clock_();
+
+  total_usage_ = 0;
+  for (auto& [id, state] : clients_) {
+    state.usage = state.client->GetGpuMemoryUsage();
+    state.suspended = state.client->IsSuspended();
+    state.hidden = state.client->IsHidden();
+    const auto frames_shown = state.client->GetFramesShown();
+    if (frames_shown != state.frames_shown) {
+      state.frames_shown = frames_shown;
+      state.last_shown = now;
+    }
+    total_usage_ += state.usage;
+  }
+
+  if (!budget_.has_value() || total_usage_ <= *budget_) {
+    return 0;
+  }
+
+  const auto freed =
+      Reclaim(TrimLevel::kCaches) + Reclaim(TrimLevel::kAll);
+  stats_.bytes_freed += freed;
+  return freed;
+}
+
+size_t GpuMemoryBudget::Reclaim(TrimLevel level) {
+  std::vector<ClientState*> candidates;
+  for (auto& [id, state] : clients_) {
+    if (state.usage == 0) {
+      continue;
+    }
+    // Releasing everything of a client on screen would have it recreate its
+    // resources on its next frame.
+    if (level == TrimLevel::kAll && !state.suspended && !state.hidden) {
+      continue;
+    }
+    candidates.push_back(&state);
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const ClientState* a, const ClientState* b) {
+              if (a->suspended != b->suspended) {
+                return a->suspended;
+              }
+              if (a->hidden != b->hidden) {
+                return a->hidden;
+              }
+              return a->last_shown < b->last_shown;
+            });
+
+  size_t freed = 0;
+  for (auto* state : candidates) {
+    if (total_usage_ <= *budget_) {
+      break;
+    }
+
+    const auto bytes =
+        std::min(state->client->TrimGpuMemory(level), state->usage);
+    state->usage -= bytes;
+    total_usage_ -= bytes;
+    freed += bytes;
+    stats_.trims++;
+  }
+  return freed;
+}
+
+std::map<int64_t, size_t> GpuMemoryBudget::GetUsage() const {
+  std::map<int64_t, size_t> usage;
+  for (const auto& [id, state] : clients_) {
+    usage[id] = state.usage;
+  }
+  return usage;
+}
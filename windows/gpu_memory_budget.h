@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+
+// Keeps the video memory held by all webview instances within a budget.
+//
+// Clients are polled for their usage on each |Update|. While the total
+// exceeds the budget, memory is reclaimed in two passes, each visiting
+// suspended clients first, then hidden ones and the others in
+// least-recently-shown order:
+// 1. Cached resources are trimmed, which doesn't affect what's shown.
+// 2. All resources of suspended and hidden clients are released. They get
+//    recreated once the client is shown again. Clients which are on screen
+//    keep theirs even if they haven't shown a new frame in a while, since
+//    static content would otherwise be recreated on its next repaint.
+//
+// Not thread-safe; clients must be safe to poll and trim from the thread
+// calling |Update|.
+class GpuMemoryBudget {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::function<TimePoint()> Clock;
+
+  enum class TrimLevel { kCaches, kAll };
+
+  class Client {
+   public:
+    virtual ~Client() = default;
+
+    // Returns the number of bytes of video memory currently held.
+    virtual size_t GetGpuMemoryUsage() const = 0;
+
+    virtual bool IsSuspended() const = 0;
+
+    // Returns true while no part of the client is on screen.
+    virtual bool IsHidden() const = 0;
+
+    // Returns a counter which increases whenever a frame gets shown.
+    virtual uint64_t GetFramesShown() const = 0;
+
+    // Releases resources according to |level|. Returns the bytes freed.
+    virtual size_t TrimGpuMemory(TrimLevel level) = 0;
+  };
+
+  struct Stats {
+    uint64_t trims;
+    uint64_t bytes_freed;
+  };
+
+  explicit GpuMemoryBudget(Clock clock = std::chrono::steady_clock::now);
+
+  void AddClient(int64_t id, Client* client);
+  void RemoveClient(int64_t id);
+
+  // Sets the budget in bytes, std::nullopt for no limit.
+  void SetBudget(std::optional<size_t> budget);
+  std::optional<size_t> budget() const { return budget_; }
+
+  // Polls all clients and trims them if the budget is exceeded.
+  // Returns the bytes freed.
+  size_t Update();
+
+  // The usage of each client as of the last |Update|.
+  std::map<int64_t, size_t> GetUsage() const;
+  size_t total_usage() const { return total_usage_; }
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct ClientState {
+    Client* client;
+    size_t usage;
+    bool suspended;
+    bool hidden;
+    uint64_t frames_shown;
+    TimePoint last_shown;
+  };
+
+  Clock clock_;
+  std::optional<size_t> budget_;
+  std::map<int64_t, ClientState> clients_;
+  size_t total_usage_ = 0;
+  Stats stats_ = {};
+
+  // Trims |level| on eligible clients until the budget is met.
+  size_t Reclaim(TrimLevel level);
+};
@@ -0,0 +1,156 @@
+#include "gpu_tile_fingerprinter.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "util/d3dutil.h"
+
+GpuTileFingerprinter::GpuTileFingerprinter(
+    const GraphicsContext* graphics_context, const Config& config)
+    : graphics_context_(graphics_context),
+      config_(config),
+      tracker_(TileChangeTracker::Config{config.tile_size}) {
+  while ((2u << tile_level_) <= config_.tile_size) {
+    tile_level_++;
+  }
+
+  // Fingerprinting happens on the capture thread while the raster thread may
+  // be copying frames.
+  graphics_context_->EnableMultithreadProtection();
+}
+
+void GpuTileFingerprinter::Submit(ID3D11Texture2D* texture,
+                                  uint64_t generation) {
+  D3D11_TEXTURE2D_DESC desc;
+  texture->GetDesc(&desc);
+  if (desc.Format != ToDxgiFormat(config_.pixel_format) ||
+      !EnsureResources(desc.Width, desc.Height)) {
+    return;
+  }
+
+  auto& staging = staging_[next_staging_];
+  // All copies are still in flight. |tracker_| treats the skipped frame like
+  // a resize.
+  if (staging.generation != 0) {
+    return;
+  }
+
+  // The padding keeps whatever it was initialized with, so it never shows up
+  // as a change.
+  auto device_context = graphics_context_->d3d_device_context();
+  const D3D11_BOX box = {0, 0, 0, desc.Width, desc.Height, 1};
+  device_context->CopySubresourceRegion(mip_texture_.get(), 0, 0, 0, 0,
+                                        texture, 0, &box);
+  device_context->GenerateMips(mip_view_.get());
+  device_context->CopySubresourceRegion(staging.texture.get(), 0, 0, 0, 0,
+                                        mip_texture_.get(), tile_level_,
+                                        nullptr);
+  // Get the copy going so that it has finished by the time the frame is
+  // consumed.
+  device_context->Flush();
+
+  staging.generation = generation;
+  next_staging_ = (next_staging_ + 1) % kStagingCount;
+}
+
+void GpuTileFingerprinter::ReadFinished() {
+  for (size_t i = 0; i < kStagingCount; i++) {
+    auto& staging = staging_[(next_staging_ + i) % kStagingCount];
+    if (staging.generation == 0) {
+      continue;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    const auto hr = graphics_context_->d3d_device_context()->Map(
+        staging.texture.get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT,
+        &mapped);
+    // Later copies can't have finished either.
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+      return;
+    }
+
+    // A frame that couldn't be read back leaves a gap in the generations,
+    // which |tracker_| treats as a change of every tile.
+    if (SUCCEEDED(hr)) {
+      tracker_.Add(staging.generation, width_, height_,
+                   static_cast<const uint8_t*>(mapped.pData), mapped.RowPitch,
+                   util::BytesPerPixel(config_.pixel_format));
+      graphics_context_->d3d_device_context()->Unmap(staging.texture.get(),
+                                                     0);
+    }
+    staging.generation = 0;
+  }
+}
+
+bool GpuTileFingerprinter::EnsureResources(uint32_t width, uint32_t height) {
+  if (mip_texture_ && width == width_ && height == height_) {
+    return true;
+  }
+
+  ReleaseResources();
+
+  const auto tile_size = config_.tile_size;
+  const auto columns = (width + tile_size - 1) / tile_size;
+  const auto rows = (height + tile_size - 1) / tile_size;
+
+  D3D11_TEXTURE2D_DESC desc = {};
+  desc.ArraySize = 1;
+  desc.MipLevels = tile_level_ + 1;
+  desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+  desc.CPUAccessFlags = 0;
+  desc.Format = ToDxgiFormat(config_.pixel_format);
+  desc.Width = columns * tile_size;
+  desc.Height = rows * tile_size;
+  desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+  desc.SampleDesc.Count = 1;
+  desc.SampleDesc.Quality = 0;
+  desc.Usage = D3D11_USAGE_DEFAULT;
+
+  auto device = graphics_context_->d3d_device();
+  if (FAILED(device->CreateTexture2D(&desc, nullptr, mip_texture_.put())) ||
+      FAILED(device->CreateShaderResourceView(mip_texture_.get(), nullptr,
+                                              mip_view_.put()))) {
+    std::cerr << "Creating the tile fingerprint mip chain failed" << std::endl;
+    ReleaseResources();
+    return false;
+  }
+
+  desc.MipLevels = 1;
+  desc.BindFlags = 0;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+  desc.Width = columns;
+  desc.Height = rows;
+  desc.MiscFlags = 0;
+  desc.Usage = D3D11_USAGE_STAGING;
+  for (auto& staging : staging_) {
+    if (FAILED(device->CreateTexture2D(&desc, nullptr,
+                                       staging.texture.put()))) {
+      std::cerr << "Creating the tile fingerprint staging texture failed"
+                << std::endl;
+      ReleaseResources();
+      return false;
+    }
+  }
+
+  width_ = width;
+  height_ = height;
+
+  // The mip chain adds up to a third of the base level.
+  const auto base_bytes = util::ImageBytes(
+      config_.pixel_format, columns * tile_size, rows * tile_size);
+  gpu_bytes_ =
+      base_bytes + base_bytes / 3 +
+      util::ImageBytes(config_.pixel_format, columns, rows) * kStagingCount;
+  return true;
+}
+
+size_t GpuTileFingerprinter::ReleaseResources() {
+  mip_view_ = nullptr;
+  mip_texture_ = nullptr;
+  staging_ = {};
+  next_staging_ = 0;
+  width_ = 0;
+  height_ = 0;
+  tracker_.Reset();
+  return gpu_bytes_.exchange(0);
+}
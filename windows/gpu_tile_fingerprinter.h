@@ -0,0 +1,83 @@
+#pragma once
+
+#include <d3d11.h>
+#include <winrt/base.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "graphics_context.h"
+#include "tile_change_tracker.h"
+#include "util/pixel_format.h"
+
+// Tells which tiles of captured frames changed by fingerprinting every tile
+// on the GPU.
+//
+// Frames are copied into a mip chain whose size is padded to whole tiles, so
+// that each texel of the level log2(|Config::tile_size|) is the average of
+// one tile, e.g. level 6 for 64 pixel tiles. Only that level is read back,
+// without waiting for the GPU, so a frame's fingerprints are usually known
+// a frame after it was submitted. Changes too subtle to alter a tile's
+// average go unnoticed.
+//
+// Not thread-safe, except for |gpu_bytes|.
+class GpuTileFingerprinter {
+ public:
+  struct Config {
+    // Must be a power of two.
+    uint32_t tile_size = 64;
+    // The format of the frames, others aren't fingerprinted.
+    util::PixelFormat pixel_format = util::PixelFormat::kBgra8;
+  };
+
+  GpuTileFingerprinter(const GraphicsContext* graphics_context,
+                       const Config& config);
+
+  // Starts fingerprinting |texture|, which holds the frame |generation|.
+  // Frames have to be submitted in generation order. Never blocks on the GPU.
+  void Submit(ID3D11Texture2D* texture, uint64_t generation);
+
+  // Adds the fingerprints which were read back by now to |tracker|, oldest
+  // first. Never blocks on the GPU.
+  void ReadFinished();
+
+  const TileChangeTracker& tracker() const { return tracker_; }
+
+  // Returns the number of bytes freed.
+  size_t ReleaseResources();
+
+  // May be called from any thread.
+  size_t gpu_bytes() const {
+    return gpu_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // A CPU-readable copy of a frame's tile level.
+  struct Staging {
+    winrt::com_ptr<ID3D11Texture2D> texture;
+    // The frame being copied, 0 once it was read back.
+    uint64_t generation = 0;
+  };
+
+  // Fingerprints usually finish within a frame, one more covers hiccups.
+  static constexpr size_t kStagingCount = 3;
+
+  const GraphicsContext* graphics_context_;
+  Config config_;
+  uint32_t tile_level_ = 0;
+  TileChangeTracker tracker_;
+
+  // Receives the frame and its downsampled levels.
+  winrt::com_ptr<ID3D11Texture2D> mip_texture_;
+  winrt::com_ptr<ID3D11ShaderResourceView> mip_view_;
+  // Used in submission order, starting at |next_staging_|.
+  std::array<Staging, kStagingCount> staging_;
+  size_t next_staging_ = 0;
+  // The frame size.
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  std::atomic<size_t> gpu_bytes_ = 0;
+
+  bool EnsureResources(uint32_t width, uint32_t height);
+};
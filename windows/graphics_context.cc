@@ -1,5 +1,7 @@
 #include "graphics_context.h"
 
+#include <d3d11_4.h>
+
 #include "util/d3dutil.h"
 #include "util/direct3d11.interop.h"
 
@@ -19,6 +21,15 @@ GraphicsContext::GraphicsContext(rx::RoHelper* rohelper) : rohelper_(rohelper) {
   valid_ = true;
 }
 
+bool GraphicsContext::EnableMultithreadProtection() const {
+  const auto multithread = device_context_.try_as<ID3D11Multithread>();
+  if (!multithread) {
+    return false;
+  }
+  multithread->SetMultithreadProtected(TRUE);
+  return true;
+}
+
 winrt::com_ptr<ABI::Windows::UI::Composition::ICompositor>
 GraphicsContext::CreateCompositor() {
   HSTRING className;
@@ -21,6 +21,10 @@ class GraphicsContext {
     return device_context_.get();
   }
 
+  // Serializes calls to the immediate context, which is otherwise only safe
+  // to use from the raster thread. Can't be turned off again.
+  bool EnableMultithreadProtection() const;
+
   winrt::com_ptr<ABI::Windows::UI::Composition::ICompositor> CreateCompositor();
 
   winrt::com_ptr<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>
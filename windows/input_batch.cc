@@ -0,0 +1,67 @@
+#include "input_batch.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Must match WebviewPointerEventKind and WebviewPointerButton.
+constexpr uint8_t kPointerEventKindCount = 6;
+constexpr uint8_t kPointerButtonCount = 4;
+
+// Windows only runs on little-endian machines.
+template <typename T>
+T Load(const uint8_t* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+bool IsValid(const InputBatch::Record& record) {
+  if (!std::isfinite(record.x) || !std::isfinite(record.y)) {
+    return false;
+  }
+  switch (record.kind) {
+    case InputBatch::Kind::kCursorPos:
+    case InputBatch::Kind::kScrollDelta:
+      return true;
+    case InputBatch::Kind::kPointerUpdate:
+      return record.event < kPointerEventKindCount &&
+             std::isfinite(record.size) && std::isfinite(record.pressure);
+    case InputBatch::Kind::kPointerButton:
+      return record.event < kPointerButtonCount;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool InputBatch::Decode(const uint8_t* data, size_t size,
+                        std::vector<Record>& records) {
+  if (size % kRecordSize != 0) {
+    return false;
+  }
+
+  const auto initial_count = records.size();
+  records.reserve(initial_count + size / kRecordSize);
+  for (size_t offset = 0; offset < size; offset += kRecordSize) {
+    const auto* p = data + offset;
+    const Record record = {static_cast<Kind>(p[0]),
+                           p[1],
+                           Load<int32_t>(p + 4),
+                           Load<double>(p + 8),
+                           Load<double>(p + 16),
+                           Load<float>(p + 24),
+                           Load<float>(p + 28),
+                           Load<uint32_t>(p + 32),
+                           Load<uint32_t>(p + 36),
+                           Load<int64_t>(p + 40)};
+    if (!IsValid(record)) {
+      records.resize(initial_count);
+      return false;
+    }
+    records.push_back(record);
+  }
+  return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Decodes batches of input events sent in one method call.
+//
+// A batch is a sequence of fixed-size little-endian records:
+//
+//   offset  size  field
+//        0     1  kind, see |Kind|
+//        1     1  event: WebviewPointerEventKind for |Kind::kPointerUpdate|,
+//                 WebviewPointerButton for |Kind::kPointerButton|
+//        2     2  reserved, 0
+//        4     4  pointer id (int32)
+//        8     8  x (float64): position, or scroll delta in physical
+//                 pixels for |Kind::kScrollDelta|
+//       16     8  y (float64)
+//       24     4  contact size (float32)
+//       28     4  pressure (float32)
+//       32     4  buttons down after the event, see |ButtonMask|
+//       36     4  sequence number (uint32) the sender assigned, 0 if none
+//       40     8  timestamp in microseconds (int64), 0 if unknown
+//
+// Fields a kind doesn't use are ignored. Must match lib/src/input_batch.dart.
+class InputBatch {
+ public:
+  static constexpr size_t kRecordSize = 48;
+
+  enum class Kind : uint8_t {
+    kCursorPos,
+    kPointerUpdate,
+    kPointerButton,
+    kScrollDelta,
+  };
+
+  struct Record {
+    Kind kind;
+    uint8_t event;
+    int32_t pointer;
+    double x;
+    double y;
+    float size;
+    float pressure;
+    uint32_t buttons;
+    uint32_t sequence;
+    int64_t timestamp_us;
+  };
+
+  // The bit of WebviewPointerButton |button| in |Record::buttons|, which
+  // matches Flutter's kPrimaryButton and friends.
+  static uint32_t ButtonMask(uint8_t button) {
+    return button > 0 ? 1u << (button - 1) : 0;
+  }
+
+  // Appends the records of |size| bytes at |data| to |records|. Returns
+  // false and leaves |records| unchanged if the batch is malformed, so that
+  // either all of it or none of it gets replayed.
+  static bool Decode(const uint8_t* data, size_t size,
+                     std::vector<Record>& records);
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Queues input events between rendered frames and collapses consecutive
+// moves of the same pointer.
+//
+// Events pushed with a key, e.g. moves, replace the queued event with the
+// same key unless an event without a key was queued after it. Events without
+// a key, e.g. button transitions, are never collapsed and act as barriers, so
+// the relative order of everything else is preserved. Only moves of
+// different pointers may be reordered among each other.
+//
+// Mergeable events, e.g. wheel deltas, are barriers as well, but get combined
+// with the previous event if that is a mergeable one of the same key.
+//
+// The queue is meant to be flushed whenever a frame was rendered. |deadline|
+// bounds how long an event may wait if none is.
+//
+// Not thread-safe.
+template <typename Event>
+class InputCoalescer {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::function<TimePoint()> Clock;
+  typedef std::function<void(const Event&)> Dispatcher;
+  // Combines |event| into the |queued| one.
+  typedef std::function<void(Event& queued, const Event& event)> Merger;
+
+  struct Stats {
+    uint64_t events_queued;
+    // Events replaced by a later one before being dispatched.
+    uint64_t events_coalesced;
+    uint64_t events_dispatched;
+  };
+
+  // One frame at 60 Hz, for when the page doesn't render any.
+  static constexpr std::chrono::milliseconds kDefaultMaxDelay{16};
+
+  explicit InputCoalescer(
+      std::chrono::milliseconds max_delay = kDefaultMaxDelay,
+      Clock clock = std::chrono::steady_clock::now)
+      : max_delay_(max_delay), clock_(std::move(clock)) {}
+
+  void Push(Event event, std::optional<int64_t> key) {
+    stats_.events_queued++;
+    if (key.has_value()) {
+      for (size_t i = barrier_; i < queue_.size(); i++) {
+        if (queue_[i].key == key) {
+          // Keeps its position and enqueue time, so the deadline holds.
+          queue_[i].event = std::move(event);
+          stats_.events_coalesced++;
+          return;
+        }
+      }
+    }
+
+    if (queue_.empty()) {
+      oldest_ = clock_();
+    }
+    queue_.push_back({std::move(event), key, false});
+    if (!key.has_value()) {
+      barrier_ = queue_.size();
+    }
+  }
+
+  // Merges |event| into the last queued event if that was pushed by this
+  // with the same |key|, otherwise queues it. Earlier events can't be
+  // replaced afterwards, so |event| keeps its place relative to them.
+  void PushMergeable(Event event, int64_t key, const Merger& merge) {
+    stats_.events_queued++;
+    if (!queue_.empty()) {
+      auto& last = queue_.back();
+      if (last.is_mergeable && last.key == key) {
+        merge(last.event, event);
+        stats_.events_coalesced++;
+        return;
+      }
+    }
+
+    if (queue_.empty()) {
+      oldest_ = clock_();
+    }
+    queue_.push_back({std::move(event), key, true});
+    // Only the merging above may change the event itself.
+    barrier_ = queue_.size();
+  }
+
+  // Hands all queued events to |dispatch| in order and empties the queue.
+  // |dispatch| may push new events, which are queued for the next flush, but
+  // must not flush.
+  void Flush(const Dispatcher& dispatch) {
+    // Swapping keeps both buffers' capacity.
+    std::swap(queue_, flushing_);
+    barrier_ = 0;
+    oldest_.reset();
+    for (const auto& entry : flushing_) {
+      stats_.events_dispatched++;
+      dispatch(entry.event);
+    }
+    flushing_.clear();
+  }
+
+  // Flushes if the oldest queued event has waited for the maximum delay.
+  // Returns true if it did.
+  bool FlushIfDue(const Dispatcher& dispatch) {
+    const auto due = deadline();
+    if (!due.has_value() || clock_() < *due) {
+      return false;
+    }
+    Flush(dispatch);
+    return true;
+  }
+
+  // Returns when the queue has to be flushed at the latest, std::nullopt if
+  // it's empty.
+  std::optional<TimePoint> deadline() const {
+    return oldest_.has_value() ? std::make_optional(*oldest_ + max_delay_)
+                               : std::nullopt;
+  }
+
+  bool empty() const { return queue_.empty(); }
+  size_t size() const { return queue_.size(); }
+  std::chrono::milliseconds max_delay() const { return max_delay_; }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    Event event;
+    std::optional<int64_t> key;
+    bool is_mergeable;
+  };
+
+  std::chrono::milliseconds max_delay_;
+  Clock clock_;
+  std::vector<Entry> queue_;
+  std::vector<Entry> flushing_;
+  // Events before this index can't be replaced anymore.
+  size_t barrier_ = 0;
+  std::optional<TimePoint> oldest_;
+  Stats stats_ = {};
+};
@@ -0,0 +1,86 @@
+#include "input_latency_tracker.h"
+
+#include <utility>
+
+InputLatencyTracker::InputLatencyTracker(Clock clock)
+    : InputLatencyTracker(Config{}, std::move(clock)) {}
+
+InputLatencyTracker::InputLatencyTracker(const Config& config, Clock clock)
+    : config_(config), clock_(std::move(clock)) {}
+
+void InputLatencyTracker::OnInputReceived(
+    uint64_t sequence, std::optional<TimePoint> event_time) {
+  const auto now = clock_();
+  if (event_time &&
+      (*event_time > now || now - *event_time > config_.max_delivery)) {
+    event_time.reset();
+  }
+
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.size() >= config_.max_pending && !pending_.empty()) {
+    pending_.pop_front();
+    if (injected_count_ > 0) {
+      injected_count_--;
+    }
+    inputs_unmatched_++;
+  }
+
+  inputs_received_++;
+  pending_.push_back({sequence, event_time, now, now});
+}
+
+void InputLatencyTracker::OnInputInjected() {
+  const auto now = clock_();
+  const std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = injected_count_; i < pending_.size(); i++) {
+    pending_[i].injected = now;
+  }
+  injected_count_ = pending_.size();
+}
+
+void InputLatencyTracker::OnInputDropped() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  inputs_unmatched_ += pending_.size() - injected_count_;
+  pending_.resize(injected_count_);
+}
+
+void InputLatencyTracker::OnFrameArrived(TimePoint arrival_time) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  while (injected_count_ > 0) {
+    const auto& input = pending_.front();
+    // Injected after the frame was captured, so it can't be its result.
+    if (input.injected > arrival_time) {
+      break;
+    }
+
+    if (arrival_time - input.injected > config_.max_age) {
+      inputs_unmatched_++;
+    } else {
+      if (input.event_time) {
+        delivery_latency_.Record(input.received - *input.event_time);
+      }
+      queue_latency_.Record(input.injected - input.received);
+      render_latency_.Record(arrival_time - input.injected);
+      total_latency_.Record(arrival_time -
+                            input.event_time.value_or(input.received));
+      inputs_matched_++;
+      if (input.sequence != 0) {
+        last_matched_sequence_ = input.sequence;
+      }
+    }
+    pending_.pop_front();
+    injected_count_--;
+  }
+}
+
+InputLatencyTracker::Snapshot InputLatencyTracker::GetSnapshot() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return {inputs_received_,
+          inputs_matched_,
+          inputs_unmatched_,
+          last_matched_sequence_,
+          delivery_latency_.GetSnapshot(),
+          queue_latency_.GetSnapshot(),
+          render_latency_.GetSnapshot(),
+          total_latency_.GetSnapshot()};
+}
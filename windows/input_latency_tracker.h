@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+#include "latency_histogram.h"
+
+// Measures how long input takes to show up in a captured frame.
+//
+// Input forwarded to the webview is tracked from being received. Once the
+// webview injected it, the next frame arriving from the capture session is
+// taken as its result. The time in between is split into
+// stages:
+//
+//   delivery: from the timestamp Flutter's embedder took to receiving the
+//             input, i.e. the framework, Dart and the method channel. Only
+//             recorded for input carrying a timestamp.
+//   queue:    from receiving to injecting the input, see InputCoalescer.
+//   render:   from injecting the input to the frame arriving.
+//   total:    from the event's timestamp, or receiving it if there is
+//             none, to the frame arriving.
+//
+// Input which no frame followed within |Config::max_age| of being injected
+// presumably didn't change anything visible and is counted as unmatched, as
+// is input dropped instead of being injected.
+//
+// Thread-safe. Input is typically reported on the platform thread and frames
+// on the capture thread.
+class InputLatencyTracker {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::function<TimePoint()> Clock;
+
+  struct Config {
+    std::chrono::milliseconds max_age{500};
+    // Event timestamps further in the past are assumed to come from another
+    // clock and are ignored.
+    std::chrono::milliseconds max_delivery{1000};
+    // Beyond this, the oldest pending input is counted as unmatched.
+    size_t max_pending = 1024;
+  };
+
+  struct Snapshot {
+    uint64_t inputs_received;
+    uint64_t inputs_matched;
+    uint64_t inputs_unmatched;
+    // The sender's sequence number of the latest numbered input matched to a
+    // frame, 0 if none.
+    uint64_t last_matched_sequence;
+    LatencyHistogram::Snapshot delivery_latency;
+    LatencyHistogram::Snapshot queue_latency;
+    LatencyHistogram::Snapshot render_latency;
+    LatencyHistogram::Snapshot total_latency;
+  };
+
+  explicit InputLatencyTracker(Clock clock = std::chrono::steady_clock::now);
+  InputLatencyTracker(const Config& config, Clock clock);
+
+  // Records an input taken at |event_time| by Flutter's embedder, if known.
+  // |sequence| is the number the sender gave it, 0 if none.
+  void OnInputReceived(uint64_t sequence, std::optional<TimePoint> event_time);
+
+  // Marks all input received so far as injected into the webview.
+  void OnInputInjected();
+
+  // Counts all input received but not injected so far as unmatched, for
+  // when the webview dropped it.
+  void OnInputDropped();
+
+  // Matches the injected input to a frame which arrived at |arrival_time|.
+  void OnFrameArrived(TimePoint arrival_time);
+
+  Snapshot GetSnapshot() const;
+
+ private:
+  struct PendingInput {
+    uint64_t sequence;
+    std::optional<TimePoint> event_time;
+    TimePoint received;
+    TimePoint injected;
+  };
+
+  const Config config_;
+  Clock clock_;
+
+  mutable std::mutex mutex_;
+  // In the order received. The first |injected_count_| were injected.
+  std::deque<PendingInput> pending_;
+  size_t injected_count_ = 0;
+  uint64_t inputs_received_ = 0;
+  uint64_t inputs_matched_ = 0;
+  uint64_t inputs_unmatched_ = 0;
+  uint64_t last_matched_sequence_ = 0;
+
+  LatencyHistogram delivery_latency_;
+  LatencyHistogram queue_latency_;
+  LatencyHistogram render_latency_;
+  LatencyHistogram total_latency_;
+};
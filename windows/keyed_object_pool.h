@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Reuses objects which are expensive to create, e.g. COM objects, per key.
+//
+// |Acquire| hands out the same object for a key until it's released, at
+// which point the object goes to an idle list. Another key takes an idle
+// object over after |Resetter| cleared its state, and only misses call the
+// |Factory|. At most |Config::max_idle| objects are kept idle.
+//
+// |Ptr| is a smart pointer type testing false if empty, like wil::com_ptr.
+// Not thread-safe.
+template <typename Key, typename Ptr>
+class KeyedObjectPool {
+ public:
+  // Returns a new object or an empty one on failure.
+  typedef std::function<Ptr()> Factory;
+  // Restores the state of a newly created object.
+  typedef std::function<void(const Ptr&)> Resetter;
+
+  struct Config {
+    size_t max_idle = 10;
+  };
+
+  struct Stats {
+    // Acquisitions served by an object of the same key or an idle one.
+    uint64_t hits;
+    // Acquisitions which had to create an object.
+    uint64_t misses;
+    uint64_t failures;
+    size_t active;
+    size_t idle;
+  };
+
+  KeyedObjectPool(Factory factory, Resetter resetter, const Config& config)
+      : factory_(std::move(factory)),
+        resetter_(std::move(resetter)),
+        config_(config) {}
+
+  KeyedObjectPool(Factory factory, Resetter resetter)
+      : KeyedObjectPool(std::move(factory), std::move(resetter), Config{}) {}
+
+  // Returns the object for |key|, which stays assigned until |Release|.
+  // Returns an empty pointer if creating one failed.
+  Ptr Acquire(const Key& key) {
+    const auto it = active_.find(key);
+    if (it != active_.end()) {
+      stats_.hits++;
+      return it->second;
+    }
+
+    Ptr object;
+    if (!idle_.empty()) {
+      object = std::move(idle_.back());
+      idle_.pop_back();
+      resetter_(object);
+      stats_.hits++;
+    } else {
+      object = factory_();
+      if (!object) {
+        stats_.failures++;
+        return object;
+      }
+      stats_.misses++;
+    }
+    active_.emplace(key, object);
+    return object;
+  }
+
+  // Returns the object of |key| to the idle list, if it has one.
+  void Release(const Key& key) {
+    const auto it = active_.find(key);
+    if (it == active_.end()) {
+      return;
+    }
+    if (idle_.size() < config_.max_idle) {
+      idle_.push_back(std::move(it->second));
+    }
+    active_.erase(it);
+  }
+
+  // Releases all objects, including active ones.
+  void Clear() {
+    active_.clear();
+    idle_.clear();
+  }
+
+  Stats stats() const {
+    Stats stats = stats_;
+    stats.active = active_.size();
+    stats.idle = idle_.size();
+    return stats;
+  }
+
+ private:
+  Factory factory_;
+  Resetter resetter_;
+  Config config_;
+  std::unordered_map<Key, Ptr> active_;
+  // Most recently released last.
+  std::vector<Ptr> idle_;
+  Stats stats_ = {};
+};
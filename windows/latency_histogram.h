@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// A lock-free histogram of durations with power-of-two buckets.
+//
+// Bucket 0 counts samples below |kFirstBucketLimit|, every following bucket
+// doubles the limit of its predecessor and the last one is open-ended.
+// Recording is safe from any thread; snapshots may be slightly torn while
+// samples are being recorded concurrently.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kBucketCount = 14;
+  static constexpr std::chrono::microseconds kFirstBucketLimit{128};
+
+  struct Snapshot {
+    std::array<uint64_t, kBucketCount> counts;
+    uint64_t count;
+    std::chrono::microseconds sum;
+    std::chrono::microseconds max;
+
+    std::chrono::microseconds mean() const {
+      return count > 0 ? sum / static_cast<int64_t>(count)
+                       : std::chrono::microseconds(0);
+    }
+
+    // Returns the upper bound of the bucket containing the |p|th percentile
+    // (0-100), or |max| if that's the open-ended bucket.
+    std::chrono::microseconds Percentile(double p) const {
+      const auto rank = static_cast<uint64_t>(count * p / 100.0);
+      uint64_t seen = 0;
+      for (size_t i = 0; i < kBucketCount; i++) {
+        seen += counts[i];
+        if (seen > rank) {
+          return i + 1 < kBucketCount ? BucketLimit(i) : max;
+        }
+      }
+      return max;
+    }
+  };
+
+  // The exclusive upper bound of bucket |index|.
+  static constexpr std::chrono::microseconds BucketLimit(size_t index) {
+    return kFirstBucketLimit * (uint64_t{1} << index);
+  }
+
+  void Record(std::chrono::microseconds value) {
+    const auto us =
+        static_cast<uint64_t>(value.count() > 0 ? value.count() : 0);
+    const auto scaled = us / static_cast<uint64_t>(kFirstBucketLimit.count());
+    const auto index =
+        std::min<size_t>(std::bit_width(scaled), kBucketCount - 1);
+
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(us, std::memory_order_relaxed);
+
+    auto max = max_us_.load(std::memory_order_relaxed);
+    while (us > max && !max_us_.compare_exchange_weak(
+                           max, us, std::memory_order_relaxed)) {
+    }
+  }
+
+  template <typename Rep, typename Period>
+  void Record(std::chrono::duration<Rep, Period> value) {
+    Record(std::chrono::duration_cast<std::chrono::microseconds>(value));
+  }
+
+  Snapshot GetSnapshot() const {
+    Snapshot snapshot = {};
+    for (size_t i = 0; i < kBucketCount; i++) {
+      snapshot.counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.sum =
+        std::chrono::microseconds(sum_us_.load(std::memory_order_relaxed));
+    snapshot.max =
+        std::chrono::microseconds(max_us_.load(std::memory_order_relaxed));
+    return snapshot;
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_ = {};
+  std::atomic<uint64_t> count_ = 0;
+  std::atomic<uint64_t> sum_us_ = 0;
+  std::atomic<uint64_t> max_us_ = 0;
+};
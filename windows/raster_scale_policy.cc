@@ -0,0 +1,80 @@
+#include "raster_scale_policy.h"
+
+#include <algorithm>
+
+RasterScalePolicy::RasterScalePolicy(Clock clock)
+    : RasterScalePolicy(Config{}, clock) {}
+
+RasterScalePolicy::RasterScalePolicy(const Config& config, Clock clock)
+    : config_(config), clock_(std::move(clock)) {
+  config_.reduced_scale = std::clamp(config_.reduced_scale, 0.1, 1.0);
+}
+
+bool RasterScalePolicy::SetEnabled(bool enabled) {
+  enabled_ = enabled;
+  window_start_.reset();
+  const bool changed = reduced_;
+  reduced_ = false;
+  return changed;
+}
+
+bool RasterScalePolicy::OnResize() {
+  if (!enabled_) {
+    return false;
+  }
+  return Reduce(clock_() + config_.resize_hold);
+}
+
+bool RasterScalePolicy::Update(const FrameCounts& counts) {
+  if (!enabled_) {
+    return false;
+  }
+
+  const auto now = clock_();
+  bool changed = false;
+  if (!window_start_.has_value()) {
+    ResetWindow(now, counts);
+  } else if (now - *window_start_ >= config_.window) {
+    const auto seconds =
+        std::chrono::duration<double>(now - *window_start_).count();
+    // Counters may have been reset in between.
+    const auto delivered = counts.delivered >= window_counts_.delivered
+                               ? counts.delivered - window_counts_.delivered
+                               : 0;
+    const auto consumed = counts.consumed >= window_counts_.consumed
+                              ? counts.consumed - window_counts_.consumed
+                              : 0;
+    ResetWindow(now, counts);
+
+    if (consumed / seconds >= config_.min_consumed_fps &&
+        consumed < config_.min_consumed_ratio * delivered) {
+      changed = Reduce(now + config_.pressure_hold);
+    }
+  }
+
+  if (reduced_ && now >= reduced_until_) {
+    reduced_ = false;
+    // Frames get lost while the capture pool is recreated for the new size,
+    // which isn't pressure.
+    window_start_.reset();
+    changed = true;
+  }
+  return changed;
+}
+
+bool RasterScalePolicy::Reduce(TimePoint until) {
+  const bool changed = !reduced_;
+  reduced_until_ = reduced_ ? std::max(reduced_until_, until) : until;
+  reduced_ = true;
+  if (changed) {
+    // See |Update|.
+    window_start_.reset();
+  }
+  return changed;
+}
+
+void RasterScalePolicy::ResetWindow(TimePoint now,
+                                    const FrameCounts& counts) {
+  window_start_ = now;
+  window_counts_ = counts;
+}
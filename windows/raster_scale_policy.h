@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+// Decides when a webview renders at a reduced rasterization scale.
+//
+// Resizes and frame-time pressure switch to |Config::reduced_scale| right
+// away, trading sharpness for frame rate while the texture gets upscaled.
+// Full scale returns once neither happened for a hold period.
+//
+// Pressure is sampled over fixed windows from cumulative frame counters: the
+// texture is painted at an animation rate, yet a notable share of the
+// delivered frames get replaced before the consumer picks them up.
+//
+// Not thread-safe.
+class RasterScalePolicy {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::function<TimePoint()> Clock;
+
+  struct Config {
+    // Multiplies the display scale while reduced.
+    double reduced_scale = 0.5;
+    // How long to stay reduced after the last resize.
+    std::chrono::milliseconds resize_hold{500};
+    // How long to stay reduced after pressure was last detected.
+    std::chrono::milliseconds pressure_hold{3000};
+    std::chrono::milliseconds window{500};
+    // Pressure is only considered while frames get consumed at least this
+    // fast...
+    double min_consumed_fps = 20;
+    // ...and less than this share of the delivered ones got consumed.
+    double min_consumed_ratio = 0.9;
+  };
+
+  // Cumulative counters, e.g. from |FrameStats|.
+  struct FrameCounts {
+    // Frames signaled to the consumer.
+    uint64_t delivered;
+    // Frames the consumer picked up.
+    uint64_t consumed;
+  };
+
+  explicit RasterScalePolicy(Clock clock = std::chrono::steady_clock::now);
+  RasterScalePolicy(const Config& config, Clock clock);
+
+  // Disabling restores full scale. Returns true if the scale changed.
+  bool SetEnabled(bool enabled);
+  bool enabled() const { return enabled_; }
+
+  // Records a resize. Returns true if the scale changed.
+  bool OnResize();
+
+  // Samples the frame counters and restores full scale once the hold
+  // period has passed. Returns true if the scale changed.
+  bool Update(const FrameCounts& counts);
+
+  // The factor to apply to the display scale, 1 unless reduced.
+  double scale() const { return reduced_ ? config_.reduced_scale : 1.0; }
+  bool reduced() const { return reduced_; }
+
+  // When the scale returns to full unless something happens in between,
+  // std::nullopt if it's not reduced.
+  std::optional<TimePoint> deadline() const {
+    return reduced_ ? std::make_optional(reduced_until_) : std::nullopt;
+  }
+
+ private:
+  Config config_;
+  Clock clock_;
+  bool enabled_ = false;
+  bool reduced_ = false;
+  TimePoint reduced_until_;
+
+  std::optional<TimePoint> window_start_;
+  FrameCounts window_counts_ = {};
+
+  bool Reduce(TimePoint until);
+  void ResetWindow(TimePoint now, const FrameCounts& counts);
+};
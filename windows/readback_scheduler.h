@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "util/pixel_format.h"
+
+// A mapped staging buffer.
+struct ReadbackMapping {
+  const uint8_t* data;
+  size_t stride;
+};
+
+enum class ReadbackMapStatus { kReady, kPending, kFailed };
+
+// Reads back images from the GPU without stalling the pipeline.
+//
+// |Submit| has the GPU copy an image into a staging buffer. |Poll| checks
+// without blocking whether copies have finished and, if so, converts the
+// staging buffer from |Config::format| into tightly packed RGBA in a single
+// pass, which is the only copy made on the CPU, or hands it to a custom
+// |Converter|. Staging buffers are pooled for later readbacks of the same
+// size. Callbacks run in submission order.
+//
+// |Device| abstracts the graphics API and must provide:
+//   typedef ... Source;
+//   typedef ... Staging;
+//   std::optional<Staging> CreateStaging(size_t width, size_t height);
+//   // Enqueues copying the top left |width| x |height| pixels of |source|.
+//   bool Copy(const Source& source, Staging& staging, size_t width,
+//             size_t height);
+//   ReadbackMapStatus TryMap(Staging& staging, ReadbackMapping* mapping);
+//   void Unmap(Staging& staging);
+//
+// Not thread-safe.
+template <typename Device>
+class ReadbackScheduler {
+ public:
+  typedef typename Device::Source Source;
+  typedef typename Device::Staging Staging;
+
+  struct Image {
+    size_t width;
+    size_t height;
+    // Tightly packed RGBA.
+    std::vector<uint8_t> pixels;
+  };
+
+  // Receives std::nullopt if the readback failed or got cancelled.
+  typedef std::function<void(std::optional<Image> image)> Callback;
+  // Turns the mapped pixels, in |Config::format|, into the image handed to
+  // the callback.
+  // Returns std::nullopt on failure.
+  typedef std::function<std::optional<Image>(
+      const ReadbackMapping& mapping, size_t width, size_t height)>
+      Converter;
+
+  struct Config {
+    // Further submissions are rejected while this many are pending.
+    size_t max_in_flight = 4;
+    // Idle staging buffers kept for reuse.
+    size_t max_pooled = 2;
+    // The format of the mapped staging buffers.
+    util::PixelFormat format = util::PixelFormat::kBgra8;
+  };
+
+  struct Stats {
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t failed;
+    uint64_t rejected;
+    uint64_t staging_allocations;
+    uint64_t staging_reuses;
+  };
+
+  ReadbackScheduler(Device device, const Config& config)
+      : device_(std::move(device)), config_(config) {}
+
+  explicit ReadbackScheduler(Device device)
+      : ReadbackScheduler(std::move(device), Config{}) {}
+
+  ~ReadbackScheduler() { CancelAll(); }
+
+  // Starts reading back the top left |width| x |height| pixels of |source|.
+  // Returns false, without invoking |callback|, if the readback couldn't be
+  // started.
+  bool Submit(const Source& source, size_t width, size_t height,
+              Callback callback, Converter converter = nullptr) {
+    if (width == 0 || height == 0 || pending_.size() >= config_.max_in_flight) {
+      stats_.rejected++;
+      return false;
+    }
+
+    auto staging = TakeStaging(width, height);
+    if (!staging) {
+      stats_.rejected++;
+      return false;
+    }
+
+    if (!device_.Copy(source, staging->staging, width, height)) {
+      RecycleStaging(std::move(*staging));
+      stats_.rejected++;
+      return false;
+    }
+
+    pending_.push_back(
+        {std::move(*staging), std::move(callback), std::move(converter)});
+    stats_.submitted++;
+    return true;
+  }
+
+  // Completes finished readbacks. Never blocks. Returns the number of
+  // readbacks still pending.
+  size_t Poll() {
+    while (!pending_.empty()) {
+      auto& front = pending_.front();
+      ReadbackMapping mapping = {};
+      const auto status = device_.TryMap(front.entry.staging, &mapping);
+      if (status == ReadbackMapStatus::kPending) {
+        // Copies finish in order.
+        break;
+      }
+
+      auto readback = std::move(front);
+      pending_.pop_front();
+
+      if (status == ReadbackMapStatus::kFailed) {
+        stats_.failed++;
+        readback.callback(std::nullopt);
+        continue;
+      }
+
+      const auto width = readback.entry.width;
+      const auto height = readback.entry.height;
+      auto image = readback.converter
+                       ? readback.converter(mapping, width, height)
+                       : Convert(mapping, width, height);
+      device_.Unmap(readback.entry.staging);
+      RecycleStaging(std::move(readback.entry));
+
+      if (image) {
+        stats_.completed++;
+      } else {
+        stats_.failed++;
+      }
+      // May submit further readbacks.
+      readback.callback(std::move(image));
+    }
+    return pending_.size();
+  }
+
+  // Fails all pending readbacks.
+  void CancelAll() {
+    while (!pending_.empty()) {
+      auto readback = std::move(pending_.front());
+      pending_.pop_front();
+      stats_.failed++;
+      readback.callback(std::nullopt);
+    }
+  }
+
+  // Frees all idle staging buffers.
+  void Clear() { idle_.clear(); }
+
+  size_t pending_count() const { return pending_.size(); }
+  size_t pooled_count() const { return idle_.size(); }
+  const Config& config() const { return config_; }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    Staging staging;
+    size_t width;
+    size_t height;
+  };
+
+  struct Readback {
+    Entry entry;
+    Callback callback;
+    Converter converter;
+  };
+
+  Device device_;
+  Config config_;
+  // Oldest first.
+  std::deque<Readback> pending_;
+  // Most recently used first.
+  std::list<Entry> idle_;
+  Stats stats_ = {};
+
+  std::optional<Image> Convert(const ReadbackMapping& mapping, size_t width,
+                               size_t height) const {
+    constexpr auto kImageFormat = util::PixelFormat::kRgba8;
+    const auto stride = util::RowBytes(kImageFormat, width);
+    Image image = {width, height, std::vector<uint8_t>(stride * height)};
+    if (!util::ConvertPixels(config_.format, mapping.data, mapping.stride,
+                             kImageFormat, image.pixels.data(), stride, width,
+                             height)) {
+      return std::nullopt;
+    }
+    return image;
+  }
+
+  std::optional<Entry> TakeStaging(size_t width, size_t height) {
+    for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+      if (it->width == width && it->height == height) {
+        Entry entry = std::move(*it);
+        idle_.erase(it);
+        stats_.staging_reuses++;
+        return entry;
+      }
+    }
+
+    auto staging = device_.CreateStaging(width, height);
+    if (!staging) {
+      return std::nullopt;
+    }
+    stats_.staging_allocations++;
+    return Entry{std::move(*staging), width, height};
+  }
+
+  void RecycleStaging(Entry entry) {
+    idle_.push_front(std::move(entry));
+    while (idle_.size() > config_.max_pooled) {
+      idle_.pop_back();
+    }
+  }
+};
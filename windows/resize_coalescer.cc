@@ -0,0 +1,65 @@
+#include "resize_coalescer.h"
+
+ResizeCoalescer::ResizeCoalescer(std::chrono::milliseconds interval,
+                                 Clock clock)
+    : interval_(interval), clock_(std::move(clock)) {}
+
+std::optional<ResizeCoalescer::Size> ResizeCoalescer::Request(
+    const Size& size) {
+  stats_.resizes_requested++;
+
+  if (pending_.has_value()) {
+    stats_.resizes_collapsed++;
+    pending_ = size;
+    return Poll();
+  }
+
+  if (applied_ == size) {
+    stats_.resizes_collapsed++;
+    return std::nullopt;
+  }
+
+  const auto now = clock_();
+  if (last_applied_.has_value() && now < *last_applied_ + interval_) {
+    pending_ = size;
+    return std::nullopt;
+  }
+
+  return Apply(size, now);
+}
+
+std::optional<ResizeCoalescer::Size> ResizeCoalescer::Poll() {
+  if (!pending_.has_value()) {
+    return std::nullopt;
+  }
+
+  const auto now = clock_();
+  if (now < *deadline()) {
+    return std::nullopt;
+  }
+
+  const auto size = *pending_;
+  pending_.reset();
+
+  // The burst ended where it started.
+  if (applied_ == size) {
+    stats_.resizes_collapsed++;
+    return std::nullopt;
+  }
+  return Apply(size, now);
+}
+
+std::optional<ResizeCoalescer::TimePoint> ResizeCoalescer::deadline() const {
+  if (!pending_.has_value()) {
+    return std::nullopt;
+  }
+  return *last_applied_ + interval_;
+}
+
+std::optional<ResizeCoalescer::Size> ResizeCoalescer::Apply(const Size& size,
+                                                            TimePoint now) {
+  applied_ = size;
+  last_applied_ = now;
+  stats_.resizes_applied++;
+  return size;
+}
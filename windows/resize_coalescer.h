@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+// Debounces surface resizes so that at most one gets applied per interval.
+//
+// A request arriving less than an interval after the last applied resize is
+// held back and replaces any other pending one. The pending size is handed
+// out by |Poll| once the interval has passed, so the final size of a burst
+// is always applied.
+//
+// Not thread-safe.
+class ResizeCoalescer {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::function<TimePoint()> Clock;
+
+  struct Size {
+    size_t width;
+    size_t height;
+    float scale_factor;
+
+    bool operator==(const Size& other) const {
+      return width == other.width && height == other.height &&
+             scale_factor == other.scale_factor;
+    }
+  };
+
+  struct Stats {
+    uint64_t resizes_requested;
+    uint64_t resizes_applied;
+    // Requests replaced by a later one or matching the current size.
+    uint64_t resizes_collapsed;
+  };
+
+  // One frame at 60 Hz.
+  static constexpr std::chrono::milliseconds kDefaultInterval{16};
+
+  explicit ResizeCoalescer(
+      std::chrono::milliseconds interval = kDefaultInterval,
+      Clock clock = std::chrono::steady_clock::now);
+
+  // Records a requested size. Returns the size to apply right away or
+  // std::nullopt if it's been deferred or is already applied.
+  std::optional<Size> Request(const Size& size);
+
+  // Returns the pending size if it's due.
+  std::optional<Size> Poll();
+
+  // Returns when the pending size is due, std::nullopt if there is none.
+  std::optional<TimePoint> deadline() const;
+
+  std::chrono::milliseconds interval() const { return interval_; }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  std::chrono::milliseconds interval_;
+  Clock clock_;
+  std::optional<Size> applied_;
+  std::optional<TimePoint> last_applied_;
+  std::optional<Size> pending_;
+  Stats stats_ = {};
+
+  std::optional<Size> Apply(const Size& size, TimePoint now);
+};
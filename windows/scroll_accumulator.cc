@@ -0,0 +1,69 @@
+#include "scroll_accumulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Wheel deltas are sent as a signed 16-bit value.
+constexpr double kMaxUnits = std::numeric_limits<int16_t>::max();
+// Deltas went through Flutter's float scaling and the division by the device
+// pixel ratio, so a whole notch may come back slightly short.
+constexpr double kEpsilon = 1e-3;
+
+void Accumulate(double& units, double delta) {
+  if (delta == 0.0 || !std::isfinite(delta)) {
+    return;
+  }
+  if ((units < 0) != (delta < 0)) {
+    units = 0;
+  }
+  units += delta;
+}
+
+int32_t TakeWholeUnits(double& units) {
+  const auto rounded = std::round(units);
+  const auto whole =
+      std::clamp(std::abs(units - rounded) < kEpsilon ? rounded
+                                                      : std::trunc(units),
+                 -kMaxUnits, kMaxUnits);
+  units -= whole;
+  if (std::abs(units) < kEpsilon) {
+    units = 0;
+  }
+  return static_cast<int32_t>(whole);
+}
+
+}  // namespace
+
+ScrollAccumulator::ScrollAccumulator(uint32_t lines_per_scroll)
+    : pixels_per_notch_(PixelsPerNotch(lines_per_scroll)) {}
+
+// static
+double ScrollAccumulator::PixelsPerNotch(uint32_t lines_per_scroll) {
+  // Mirrors FlutterWindow's scroll offset multiplier. Scrolling may be
+  // disabled entirely, which can't be inverted.
+  if (lines_per_scroll == 0) {
+    lines_per_scroll = kDefaultLinesPerScroll;
+  }
+  return lines_per_scroll * 100.0 / 3.0;
+}
+
+void ScrollAccumulator::Add(double delta_x, double delta_y) {
+  Accumulate(x_, delta_x * kWheelDelta / pixels_per_notch_);
+  Accumulate(y_, delta_y * kWheelDelta / pixels_per_notch_);
+}
+
+ScrollAccumulator::Delta ScrollAccumulator::Take() {
+  return {TakeWholeUnits(x_), TakeWholeUnits(y_)};
+}
+
+bool ScrollAccumulator::HasPending() const {
+  return std::abs(x_) >= 1.0 - kEpsilon || std::abs(y_) >= 1.0 - kEpsilon;
+}
+
+void ScrollAccumulator::Reset() {
+  x_ = 0;
+  y_ = 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+// Turns scroll deltas into wheel events, keeping fractions of a wheel unit
+// across events.
+//
+// Flutter's Windows embedder scales each wheel notch to
+// |lines_per_scroll| * 100 / 3 physical pixels before handing it to the
+// framework. This inverts that scaling, accumulates the result per axis and
+// hands out whole wheel units only, so that small trackpad deltas add up
+// instead of getting truncated away.
+//
+// Not thread-safe.
+class ScrollAccumulator {
+ public:
+  // Win32's WHEEL_DELTA.
+  static constexpr int32_t kWheelDelta = 120;
+  // Win32's default for SPI_GETWHEELSCROLLLINES.
+  static constexpr uint32_t kDefaultLinesPerScroll = 3;
+
+  struct Delta {
+    int32_t x;
+    int32_t y;
+  };
+
+  explicit ScrollAccumulator(
+      uint32_t lines_per_scroll = kDefaultLinesPerScroll);
+
+  // The physical pixels Flutter scrolls per wheel notch.
+  static double PixelsPerNotch(uint32_t lines_per_scroll);
+
+  // Adds a delta in physical pixels. A change of direction drops the
+  // fraction accumulated for that axis.
+  void Add(double delta_x, double delta_y);
+
+  // Returns the accumulated whole wheel units and keeps the rest. Each axis
+  // is limited to the range of a wheel event.
+  Delta Take();
+
+  // Returns true if |Take| would return a non-zero delta.
+  bool HasPending() const;
+
+  void Reset();
+
+  double pixels_per_notch() const { return pixels_per_notch_; }
+
+ private:
+  double pixels_per_notch_;
+  // In wheel units.
+  double x_ = 0;
+  double y_ = 0;
+};
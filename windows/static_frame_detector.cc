@@ -0,0 +1,214 @@
+#include "static_frame_detector.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include "tile_differ.h"
+#include "util/d3dutil.h"
+
+namespace {
+// |TileDiffer::Hash| hashes pixels of this size.
+constexpr size_t kHashBytesPerPixel = 4;
+}  // namespace
+
+StaticFrameDetector::StaticFrameDetector(
+    const GraphicsContext* graphics_context, const Config& config)
+    : graphics_context_(graphics_context), config_(config) {
+  config_.fingerprint_size = std::max<uint32_t>(config_.fingerprint_size, 1);
+
+  // Fingerprinting happens on the capture thread while the raster thread may
+  // be copying frames.
+  graphics_context_->EnableMultithreadProtection();
+}
+
+bool StaticFrameDetector::IsUnchanged(ID3D11Texture2D* texture,
+                                      TimePoint now) {
+  ReadFinished();
+
+  // Without the fingerprints of all earlier frames, the frame counts as
+  // changed.
+  const bool has_pending =
+      std::any_of(staging_.begin(), staging_.end(),
+                  [](const Staging& staging) { return staging.pending; });
+  const bool is_unchanged =
+      last_unchanged_ && !has_pending &&
+      !held_frames_.changed_arrival_time &&
+      now - last_changed_ < config_.refresh_interval;
+
+  // Frames that can't be fingerprinted are never held.
+  if (!Submit(texture, is_unchanged, now) || !is_unchanged) {
+    last_changed_ = now;
+    return false;
+  }
+  return true;
+}
+
+StaticFrameDetector::HeldFrames StaticFrameDetector::PollHeldFrames() {
+  ReadFinished();
+  return std::exchange(held_frames_, {});
+}
+
+bool StaticFrameDetector::HasHeldPending() const {
+  return std::any_of(staging_.begin(), staging_.end(),
+                     [](const Staging& staging) {
+                       return staging.pending && staging.held;
+                     });
+}
+
+void StaticFrameDetector::Reset() {
+  last_fingerprint_.reset();
+  last_unchanged_ = false;
+}
+
+bool StaticFrameDetector::Submit(ID3D11Texture2D* texture, bool held,
+                                 TimePoint arrival_time) {
+  D3D11_TEXTURE2D_DESC desc;
+  texture->GetDesc(&desc);
+  if (desc.Format != ToDxgiFormat(config_.pixel_format) ||
+      !EnsureResources(desc.Width, desc.Height)) {
+    return false;
+  }
+
+  auto& staging = staging_[next_staging_];
+  // All copies are still in flight.
+  if (staging.pending) {
+    return false;
+  }
+
+  auto device_context = graphics_context_->d3d_device_context();
+  device_context->CopySubresourceRegion(mip_texture_.get(), 0, 0, 0, 0,
+                                        texture, 0, nullptr);
+  device_context->GenerateMips(mip_view_.get());
+  device_context->CopySubresourceRegion(staging.texture.get(), 0, 0, 0, 0,
+                                        mip_texture_.get(), fingerprint_level_,
+                                        nullptr);
+  // Get the copy going so that it has finished by the next frame.
+  device_context->Flush();
+
+  staging.pending = true;
+  staging.held = held;
+  staging.arrival_time = arrival_time;
+  next_staging_ = (next_staging_ + 1) % kStagingCount;
+  return true;
+}
+
+void StaticFrameDetector::ReadFinished() {
+  for (size_t i = 0; i < kStagingCount; i++) {
+    auto& staging = staging_[(next_staging_ + i) % kStagingCount];
+    if (!staging.pending) {
+      continue;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    const auto hr = graphics_context_->d3d_device_context()->Map(
+        staging.texture.get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT,
+        &mapped);
+    // Later copies can't have finished either.
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+      return;
+    }
+
+    std::optional<uint64_t> fingerprint;
+    if (SUCCEEDED(hr)) {
+      // Wider pixels are hashed as several narrow ones.
+      const auto units_per_pixel =
+          util::BytesPerPixel(config_.pixel_format) / kHashBytesPerPixel;
+      fingerprint = TileDiffer::Hash(
+          static_cast<const uint8_t*>(mapped.pData), mapped.RowPitch,
+          std::max(width_ >> fingerprint_level_, 1u) * units_per_pixel,
+          std::max(height_ >> fingerprint_level_, 1u));
+      graphics_context_->d3d_device_context()->Unmap(staging.texture.get(),
+                                                     0);
+    }
+
+    // A frame that couldn't be fingerprinted counts as changed.
+    last_unchanged_ = fingerprint && fingerprint == last_fingerprint_;
+    last_fingerprint_ = fingerprint;
+    if (staging.held && last_unchanged_) {
+      held_frames_.unchanged_count++;
+    } else if (staging.held && !held_frames_.changed_arrival_time) {
+      held_frames_.changed_arrival_time = staging.arrival_time;
+    }
+    staging.pending = false;
+  }
+}
+
+bool StaticFrameDetector::EnsureResources(uint32_t width, uint32_t height) {
+  if (mip_texture_ && width == width_ && height == height_) {
+    return true;
+  }
+
+  ReleaseResources();
+  // Fingerprints of different sizes aren't comparable.
+  Reset();
+
+  uint32_t level = 0;
+  while (std::max(width >> level, height >> level) > config_.fingerprint_size) {
+    level++;
+  }
+  const auto level_width = std::max(width >> level, 1u);
+  const auto level_height = std::max(height >> level, 1u);
+
+  D3D11_TEXTURE2D_DESC desc = {};
+  desc.ArraySize = 1;
+  desc.MipLevels = level + 1;
+  desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+  desc.CPUAccessFlags = 0;
+  desc.Format = ToDxgiFormat(config_.pixel_format);
+  desc.Width = width;
+  desc.Height = height;
+  desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+  desc.SampleDesc.Count = 1;
+  desc.SampleDesc.Quality = 0;
+  desc.Usage = D3D11_USAGE_DEFAULT;
+
+  auto device = graphics_context_->d3d_device();
+  if (FAILED(device->CreateTexture2D(&desc, nullptr, mip_texture_.put())) ||
+      FAILED(device->CreateShaderResourceView(mip_texture_.get(), nullptr,
+                                              mip_view_.put()))) {
+    std::cerr << "Creating the fingerprint mip chain failed" << std::endl;
+    ReleaseResources();
+    return false;
+  }
+
+  desc.MipLevels = 1;
+  desc.BindFlags = 0;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+  desc.Width = level_width;
+  desc.Height = level_height;
+  desc.MiscFlags = 0;
+  desc.Usage = D3D11_USAGE_STAGING;
+  for (auto& staging : staging_) {
+    if (FAILED(device->CreateTexture2D(&desc, nullptr,
+                                       staging.texture.put()))) {
+      std::cerr << "Creating the fingerprint staging texture failed"
+                << std::endl;
+      ReleaseResources();
+      return false;
+    }
+  }
+
+  width_ = width;
+  height_ = height;
+  fingerprint_level_ = level;
+
+  // The mip chain adds up to a third of the base level.
+  const auto base_bytes = util::ImageBytes(config_.pixel_format, width, height);
+  gpu_bytes_ = base_bytes + base_bytes / 3 +
+               util::ImageBytes(config_.pixel_format, level_width,
+                                level_height) *
+                   kStagingCount;
+  return true;
+}
+
+size_t StaticFrameDetector::ReleaseResources() {
+  mip_view_ = nullptr;
+  mip_texture_ = nullptr;
+  staging_ = {};
+  next_staging_ = 0;
+  width_ = 0;
+  height_ = 0;
+  Reset();
+  return gpu_bytes_.exchange(0);
+}
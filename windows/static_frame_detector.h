@@ -0,0 +1,121 @@
+#pragma once
+
+#include <d3d11.h>
+#include <winrt/base.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "graphics_context.h"
+#include "util/pixel_format.h"
+
+// Recognizes captured frames showing the same content as the last frame that
+// was signaled to Flutter.
+//
+// Frames are fingerprinted by having the GPU downsample them into a mip chain
+// and hashing one of the small levels on the CPU. Changes too subtle to
+// survive the downsampling may go unnoticed, so frames are never considered
+// unchanged for longer than |Config::refresh_interval|.
+//
+// The small level is read back without waiting for the GPU, so a frame's
+// fingerprint is usually only known when the next one arrives. Frames are
+// therefore held back if the ones before them didn't change, and only count
+// as suppressed once their own fingerprint confirms it. A held frame which
+// turns out to have changed is reported by |PollHeldFrames|, so it is shown
+// late by the time its fingerprint takes to be read back plus the polling
+// interval, rather than not at all.
+//
+// Not thread-safe, except for |gpu_bytes|.
+class StaticFrameDetector {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+
+  struct Config {
+    // The hashed mip level is the largest one not exceeding this size in
+    // either dimension.
+    uint32_t fingerprint_size = 256;
+    std::chrono::milliseconds refresh_interval{1000};
+    // The format of the frames, others are never considered unchanged.
+    util::PixelFormat pixel_format = util::PixelFormat::kBgra8;
+  };
+
+  StaticFrameDetector(const GraphicsContext* graphics_context,
+                      const Config& config);
+
+  // The outcome of the held frames whose fingerprints were read back.
+  struct HeldFrames {
+    // Frames which matched their predecessor.
+    size_t unchanged_count = 0;
+    // The arrival of the first frame which turned out to differ from its
+    // predecessor. The latest frame should be shown then.
+    std::optional<TimePoint> changed_arrival_time;
+  };
+
+  // Returns true if the frames before |texture|, which arrived at |now|,
+  // didn't change, so that it most likely didn't either. The frame is held
+  // until its fingerprint is read back. Never blocks on the GPU.
+  bool IsUnchanged(ID3D11Texture2D* texture, TimePoint now);
+
+  // Returns the held frames whose fingerprints were read back since the last
+  // call.
+  HeldFrames PollHeldFrames();
+
+  // Whether fingerprints of held frames are still being read back, so that
+  // |PollHeldFrames| should be called again.
+  bool HasHeldPending() const;
+
+  // Makes the next frame count as changed.
+  void Reset();
+
+  // Returns the number of bytes freed.
+  size_t ReleaseResources();
+
+  // May be called from any thread.
+  size_t gpu_bytes() const {
+    return gpu_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // A CPU-readable copy of a frame's hashed level.
+  struct Staging {
+    winrt::com_ptr<ID3D11Texture2D> texture;
+    // Set until the copy was read back.
+    bool pending = false;
+    // Whether |IsUnchanged| returned true for the frame.
+    bool held = false;
+    TimePoint arrival_time;
+  };
+
+  // Fingerprints usually finish within a frame, one more covers hiccups.
+  static constexpr size_t kStagingCount = 3;
+
+  const GraphicsContext* graphics_context_;
+  Config config_;
+  // The fingerprint of the newest frame read back.
+  std::optional<uint64_t> last_fingerprint_;
+  // Whether that frame matched the one before it.
+  bool last_unchanged_ = false;
+  // Collected for |PollHeldFrames|.
+  HeldFrames held_frames_;
+  TimePoint last_changed_;
+
+  // Receives the frame and its downsampled levels.
+  winrt::com_ptr<ID3D11Texture2D> mip_texture_;
+  winrt::com_ptr<ID3D11ShaderResourceView> mip_view_;
+  // Used in submission order, starting at |next_staging_|.
+  std::array<Staging, kStagingCount> staging_;
+  size_t next_staging_ = 0;
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  uint32_t fingerprint_level_ = 0;
+  std::atomic<size_t> gpu_bytes_ = 0;
+
+  bool EnsureResources(uint32_t width, uint32_t height);
+  // Starts fingerprinting |texture|. Returns false if it can't be.
+  bool Submit(ID3D11Texture2D* texture, bool held, TimePoint arrival_time);
+  // Reads back the fingerprints which are ready, oldest first.
+  void ReadFinished();
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <utility>
+
+// Recycles surfaces whose size only differs slightly.
+//
+// Surfaces are allocated with their dimensions rounded up to a multiple of
+// |Config::granularity|, so a resize only needs a new surface once it crosses
+// a bucket boundary. Surfaces handed back via |Recycle| are kept in LRU order
+// and evicted once the bytes held by the pool exceed |Config::max_bytes|.
+// Surfaces in use are accounted for but never evicted.
+//
+// Not thread-safe.
+template <typename Surface>
+class SurfacePool {
+ public:
+  // Returns a new surface of the given dimensions or std::nullopt on failure.
+  typedef std::function<std::optional<Surface>(size_t width, size_t height)>
+      Allocator;
+
+  struct Config {
+    size_t granularity = 64;
+    size_t bytes_per_pixel = 4;
+    size_t max_bytes = 64 * 1024 * 1024;
+  };
+
+  struct Entry {
+    Surface surface;
+    // The allocated dimensions, which may exceed the requested ones.
+    size_t width;
+    size_t height;
+  };
+
+  struct Stats {
+    uint64_t allocations;
+    uint64_t reuses;
+    uint64_t evictions;
+    size_t bytes_in_use;
+    size_t bytes_pooled;
+  };
+
+  SurfacePool(Allocator allocator, const Config& config)
+      : allocator_(std::move(allocator)), config_(config) {}
+
+  explicit SurfacePool(Allocator allocator)
+      : SurfacePool(std::move(allocator), Config{}) {}
+
+  // Rounds |size| up to the next bucket boundary.
+  size_t BucketSize(size_t size) const {
+    const auto granularity = config_.granularity > 0 ? config_.granularity : 1;
+    return (size + granularity - 1) / granularity * granularity;
+  }
+
+  // Returns true if |entry| belongs to the bucket for the given dimensions.
+  bool Fits(const Entry& entry, size_t width, size_t height) const {
+    return entry.width == BucketSize(width) &&
+           entry.height == BucketSize(height);
+  }
+
+  // Takes a surface for the given dimensions out of the pool, allocating
+  // one if none is available.
+  std::optional<Entry> Acquire(size_t width, size_t height) {
+    for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+      if (Fits(*it, width, height)) {
+        Entry entry = std::move(*it);
+        idle_.erase(it);
+        const auto bytes = BytesOf(entry);
+        stats_.bytes_pooled -= bytes;
+        stats_.bytes_in_use += bytes;
+        stats_.reuses++;
+        return entry;
+      }
+    }
+
+    const auto bucket_width = BucketSize(width);
+    const auto bucket_height = BucketSize(height);
+
+    // Make room before allocating.
+    Evict(bucket_width * bucket_height * config_.bytes_per_pixel);
+
+    auto surface = allocator_(bucket_width, bucket_height);
+    if (!surface.has_value()) {
+      return std::nullopt;
+    }
+
+    Entry entry = {std::move(*surface), bucket_width, bucket_height};
+    stats_.bytes_in_use += BytesOf(entry);
+    stats_.allocations++;
+    return entry;
+  }
+
+  // Hands a surface obtained from |Acquire| back to the pool.
+  void Recycle(Entry entry) {
+    const auto bytes = BytesOf(entry);
+    stats_.bytes_in_use -= bytes;
+    stats_.bytes_pooled += bytes;
+    idle_.push_front(std::move(entry));
+    Evict(0);
+  }
+
+  // Frees all pooled surfaces. Surfaces in use remain accounted for.
+  void Clear() {
+    stats_.evictions += idle_.size();
+    stats_.bytes_pooled = 0;
+    idle_.clear();
+  }
+
+  // Frees pooled surfaces, least recently used first, until at most
+  // |max_bytes| are held. Returns the number of bytes freed.
+  size_t Trim(size_t max_bytes) {
+    const auto before = stats_.bytes_pooled;
+    while (!idle_.empty() &&
+           stats_.bytes_in_use + stats_.bytes_pooled > max_bytes) {
+      stats_.bytes_pooled -= BytesOf(idle_.back());
+      stats_.evictions++;
+      idle_.pop_back();
+    }
+    return before - stats_.bytes_pooled;
+  }
+
+  size_t pooled_count() const { return idle_.size(); }
+  const Config& config() const { return config_; }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  Allocator allocator_;
+  Config config_;
+  // Most recently used first.
+  std::list<Entry> idle_;
+  Stats stats_ = {};
+
+  size_t BytesOf(const Entry& entry) const {
+    return entry.width * entry.height * config_.bytes_per_pixel;
+  }
+
+  // Evicts until |additional_bytes| fit within the cap.
+  void Evict(size_t additional_bytes) {
+    Trim(config_.max_bytes > additional_bytes
+             ? config_.max_bytes - additional_bytes
+             : 0);
+  }
+};
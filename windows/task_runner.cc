@@ -0,0 +1,75 @@
+#include "task_runner.h"
+
+#include <windows.foundation.h>
+#include <wrl.h>
+
+#include <iostream>
+
+TaskRunner::TaskRunner(
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueue> dispatcher_queue)
+    : dispatcher_queue_(std::move(dispatcher_queue)) {}
+
+bool TaskRunner::PostTask(Task task) {
+  boolean enqueued = false;
+  auto handler =
+      Microsoft::WRL::Callback<ABI::Windows::System::IDispatcherQueueHandler>(
+          [task = std::move(task)]() -> HRESULT {
+            task();
+            return S_OK;
+          });
+  if (FAILED(dispatcher_queue_->TryEnqueue(handler.Get(), &enqueued))) {
+    return false;
+  }
+  return !!enqueued;
+}
+
+std::unique_ptr<TaskRunner::Timer> TaskRunner::CreateTimer(
+    std::chrono::milliseconds interval, Task task) {
+  winrt::com_ptr<ABI::Windows::System::IDispatcherQueueTimer> timer;
+  if (FAILED(dispatcher_queue_->CreateTimer(timer.put()))) {
+    std::cerr << "Creating DispatcherQueueTimer failed." << std::endl;
+    return nullptr;
+  }
+
+  auto result =
+      std::unique_ptr<Timer>(new Timer(std::move(timer), std::move(task)));
+  if (!result->Initialize(interval) || !result->Start()) {
+    return nullptr;
+  }
+  return result;
+}
+
+TaskRunner::Timer::Timer(
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueTimer> timer,
+    Task task)
+    : timer_(std::move(timer)), task_(std::move(task)) {}
+
+TaskRunner::Timer::~Timer() {
+  timer_->Stop();
+  timer_->remove_Tick(on_tick_token_);
+}
+
+bool TaskRunner::Timer::Start() { return SUCCEEDED(timer_->Start()); }
+
+void TaskRunner::Timer::Stop() { timer_->Stop(); }
+
+bool TaskRunner::Timer::Initialize(std::chrono::milliseconds interval) {
+  // TimeSpan is measured in 100ns ticks.
+  ABI::Windows::Foundation::TimeSpan time_span = {interval.count() * 10000};
+  if (FAILED(timer_->put_Interval(time_span)) ||
+      FAILED(timer_->put_IsRepeating(true))) {
+    return false;
+  }
+
+  timer_->add_Tick(
+      Microsoft::WRL::Callback<ABI::Windows::Foundation::ITypedEventHandler<
+          ABI::Windows::System::DispatcherQueueTimer*, IInspectable*>>(
+          [this](ABI::Windows::System::IDispatcherQueueTimer* timer,
+                 IInspectable* args) -> HRESULT {
+            task_();
+            return S_OK;
+          })
+          .Get(),
+      &on_tick_token_);
+  return true;
+}
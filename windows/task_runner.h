@@ -0,0 +1,51 @@
+#pragma once
+
+#include <windows.system.h>
+#include <winrt/base.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+// Schedules work on the thread owning a DispatcherQueue, i.e. the platform
+// thread.
+class TaskRunner {
+ public:
+  typedef std::function<void()> Task;
+
+  // Runs a task repeatedly until stopped or destroyed. Must be used on the
+  // dispatcher thread.
+  class Timer {
+   public:
+    ~Timer();
+
+    // Restarts the interval.
+    bool Start();
+    void Stop();
+
+   private:
+    friend class TaskRunner;
+
+    Timer(winrt::com_ptr<ABI::Windows::System::IDispatcherQueueTimer> timer,
+          Task task);
+    bool Initialize(std::chrono::milliseconds interval);
+
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueTimer> timer_;
+    Task task_;
+    EventRegistrationToken on_tick_token_ = {};
+  };
+
+  explicit TaskRunner(
+      winrt::com_ptr<ABI::Windows::System::IDispatcherQueue> dispatcher_queue);
+
+  // Enqueues |task|. Returns false if the queue is shutting down.
+  bool PostTask(Task task);
+
+  // Creates a started timer invoking |task| every |interval|.
+  // Returns nullptr on failure.
+  std::unique_ptr<Timer> CreateTimer(std::chrono::milliseconds interval,
+                                     Task task);
+
+ private:
+  winrt::com_ptr<ABI::Windows::System::IDispatcherQueue> dispatcher_queue_;
+};
@@ -0,0 +1,158 @@
+#include "copy_region_planner.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Rect = CopyRegionPlanner::Rect;
+
+bool Contains(const Rect& rect, uint32_t x, uint32_t y) {
+  return x >= rect.x && x < rect.x + rect.width && y >= rect.y &&
+         y < rect.y + rect.height;
+}
+
+}  // namespace
+
+TEST(CopyRegionPlannerTest, SubtractCoversDifferenceExactlyOnce) {
+  std::mt19937 rng(1);
+  const auto random_rect = [&rng]() {
+    std::uniform_int_distribution<uint32_t> position(0, 29);
+    std::uniform_int_distribution<uint32_t> size(0, 11);
+    return Rect{position(rng), position(rng), size(rng), size(rng)};
+  };
+  for (int i = 0; i < 20000; i++) {
+    const auto a = random_rect();
+    const auto b = random_rect();
+    const auto parts = CopyRegionPlanner::Subtract(a, b);
+    ASSERT_LE(parts.size(), 4u);
+
+    for (uint32_t y = 0; y < 40; y++) {
+      for (uint32_t x = 0; x < 40; x++) {
+        int count = 0;
+        for (const auto& part : parts) {
+          ASSERT_FALSE(part.IsEmpty());
+          count += Contains(part, x, y);
+        }
+        ASSERT_EQ(count, Contains(a, x, y) && !Contains(b, x, y) ? 1 : 0);
+      }
+    }
+
+    const auto overlap = CopyRegionPlanner::Intersect(a, b);
+    for (uint32_t y = 0; y < 40; y++) {
+      for (uint32_t x = 0; x < 40; x++) {
+        ASSERT_EQ(Contains(overlap, x, y),
+                  Contains(a, x, y) && Contains(b, x, y));
+      }
+    }
+  }
+}
+
+TEST(CopyRegionPlannerTest, IntersectDoesNotOverflow) {
+  const auto overlap = CopyRegionPlanner::Intersect(
+      Rect{0xfffffff0u, 0, 0x100, 10}, Rect{0, 0, 0xffffffffu, 5});
+  EXPECT_TRUE(overlap == (Rect{0xfffffff0u, 0, 0xf, 5}));
+}
+
+TEST(CopyRegionPlannerTest, CopiesWholeFrameWithoutVisibleRect) {
+  CopyRegionPlanner planner;
+  EXPECT_FALSE(planner.IsUpToDate());
+
+  const auto regions = planner.Plan(1, 100, 50);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(regions[0] == (Rect{0, 0, 100, 50}));
+  EXPECT_TRUE(planner.IsUpToDate());
+  EXPECT_TRUE(planner.Plan(1, 100, 50).empty());
+}
+
+TEST(CopyRegionPlannerTest, ScrollingCopiesOnlyExposedRows) {
+  CopyRegionPlanner planner;
+  planner.Plan(1, 100, 50);
+  planner.SetVisibleRect(Rect{0, 20, 100, 10});
+
+  auto regions = planner.Plan(2, 100, 50);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(regions[0] == (Rect{0, 20, 100, 10}));
+
+  // Scrolling by 5 rows without a new frame.
+  planner.SetVisibleRect(Rect{0, 25, 100, 10});
+  EXPECT_FALSE(planner.IsUpToDate());
+  regions = planner.Plan(2, 100, 50);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(regions[0] == (Rect{0, 30, 100, 5}));
+
+  // Shrinking exposes nothing.
+  planner.SetVisibleRect(Rect{0, 26, 100, 5});
+  EXPECT_TRUE(planner.IsUpToDate());
+  EXPECT_TRUE(planner.Plan(2, 100, 50).empty());
+}
+
+TEST(CopyRegionPlannerTest, ClampsVisibleRectToFrame) {
+  CopyRegionPlanner planner;
+  planner.SetVisibleRect(Rect{90, 45, 50, 50});
+  const auto regions = planner.Plan(1, 100, 50);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(regions[0] == (Rect{90, 45, 10, 5}));
+
+  planner.SetVisibleRect(Rect{200, 200, 10, 10});
+  EXPECT_TRUE(planner.Plan(2, 100, 50).empty());
+}
+
+TEST(CopyRegionPlannerTest, RecopiesAfterInvalidateOrResize) {
+  CopyRegionPlanner planner;
+  planner.Plan(1, 100, 50);
+  planner.Invalidate();
+  EXPECT_FALSE(planner.IsUpToDate());
+  EXPECT_EQ(planner.Plan(1, 100, 50).size(), 1u);
+
+  const auto regions = planner.Plan(1, 120, 50);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_EQ(regions[0].width, 120u);
+}
+
+TEST(CopyRegionPlannerTest, RecopiesFramesArrivedWhileHidden) {
+  CopyRegionPlanner planner;
+  planner.SetVisibleRect(Rect{0, 0, 10, 10});
+  EXPECT_EQ(planner.Plan(1, 100, 50).size(), 1u);
+
+  planner.SetVisibleRect(Rect{0, 0, 0, 0});
+  EXPECT_TRUE(planner.IsUpToDate());
+  EXPECT_TRUE(planner.Plan(2, 100, 50).empty());
+  EXPECT_TRUE(planner.Plan(3, 100, 50).empty());
+
+  planner.SetVisibleRect(Rect{0, 0, 10, 10});
+  EXPECT_FALSE(planner.IsUpToDate());
+  const auto regions = planner.Plan(3, 100, 50);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(regions[0] == (Rect{0, 0, 10, 10}));
+}
+
+TEST(CopyRegionPlannerTest, CopiesOnlyChangedPartsOfNewFrames) {
+  CopyRegionPlanner planner;
+  planner.SetVisibleRect(Rect{0, 0, 100, 30});
+  planner.Plan(1, 100, 50);
+  EXPECT_EQ(planner.generation(), 1u);
+
+  // The second change lies outside the visible rect.
+  const std::vector<Rect> changed = {{10, 10, 20, 20}, {0, 40, 100, 10}};
+  auto regions = planner.Plan(2, 100, 50, &changed);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(regions[0] == (Rect{10, 10, 20, 20}));
+
+  // Newly exposed rows are copied as a whole.
+  planner.SetVisibleRect(Rect{0, 10, 100, 30});
+  const std::vector<Rect> unchanged;
+  regions = planner.Plan(3, 100, 50, &unchanged);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(regions[0] == (Rect{0, 30, 100, 10}));
+
+  // Without a surface to update, the whole target is copied.
+  planner.Invalidate();
+  regions = planner.Plan(4, 100, 50, &unchanged);
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(regions[0] == (Rect{0, 10, 100, 30}));
+}
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "util/downscale.h"
+#include "util/pixel_format.h"
+
+namespace {
+
+constexpr size_t kWidth = 1920;
+constexpr size_t kHeight = 1080;
+constexpr size_t kThumbnailWidth = 240;
+constexpr size_t kThumbnailHeight = 135;
+
+std::vector<uint8_t> RandomFrame(util::PixelFormat format) {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> frame(util::ImageBytes(format, kWidth, kHeight));
+  for (auto& byte : frame) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  return frame;
+}
+
+// Scales a 1080p BGRA frame to a thumbnail with the kernel given by the
+// first argument.
+void BM_DownscaleBgra(benchmark::State& state) {
+  util::Downscaler scaler;
+  if (!scaler.SetKernel(static_cast<util::DownscaleKernel>(state.range(0)))) {
+    state.SkipWithError("Kernel not supported by this CPU");
+    return;
+  }
+  const auto src = RandomFrame(util::PixelFormat::kBgra8);
+  std::vector<uint8_t> dst(kThumbnailWidth * kThumbnailHeight * 4);
+
+  for (auto _ : state) {
+    scaler.Scale(src.data(), kWidth * 4, kWidth, kHeight, dst.data(),
+                 kThumbnailWidth * 4, kThumbnailWidth, kThumbnailHeight);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(src.size()));
+}
+BENCHMARK(BM_DownscaleBgra)
+    ->Arg(static_cast<int>(util::DownscaleKernel::kScalar))
+    ->Arg(static_cast<int>(util::DownscaleKernel::kSse2))
+    ->Arg(static_cast<int>(util::DownscaleKernel::kAvx2));
+
+// Scales a 1080p FP16 frame, as captured for HDR content, to a thumbnail.
+void BM_DownscaleRgba16Float(benchmark::State& state) {
+  util::Downscaler scaler;
+  const auto src = RandomFrame(util::PixelFormat::kRgba16Float);
+  std::vector<uint8_t> dst(kThumbnailWidth * kThumbnailHeight * 4);
+
+  for (auto _ : state) {
+    scaler.Scale(util::PixelFormat::kRgba16Float, src.data(), kWidth * 8,
+                 kWidth, kHeight, dst.data(), kThumbnailWidth * 4,
+                 kThumbnailWidth, kThumbnailHeight);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(src.size()));
+}
+BENCHMARK(BM_DownscaleRgba16Float);
+
+}  // namespace
@@ -0,0 +1,118 @@
+#include "util/downscale.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "util/pixel_format.h"
+
+namespace {
+
+using util::DownscaleKernel;
+using util::Downscaler;
+using util::PixelFormat;
+
+constexpr DownscaleKernel kKernels[] = {
+    DownscaleKernel::kScalar, DownscaleKernel::kSse2, DownscaleKernel::kAvx2};
+
+std::vector<uint8_t> RandomBytes(std::mt19937& rng, size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (auto& byte : bytes) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  return bytes;
+}
+
+}  // namespace
+
+TEST(DownscaleTest, KernelsAgree) {
+  std::mt19937 rng(3);
+  for (int trial = 0; trial < 300; trial++) {
+    const size_t src_width = 1 + rng() % 700;
+    const size_t src_height = 1 + rng() % 400;
+    const size_t src_stride = src_width * 4 + (rng() % 4) * 4;
+    const size_t dst_width = 1 + rng() % 200;
+    const size_t dst_height = 1 + rng() % 120;
+    const size_t dst_stride = dst_width * 4 + (rng() % 3) * 4;
+    const auto src = RandomBytes(rng, src_stride * src_height);
+
+    std::vector<uint8_t> expected;
+    for (const auto kernel : kKernels) {
+      Downscaler scaler;
+      if (!scaler.SetKernel(kernel)) {
+        continue;
+      }
+      std::vector<uint8_t> dst(dst_stride * dst_height, 0xcd);
+      ASSERT_TRUE(scaler.Scale(src.data(), src_stride, src_width, src_height,
+                               dst.data(), dst_stride, dst_width,
+                               dst_height));
+      if (expected.empty()) {
+        expected = std::move(dst);
+      } else {
+        EXPECT_EQ(dst, expected) << "kernel " << static_cast<int>(kernel);
+      }
+    }
+  }
+}
+
+TEST(DownscaleTest, UniformColorStaysExact) {
+  const size_t src_width = 1920;
+  const size_t src_height = 1080;
+  std::vector<uint8_t> src(src_width * src_height * 4);
+  for (size_t i = 0; i < src_width * src_height; i++) {
+    src[i * 4] = 10;
+    src[i * 4 + 1] = 20;
+    src[i * 4 + 2] = 30;
+    src[i * 4 + 3] = 255;
+  }
+
+  std::vector<uint8_t> dst(300 * 169 * 4);
+  Downscaler scaler;
+  ASSERT_TRUE(scaler.Scale(src.data(), src_width * 4, src_width, src_height,
+                           dst.data(), 300 * 4, 300, 169));
+  // Red and blue are swapped.
+  for (size_t i = 0; i < 300 * 169; i++) {
+    ASSERT_EQ(dst[i * 4], 30);
+    ASSERT_EQ(dst[i * 4 + 1], 20);
+    ASSERT_EQ(dst[i * 4 + 2], 10);
+    ASSERT_EQ(dst[i * 4 + 3], 255);
+  }
+}
+
+TEST(DownscaleTest, ConvertsWhileHalving) {
+  std::mt19937 rng(5);
+  for (const auto [src_width, src_height, dst_width, dst_height] :
+       {std::array<size_t, 4>{641, 359, 160, 90},
+        std::array<size_t, 4>{64, 48, 60, 40}}) {
+    // Random FP16 values in [0, 1].
+    const size_t src_stride = src_width * 8 + 16;
+    std::vector<uint8_t> src(src_stride * src_height);
+    for (size_t i = 0; i + 1 < src.size(); i += 2) {
+      const auto half = static_cast<uint16_t>(rng() % 0x3c01);
+      src[i] = static_cast<uint8_t>(half);
+      src[i + 1] = static_cast<uint8_t>(half >> 8);
+    }
+
+    // Same as converting the whole image first.
+    const auto bgra_stride = src_width * 4;
+    std::vector<uint8_t> bgra(bgra_stride * src_height);
+    ASSERT_TRUE(util::ConvertPixels(PixelFormat::kRgba16Float, src.data(),
+                                    src_stride, PixelFormat::kBgra8,
+                                    bgra.data(), bgra_stride, src_width,
+                                    src_height));
+    std::vector<uint8_t> expected(dst_width * dst_height * 4);
+    Downscaler scaler;
+    ASSERT_TRUE(scaler.Scale(bgra.data(), bgra_stride, src_width, src_height,
+                             expected.data(), dst_width * 4, dst_width,
+                             dst_height));
+
+    std::vector<uint8_t> dst(expected.size());
+    ASSERT_TRUE(scaler.Scale(PixelFormat::kRgba16Float, src.data(),
+                             src_stride, src_width, src_height, dst.data(),
+                             dst_width * 4, dst_width, dst_height));
+    EXPECT_EQ(dst, expected) << src_width << "x" << src_height;
+  }
+}
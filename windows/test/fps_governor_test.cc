@@ -0,0 +1,123 @@
+#include "fps_governor.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "frame_pacer.h"
+
+namespace {
+
+using Level = FpsGovernor::Level;
+
+// Replays synthetic frame-arrival traces through a governor and a frame
+// pacer applying its decisions, the way TextureBridge wires them up.
+class FpsGovernorTest : public ::testing::Test {
+ protected:
+  FpsGovernor::TimePoint now_;
+  FpsGovernor governor_{[this]() { return now_; }};
+  FramePacer pacer_{[this]() { return now_; }};
+
+  void SetUp() override { governor_.SetEnabled(true); }
+
+  // Runs for |duration| with the page producing |source_fps| frames per
+  // second, 0 for none. Delivered frames are picked up by the consumer if
+  // |consume| is set. Like the bridge, the governor is evaluated on every
+  // frame and on a 250 ms timer.
+  void Run(std::chrono::milliseconds duration, double source_fps,
+           bool consume) {
+    const auto end = now_ + duration;
+    const auto frame_interval = std::chrono::microseconds(
+        source_fps > 0 ? static_cast<int64_t>(1000000 / source_fps) : 0);
+    auto next_frame = now_;
+    auto next_poll = now_;
+    while (now_ < end) {
+      if (source_fps > 0 && now_ >= next_frame) {
+        next_frame += frame_interval;
+        const bool delivered = pacer_.ShouldAcceptFrame();
+        governor_.OnFrameArrived(delivered);
+        if (delivered && consume) {
+          governor_.OnFramesConsumed(1);
+        }
+        Update();
+      }
+      if (now_ >= next_poll) {
+        next_poll += std::chrono::milliseconds(250);
+        Update();
+      }
+      now_ += std::chrono::milliseconds(1);
+    }
+  }
+
+  void Update() {
+    if (governor_.Update()) {
+      pacer_.SetTargetFps(governor_.decision().max_fps);
+    }
+  }
+
+  Level level() const { return governor_.decision().level; }
+};
+
+}  // namespace
+
+TEST_F(FpsGovernorTest, StaysAtFullRateWhileFramesAreConsumed) {
+  Run(std::chrono::seconds(10), 60, true);
+  EXPECT_EQ(level(), Level::kFull);
+  EXPECT_FALSE(governor_.decision().max_fps.has_value());
+}
+
+TEST_F(FpsGovernorTest, StepsDownWhileFramesGoUnconsumed) {
+  // The texture isn't painted, e.g. the widget is offstage.
+  Run(std::chrono::milliseconds(1100), 60, false);
+  EXPECT_EQ(level(), Level::kReduced);
+  EXPECT_EQ(governor_.decision().max_fps, 30);
+
+  Run(std::chrono::seconds(1), 60, false);
+  EXPECT_EQ(level(), Level::kIdle);
+  EXPECT_EQ(governor_.decision().max_fps, 5);
+}
+
+TEST_F(FpsGovernorTest, StepsDownWithoutFrames) {
+  // A static page stops producing frames entirely, so only the timer
+  // evaluates the governor.
+  Run(std::chrono::seconds(1), 60, true);
+  EXPECT_EQ(level(), Level::kFull);
+
+  Run(std::chrono::milliseconds(1300), 0, true);
+  EXPECT_EQ(level(), Level::kReduced);
+  Run(std::chrono::seconds(1), 0, true);
+  EXPECT_EQ(level(), Level::kIdle);
+}
+
+TEST_F(FpsGovernorTest, StepsBackUpWhenContentAnimates) {
+  Run(std::chrono::seconds(3), 0, true);
+  ASSERT_EQ(level(), Level::kIdle);
+
+  // Frames arrive faster than the idle cap and the consumer keeps up.
+  Run(std::chrono::milliseconds(1300), 60, true);
+  EXPECT_EQ(level(), Level::kReduced);
+  Run(std::chrono::seconds(1), 60, true);
+  EXPECT_EQ(level(), Level::kFull);
+}
+
+TEST_F(FpsGovernorTest, ActivityRestoresFullRateAndHoldsIt) {
+  Run(std::chrono::seconds(3), 0, true);
+  ASSERT_EQ(level(), Level::kIdle);
+
+  EXPECT_TRUE(governor_.OnActivity());
+  EXPECT_EQ(level(), Level::kFull);
+  EXPECT_FALSE(governor_.OnActivity());
+
+  // Held despite the missing frames.
+  Run(std::chrono::milliseconds(1900), 0, true);
+  EXPECT_EQ(level(), Level::kFull);
+  Run(std::chrono::seconds(2), 0, true);
+  EXPECT_NE(level(), Level::kFull);
+}
+
+TEST_F(FpsGovernorTest, DisabledGovernorNeverChanges) {
+  governor_.SetEnabled(false);
+  Run(std::chrono::seconds(5), 0, false);
+  EXPECT_EQ(level(), Level::kFull);
+  EXPECT_FALSE(governor_.OnActivity());
+}
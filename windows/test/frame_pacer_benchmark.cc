@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+
+#include "frame_pacer.h"
+
+namespace {
+
+// A 144 Hz source paced down to 60 FPS on a fake clock.
+void BM_FramePacerShouldAcceptFrame(benchmark::State& state) {
+  FramePacer::TimePoint now;
+  FramePacer pacer([&now]() { return now; });
+  pacer.SetTargetFps(60);
+  const auto interval = std::chrono::microseconds(6944);
+
+  for (auto _ : state) {
+    now += interval;
+    benchmark::DoNotOptimize(pacer.ShouldAcceptFrame());
+  }
+  state.counters["accepted"] = benchmark::Counter(
+      static_cast<double>(pacer.stats().frames_accepted) / state.iterations());
+}
+BENCHMARK(BM_FramePacerShouldAcceptFrame);
+
+}  // namespace
@@ -0,0 +1,100 @@
+#include "frame_pacer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+class FramePacerTest : public ::testing::Test {
+ protected:
+  FramePacer::TimePoint now_;
+  FramePacer pacer_{[this]() { return now_; }};
+  std::vector<FramePacer::TimePoint> accepted_;
+
+  void Advance(Milliseconds duration) {
+    now_ += std::chrono::duration_cast<FramePacer::TimePoint::duration>(
+        duration);
+  }
+
+  // Feeds frames arriving at |source_fps| for |seconds|, each off by a
+  // normally distributed error with a standard deviation of |jitter_ms|.
+  // Returns the number of frames accepted.
+  int Feed(double source_fps, double seconds, double jitter_ms = 0) {
+    std::mt19937 rng(1);
+    std::normal_distribution<double> jitter(0, jitter_ms);
+    const auto start = now_;
+    const auto frames = static_cast<int>(source_fps * seconds);
+    int accepted = 0;
+    for (int i = 0; i < frames; i++) {
+      now_ = start;
+      Advance(Milliseconds(1000.0 / source_fps * i +
+                           (jitter_ms > 0 ? jitter(rng) : 0)));
+      if (pacer_.ShouldAcceptFrame()) {
+        accepted_.push_back(now_);
+        accepted++;
+      }
+    }
+    return accepted;
+  }
+};
+
+}  // namespace
+
+TEST_F(FramePacerTest, AcceptsEveryFrameWithoutLimit) {
+  EXPECT_EQ(Feed(144, 1), 144);
+  EXPECT_EQ(pacer_.stats().frames_dropped, 0u);
+}
+
+TEST_F(FramePacerTest, NonPositiveFpsDisablesPacing) {
+  pacer_.SetTargetFps(0);
+  EXPECT_FALSE(pacer_.target_fps().has_value());
+  EXPECT_EQ(Feed(60, 1), 60);
+}
+
+TEST_F(FramePacerTest, DeliversEveryOtherFrameAtHalfRate) {
+  pacer_.SetTargetFps(30);
+  EXPECT_EQ(Feed(60, 10, 0.5), 300);
+
+  // The cadence stays even despite the arrival jitter.
+  for (size_t i = 1; i < accepted_.size(); i++) {
+    EXPECT_NEAR(Milliseconds(accepted_[i] - accepted_[i - 1]).count(),
+                1000.0 / 30, 3);
+  }
+  EXPECT_LT(pacer_.stats().max_jitter.count(), 5);
+}
+
+TEST_F(FramePacerTest, DoesNotAccumulateErrorAtUnevenRatio) {
+  pacer_.SetTargetFps(60);
+  EXPECT_NEAR(Feed(144, 10, 0.5), 600, 2);
+}
+
+TEST_F(FramePacerTest, SlightlySlowerSourceIsNotThrottled) {
+  pacer_.SetTargetFps(60);
+  // A 59.94 Hz source mustn't lose a frame every few seconds.
+  EXPECT_EQ(Feed(59.94, 10), 599);
+}
+
+TEST_F(FramePacerTest, KeepsGridAfterStall) {
+  pacer_.SetTargetFps(30);
+  Feed(60, 1);
+  Advance(Milliseconds(1000));
+
+  accepted_.clear();
+  EXPECT_EQ(Feed(60, 1), 30);
+  EXPECT_EQ(accepted_.size(), 30u);
+}
+
+TEST_F(FramePacerTest, ResetAcceptsNextFrame) {
+  pacer_.SetTargetFps(10);
+  EXPECT_TRUE(pacer_.ShouldAcceptFrame());
+  Advance(Milliseconds(10));
+  EXPECT_FALSE(pacer_.ShouldAcceptFrame());
+
+  pacer_.Reset();
+  EXPECT_TRUE(pacer_.ShouldAcceptFrame());
+}
@@ -0,0 +1,179 @@
+#include "frame_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util/mapped_file.h"
+
+namespace {
+
+template <typename T>
+T Load(const std::vector<uint8_t>& bytes, size_t offset) {
+  T value;
+  std::memcpy(&value, bytes.data() + offset, sizeof(value));
+  return value;
+}
+
+std::vector<uint8_t> ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), {});
+}
+
+// Fills a frame with |value|.
+std::vector<uint8_t> MakePixels(uint32_t width, uint32_t height,
+                                uint8_t value) {
+  return std::vector<uint8_t>(static_cast<size_t>(width) * height * 4, value);
+}
+
+class FrameRecorderTest : public testing::Test {
+ protected:
+  std::string path_ = testing::TempDir() + "frame_recorder_test.bin";
+  std::string dump_path_ = testing::TempDir() + "frame_recorder_dump.bin";
+
+  std::unique_ptr<FrameRecorder> Create(uint32_t slot_count) {
+    FrameRecorder::Config config;
+    config.path = path_;
+    config.max_width = 8;
+    config.max_height = 4;
+    config.slot_count = slot_count;
+    config.max_queued = 100;
+    return FrameRecorder::Create(config);
+  }
+
+  // Waits for the queued frames and returns the dumped ring file.
+  std::vector<uint8_t> Dump(FrameRecorder& recorder) {
+    std::promise<bool> done;
+    recorder.Dump(dump_path_,
+                  [&done](bool success) { done.set_value(success); });
+    EXPECT_TRUE(done.get_future().get());
+    return ReadFile(dump_path_);
+  }
+};
+
+}  // namespace
+
+TEST(MappedFileTest, CreatesZeroedFile) {
+  const auto path = testing::TempDir() + "mapped_file_test.bin";
+  auto file = util::MappedFile::Create(path, 4096);
+  ASSERT_TRUE(file);
+  ASSERT_EQ(file->size(), 4096u);
+  for (size_t i = 0; i < file->size(); i++) {
+    ASSERT_EQ(file->data()[i], 0);
+  }
+
+  file->data()[10] = 42;
+  EXPECT_TRUE(file->Flush());
+  file.reset();
+  const auto bytes = ReadFile(path);
+  ASSERT_EQ(bytes.size(), 4096u);
+  EXPECT_EQ(bytes[10], 42);
+}
+
+TEST_F(FrameRecorderTest, RejectsEmptyRing) {
+  EXPECT_FALSE(Create(0));
+}
+
+TEST_F(FrameRecorderTest, RejectsOversizedConfigs) {
+  FrameRecorder::Config config;
+  config.path = path_;
+  config.max_width = FrameRecorder::kMaxDimension + 1;
+  EXPECT_FALSE(FrameRecorder::IsValid(config));
+  EXPECT_FALSE(FrameRecorder::Create(config));
+
+  config.max_width = FrameRecorder::kMaxDimension;
+  config.max_height = FrameRecorder::kMaxDimension;
+  config.slot_count = 15;
+  EXPECT_TRUE(FrameRecorder::IsValid(config));
+  // 16 slots of 64 MiB plus the headers exceed 1 GiB.
+  config.slot_count = 16;
+  EXPECT_FALSE(FrameRecorder::IsValid(config));
+
+  // Doesn't overflow 32 bits.
+  config.max_width = 640;
+  config.max_height = 360;
+  config.slot_count = UINT32_MAX;
+  EXPECT_FALSE(FrameRecorder::IsValid(config));
+  EXPECT_FALSE(FrameRecorder::Create(config));
+}
+
+TEST_F(FrameRecorderTest, DestroyingFailsPendingDumps) {
+  auto recorder = Create(3);
+  ASSERT_TRUE(recorder);
+  std::promise<bool> done;
+  auto result = done.get_future();
+  recorder->Dump(dump_path_,
+                 [&done](bool success) { done.set_value(success); });
+  recorder.reset();
+
+  // The dump either finished or was cancelled, but never outlives the
+  // recorder.
+  EXPECT_EQ(result.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+}
+
+TEST_F(FrameRecorderTest, WritesHeader) {
+  auto recorder = Create(3);
+  ASSERT_TRUE(recorder);
+  const auto bytes = Dump(*recorder);
+
+  const size_t slot_size = FrameRecorder::kSlotHeaderSize + 8 * 4 * 4;
+  ASSERT_EQ(bytes.size(), FrameRecorder::kHeaderSize + slot_size * 3);
+  EXPECT_EQ(std::memcmp(bytes.data(), "WVFRAMES", 8), 0);
+  EXPECT_EQ(Load<uint32_t>(bytes, 8), FrameRecorder::kVersion);
+  EXPECT_EQ(Load<uint32_t>(bytes, 12), FrameRecorder::kHeaderSize);
+  EXPECT_EQ(Load<uint32_t>(bytes, 16), FrameRecorder::kSlotHeaderSize);
+  EXPECT_EQ(Load<uint32_t>(bytes, 20), 3u);
+  EXPECT_EQ(Load<uint32_t>(bytes, 24), slot_size);
+  EXPECT_EQ(Load<uint32_t>(bytes, 28), 8u);
+  EXPECT_EQ(Load<uint32_t>(bytes, 32), 4u);
+  EXPECT_EQ(Load<uint32_t>(bytes, 36), FrameRecorder::kPixelFormatRgba);
+}
+
+TEST_F(FrameRecorderTest, RingKeepsNewestFrames) {
+  auto recorder = Create(3);
+  ASSERT_TRUE(recorder);
+  for (uint8_t i = 1; i <= 5; i++) {
+    ASSERT_TRUE(recorder->Record(MakePixels(i, 2, i), i, 2, i * 1000));
+  }
+  const auto bytes = Dump(*recorder);
+  EXPECT_EQ(recorder->GetStats().frames_recorded, 5u);
+
+  // Frame N is in slot (N - 1) % 3.
+  const auto slot_size = Load<uint32_t>(bytes, 24);
+  std::map<uint64_t, size_t> slots;
+  for (size_t i = 0; i < 3; i++) {
+    const auto offset = FrameRecorder::kHeaderSize + i * slot_size;
+    slots[Load<uint64_t>(bytes, offset)] = offset;
+  }
+  ASSERT_EQ(slots.size(), 3u);
+  EXPECT_EQ(slots.begin()->first, 3u);
+  EXPECT_EQ(slots[4], FrameRecorder::kHeaderSize);
+
+  for (const auto& [sequence, offset] : slots) {
+    EXPECT_EQ(Load<int64_t>(bytes, offset + 8),
+              static_cast<int64_t>(sequence * 1000));
+    const auto width = Load<uint32_t>(bytes, offset + 16);
+    EXPECT_EQ(width, sequence);
+    EXPECT_EQ(Load<uint32_t>(bytes, offset + 20), 2u);
+    for (size_t i = 0; i < width * 2 * 4; i++) {
+      ASSERT_EQ(bytes[offset + FrameRecorder::kSlotHeaderSize + i], sequence);
+    }
+  }
+}
+
+TEST_F(FrameRecorderTest, DropsOversizedFrames) {
+  auto recorder = Create(3);
+  ASSERT_TRUE(recorder);
+  EXPECT_FALSE(recorder->Record(MakePixels(9, 1, 0), 9, 1, 0));
+  EXPECT_FALSE(recorder->Record(MakePixels(2, 2, 0), 2, 3, 0));
+  EXPECT_EQ(recorder->GetStats().frames_dropped, 2u);
+}
@@ -0,0 +1,278 @@
+#include "frame_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct TestFrame {
+  uint64_t id = 0;
+  int64_t captured_us = 0;
+};
+
+// Produces a frame every |interval_us| of simulated time, like a capture
+// frame pool filled by a page animating at a fixed rate.
+class SyntheticFrameSource : public FrameSource<TestFrame> {
+ public:
+  explicit SyntheticFrameSource(int64_t interval_us)
+      : interval_us_(interval_us) {}
+
+  void AdvanceTo(int64_t now_us) { now_us_ = now_us; }
+
+  std::optional<TestFrame> TryGetNextFrame() override {
+    if (next_us_ > now_us_) {
+      return std::nullopt;
+    }
+    TestFrame frame{++frames_generated_, next_us_};
+    next_us_ += interval_us_;
+    return frame;
+  }
+
+  uint64_t frames_generated() const { return frames_generated_; }
+
+ private:
+  const int64_t interval_us_;
+  int64_t now_us_ = 0;
+  int64_t next_us_ = 0;
+  uint64_t frames_generated_ = 0;
+};
+
+struct SimulationResult {
+  uint64_t frames_generated;
+  uint64_t frames_read;
+  int64_t max_latency_us;
+  FrameRing<TestFrame>::Stats stats;
+};
+
+// Drains |source| into a ring every millisecond and reads the newest frame
+// every |consume_interval_us|, for one simulated second.
+SimulationResult Simulate(size_t depth, int64_t produce_interval_us,
+                          int64_t consume_interval_us) {
+  SyntheticFrameSource source(produce_interval_us);
+  FrameRing<TestFrame> ring(depth);
+  SimulationResult result = {};
+  uint64_t last_id = 0;
+  int64_t next_consume_us = 0;
+
+  for (int64_t now_us = 0; now_us <= 1000000; now_us += 1000) {
+    source.AdvanceTo(now_us);
+    while (auto frame = source.TryGetNextFrame()) {
+      ring.Publish(*frame);
+    }
+
+    if (now_us >= next_consume_us) {
+      next_consume_us += consume_interval_us;
+      if (const auto lock = ring.AcquireLatest()) {
+        EXPECT_GE(lock->id, last_id);
+        if (lock->id != last_id) {
+          result.frames_read++;
+          result.max_latency_us = std::max(result.max_latency_us,
+                                           now_us - lock->captured_us);
+          last_id = lock->id;
+        }
+      }
+    }
+  }
+
+  result.frames_generated = source.frames_generated();
+  result.stats = ring.stats();
+  return result;
+}
+
+// Stands in for a captured texture. Every word holds the frame's id, so a
+// frame overwritten while being read shows up as torn.
+struct FakeTexture {
+  std::array<uint64_t, 64> words = {};
+  std::chrono::steady_clock::time_point published;
+};
+
+}  // namespace
+
+TEST(FrameRingTest, EmptyRingHasNoFrame) {
+  FrameRing<int> ring(3);
+  EXPECT_FALSE(ring.AcquireLatest());
+  EXPECT_EQ(ring.latest_generation(), 0u);
+}
+
+TEST(FrameRingTest, AcquiresNewestFrame) {
+  FrameRing<int> ring(3);
+  ring.Publish(1);
+  ring.Publish(2);
+
+  const auto lock = ring.AcquireLatest();
+  ASSERT_TRUE(lock);
+  EXPECT_EQ(lock.frame(), 2);
+  EXPECT_EQ(lock.generation(), 2u);
+  EXPECT_EQ(ring.latest_generation(), 2u);
+}
+
+TEST(FrameRingTest, ConsumedFrameStaysReadable) {
+  FrameRing<int> ring(3);
+  ring.Publish(1);
+  ring.AcquireLatest().Reset();
+
+  const auto lock = ring.AcquireLatest();
+  ASSERT_TRUE(lock);
+  EXPECT_EQ(lock.frame(), 1);
+}
+
+TEST(FrameRingTest, OverwritingUnreadFrameCountsAsDrop) {
+  FrameRing<int> ring(2);
+  ring.Publish(1);
+  ring.Publish(2);
+  EXPECT_EQ(ring.stats().frames_dropped, 0u);
+
+  ring.Publish(3);
+  EXPECT_EQ(ring.stats().frames_dropped, 1u);
+
+  // Read frames are recycled without counting as a drop.
+  ring.AcquireLatest().Reset();
+  ring.Publish(4);
+  ring.Publish(5);
+  const auto stats = ring.stats();
+  EXPECT_EQ(stats.frames_published, 5u);
+  EXPECT_EQ(stats.frames_dropped, 2u);
+}
+
+TEST(FrameRingTest, PeekDoesNotConsume) {
+  FrameRing<int> ring(2);
+  EXPECT_EQ(ring.PeekLatest(), nullptr);
+  ring.Publish(1);
+  ring.Publish(2);
+
+  const auto frame = ring.PeekLatest();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(*frame, 2);
+
+  // The peeked frame is still unread, so overwriting it counts as a drop.
+  ring.Publish(3);
+  ring.Publish(4);
+  EXPECT_EQ(ring.stats().frames_dropped, 2u);
+
+  // A frame the consumer is reading can be peeked at too.
+  const auto lock = ring.AcquireLatest();
+  ASSERT_TRUE(lock);
+  ASSERT_NE(ring.PeekLatest(), nullptr);
+  EXPECT_EQ(*ring.PeekLatest(), 4);
+}
+
+TEST(FrameRingTest, DropsFrameWhileConsumerOwnsAllSlots) {
+  FrameRing<int> ring(1);
+  ring.Publish(1);
+  {
+    const auto lock = ring.AcquireLatest();
+    ASSERT_TRUE(lock);
+    EXPECT_FALSE(ring.Publish(2));
+    EXPECT_EQ(lock.frame(), 1);
+  }
+
+  EXPECT_TRUE(ring.Publish(3));
+  const auto lock = ring.AcquireLatest();
+  ASSERT_TRUE(lock);
+  EXPECT_EQ(lock.frame(), 3);
+  EXPECT_EQ(ring.stats().frames_dropped, 1u);
+}
+
+TEST(FrameRingTest, ClearKeepsSlotOwnedByConsumer) {
+  FrameRing<int> ring(3);
+  ring.Publish(1);
+  const auto lock = ring.AcquireLatest();
+  ring.Publish(2);
+  ring.Clear();
+
+  EXPECT_EQ(lock.frame(), 1);
+}
+
+TEST(FrameRingTest, SyntheticSourceFasterThanConsumer) {
+  // 120 fps into a 60 Hz consumer.
+  const auto result = Simulate(3, 8333, 16667);
+
+  EXPECT_EQ(result.stats.frames_published, result.frames_generated);
+  // Every other frame is never read.
+  const auto drop_rate = static_cast<double>(result.stats.frames_dropped) /
+                         result.frames_generated;
+  EXPECT_GT(drop_rate, 0.45);
+  EXPECT_LT(drop_rate, 0.55);
+  // Frames are either read, dropped or still waiting in the ring.
+  const auto accounted = result.frames_read + result.stats.frames_dropped;
+  EXPECT_LE(accounted, result.frames_generated);
+  EXPECT_GE(accounted, result.frames_generated - 3);
+  // The consumer always gets the newest frame.
+  EXPECT_LE(result.max_latency_us, 8333);
+}
+
+TEST(FrameRingTest, SyntheticSourceSlowerThanConsumer) {
+  // 30 fps into a 60 Hz consumer.
+  const auto result = Simulate(3, 33333, 16667);
+
+  EXPECT_EQ(result.stats.frames_dropped, 0u);
+  // All but possibly the last frame were read.
+  EXPECT_GE(result.frames_read, result.frames_generated - 1);
+  EXPECT_LE(result.max_latency_us, 16667);
+}
+
+TEST(FrameRingTest, StressConcurrentHandoff) {
+  using Clock = std::chrono::steady_clock;
+  constexpr uint64_t kFrameCount = 200000;
+
+  for (size_t depth : {2, 3, 4}) {
+    FrameRing<FakeTexture> ring(depth);
+    std::thread producer([&ring]() {
+      for (uint64_t id = 1; id <= kFrameCount; id++) {
+        FakeTexture texture;
+        texture.words.fill(id);
+        texture.published = Clock::now();
+        ring.Publish(texture);
+      }
+    });
+
+    std::vector<double> latencies_us;
+    uint64_t last_id = 0;
+    bool torn = false;
+    bool reordered = false;
+    // Failures are only reported once |producer| was joined, since a fatal
+    // assertion here would destroy it while still joinable.
+    while (last_id < kFrameCount) {
+      const auto lock = ring.AcquireLatest();
+      if (!lock) {
+        continue;
+      }
+      const auto id = lock->words.front();
+      torn |= std::any_of(lock->words.begin(), lock->words.end(),
+                          [id](uint64_t word) { return word != id; });
+      reordered |= id < last_id;
+      if (id > last_id) {
+        latencies_us.push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() -
+                                                      lock->published)
+                .count());
+        last_id = id;
+      }
+    }
+    producer.join();
+
+    EXPECT_FALSE(torn);
+    EXPECT_FALSE(reordered);
+    const auto stats = ring.stats();
+    // The consumer owns at most one slot, so publishing never fails.
+    EXPECT_EQ(stats.frames_published, kFrameCount);
+    EXPECT_LE(latencies_us.size() + stats.frames_dropped, kFrameCount);
+    EXPECT_GE(latencies_us.size() + stats.frames_dropped, kFrameCount - depth);
+
+    std::sort(latencies_us.begin(), latencies_us.end());
+    std::cout << "depth " << depth << ": " << latencies_us.size()
+              << " frames read, " << stats.frames_dropped << " dropped, "
+              << stats.contentions << " contentions, handoff p50 "
+              << latencies_us[latencies_us.size() / 2] << " us, p99 "
+              << latencies_us[latencies_us.size() * 99 / 100] << " us"
+              << std::endl;
+  }
+}
@@ -0,0 +1,194 @@
+#include "frame_worker.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "frame_ring.h"
+#include "util/thread_checker.h"
+
+namespace {
+
+// Stands in for a free-threaded capture frame pool, which gets filled and
+// raises FrameArrived on arbitrary thread pool threads.
+class FakeFreeThreadedPool : public FrameSource<int> {
+ public:
+  void Push(int frame) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    frames_.push_back(frame);
+  }
+
+  std::optional<int> TryGetNextFrame() override {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (frames_.empty()) {
+      return std::nullopt;
+    }
+    const auto frame = frames_.front();
+    frames_.pop_front();
+    return frame;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::deque<int> frames_;
+};
+
+}  // namespace
+
+TEST(ThreadCheckerTest, BindsToCreatingThread) {
+  util::ThreadChecker checker;
+  EXPECT_TRUE(checker.IsCurrent());
+
+  bool other_thread_is_current = true;
+  std::thread([&]() { other_thread_is_current = checker.IsCurrent(); })
+      .join();
+  EXPECT_FALSE(other_thread_is_current);
+}
+
+TEST(ThreadCheckerTest, DetachedCheckerBindsToNextCaller) {
+  util::ThreadChecker checker;
+  checker.Detach();
+
+  bool bound = false;
+  std::thread([&]() { bound = checker.IsCurrent() && checker.IsCurrent(); })
+      .join();
+  EXPECT_TRUE(bound);
+  EXPECT_FALSE(checker.IsCurrent());
+}
+
+TEST(FrameWorkerTest, RunsEverythingOnWorkerThread) {
+  util::ThreadChecker worker_thread;
+  worker_thread.Detach();
+  std::atomic<int> violations = 0;
+  std::atomic<int> runs = 0;
+  const auto check = [&]() {
+    if (!worker_thread.IsCurrent()) {
+      violations++;
+    }
+  };
+
+  FrameWorker worker(
+      [&]() {
+        check();
+        runs++;
+      },
+      check, check);
+  worker.Signal();
+  while (runs == 0) {
+    std::this_thread::yield();
+  }
+  EXPECT_FALSE(worker.IsCurrentThread());
+  worker.Stop();
+
+  EXPECT_EQ(violations, 0);
+  EXPECT_FALSE(worker_thread.IsCurrent());
+}
+
+TEST(FrameWorkerTest, CoalescesSignalsWhileRunning) {
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool release = false;
+  std::atomic<int> runs = 0;
+
+  FrameWorker worker([&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    runs++;
+    condition.wait(lock, [&]() { return release; });
+  });
+  worker.Signal();
+  while (runs == 0) {
+    std::this_thread::yield();
+  }
+
+  // Arrive while the first run is blocked.
+  for (int i = 0; i < 10; i++) {
+    worker.Signal();
+  }
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  condition.notify_all();
+  while (runs < 2) {
+    std::this_thread::yield();
+  }
+  worker.Stop();
+
+  EXPECT_EQ(runs, 2);
+}
+
+TEST(FrameWorkerTest, SignalAfterStopIsIgnored) {
+  std::atomic<int> runs = 0;
+  FrameWorker worker([&]() { runs++; });
+  worker.Stop();
+  worker.Signal();
+  worker.Stop();
+  EXPECT_EQ(runs, 0);
+}
+
+TEST(FrameWorkerTest, HandsFramesFromFakePoolToConsumer) {
+  constexpr int kPoolThreads = 4;
+  constexpr int kFramesPerThread = 5000;
+
+  util::ThreadChecker capture_thread;
+  capture_thread.Detach();
+  util::ThreadChecker raster_thread;
+  raster_thread.Detach();
+  std::atomic<int> violations = 0;
+
+  FakeFreeThreadedPool pool;
+  FrameRing<int> ring(3);
+  std::atomic<int> published = 0;
+  FrameWorker worker([&]() {
+    if (!capture_thread.IsCurrent()) {
+      violations++;
+    }
+    // Drain everything, signals arriving meanwhile are coalesced.
+    while (const auto frame = pool.TryGetNextFrame()) {
+      ring.Publish(*frame);
+      published++;
+    }
+  });
+
+  std::atomic<bool> done = false;
+  std::thread consumer([&]() {
+    while (!done) {
+      if (!raster_thread.IsCurrent()) {
+        violations++;
+      }
+      ring.AcquireLatest();
+    }
+  });
+
+  std::vector<std::thread> pool_threads;
+  for (int t = 0; t < kPoolThreads; t++) {
+    pool_threads.emplace_back([&]() {
+      for (int i = 0; i < kFramesPerThread; i++) {
+        pool.Push(i);
+        worker.Signal();
+      }
+    });
+  }
+  for (auto& thread : pool_threads) {
+    thread.join();
+  }
+  while (published < kPoolThreads * kFramesPerThread) {
+    std::this_thread::yield();
+  }
+  done = true;
+  consumer.join();
+  worker.Stop();
+
+  EXPECT_EQ(violations, 0);
+  EXPECT_EQ(ring.stats().frames_published,
+            static_cast<uint64_t>(kPoolThreads * kFramesPerThread));
+  // The platform thread is neither of them.
+  EXPECT_FALSE(capture_thread.IsCurrent());
+  EXPECT_FALSE(raster_thread.IsCurrent());
+}
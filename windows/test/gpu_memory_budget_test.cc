@@ -0,0 +1,143 @@
+#include "gpu_memory_budget.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+using TrimLevel = GpuMemoryBudget::TrimLevel;
+
+// Holds |cache| bytes released at any level and |core| bytes only released
+// at |TrimLevel::kAll|.
+class FakeClient : public GpuMemoryBudget::Client {
+ public:
+  FakeClient(size_t cache, size_t core) : cache(cache), core(core) {}
+
+  size_t cache;
+  size_t core;
+  bool suspended = false;
+  bool hidden = false;
+  uint64_t frames_shown = 0;
+  std::vector<TrimLevel> trims;
+
+  size_t GetGpuMemoryUsage() const override { return cache + core; }
+  bool IsSuspended() const override { return suspended; }
+  bool IsHidden() const override { return hidden; }
+  uint64_t GetFramesShown() const override { return frames_shown; }
+
+  size_t TrimGpuMemory(TrimLevel level) override {
+    trims.push_back(level);
+    size_t freed = std::exchange(cache, 0);
+    if (level == TrimLevel::kAll) {
+      freed += std::exchange(core, 0);
+    }
+    return freed;
+  }
+};
+
+class GpuMemoryBudgetTest : public ::testing::Test {
+ protected:
+  GpuMemoryBudget::TimePoint now_;
+  GpuMemoryBudget budget_{[this]() { return now_; }};
+};
+
+}  // namespace
+
+TEST_F(GpuMemoryBudgetTest, SumsUsageWithoutTrimmingUnderBudget) {
+  FakeClient a(10, 100);
+  FakeClient b(20, 200);
+  budget_.AddClient(1, &a);
+  budget_.AddClient(2, &b);
+
+  EXPECT_EQ(budget_.Update(), 0u);
+  EXPECT_EQ(budget_.total_usage(), 330u);
+  EXPECT_EQ(budget_.GetUsage().at(2), 220u);
+
+  budget_.SetBudget(330);
+  EXPECT_EQ(budget_.Update(), 0u);
+  EXPECT_TRUE(a.trims.empty());
+
+  budget_.RemoveClient(1);
+  EXPECT_EQ(budget_.total_usage(), 220u);
+}
+
+TEST_F(GpuMemoryBudgetTest, TrimsCachesBeforeAnythingElse) {
+  FakeClient visible(10, 100);
+  FakeClient hidden(10, 100);
+  hidden.hidden = true;
+  budget_.AddClient(1, &visible);
+  budget_.AddClient(2, &hidden);
+
+  budget_.SetBudget(210);
+  EXPECT_EQ(budget_.Update(), 10u);
+  // The hidden client is visited first.
+  EXPECT_EQ(hidden.trims, std::vector<TrimLevel>{TrimLevel::kCaches});
+  EXPECT_TRUE(visible.trims.empty());
+}
+
+TEST_F(GpuMemoryBudgetTest, ReleasesSuspendedAndHiddenClients) {
+  FakeClient visible(0, 100);
+  FakeClient hidden(0, 100);
+  FakeClient suspended(0, 100);
+  hidden.hidden = true;
+  suspended.suspended = true;
+  budget_.AddClient(1, &visible);
+  budget_.AddClient(2, &hidden);
+  budget_.AddClient(3, &suspended);
+
+  budget_.SetBudget(150);
+  EXPECT_EQ(budget_.Update(), 200u);
+  EXPECT_EQ(suspended.core, 0u);
+  EXPECT_EQ(hidden.core, 0u);
+  EXPECT_EQ(visible.core, 100u);
+}
+
+TEST_F(GpuMemoryBudgetTest, ReleasesSuspendedBeforeHiddenClients) {
+  FakeClient hidden(0, 100);
+  FakeClient suspended(0, 100);
+  hidden.hidden = true;
+  suspended.suspended = true;
+  budget_.AddClient(1, &hidden);
+  budget_.AddClient(2, &suspended);
+
+  budget_.SetBudget(100);
+  EXPECT_EQ(budget_.Update(), 100u);
+  EXPECT_EQ(suspended.core, 0u);
+  EXPECT_EQ(hidden.core, 100u);
+}
+
+TEST_F(GpuMemoryBudgetTest, KeepsStaticVisibleClient) {
+  // A visible page whose frames are suppressed as static doesn't show new
+  // frames, which mustn't get it released.
+  FakeClient client(10, 100);
+  budget_.AddClient(1, &client);
+  budget_.SetBudget(50);
+
+  for (int i = 0; i < 10; i++) {
+    now_ += std::chrono::seconds(1);
+    budget_.Update();
+  }
+  EXPECT_EQ(client.core, 100u);
+  for (const auto level : client.trims) {
+    EXPECT_EQ(level, TrimLevel::kCaches);
+  }
+  EXPECT_EQ(budget_.total_usage(), 100u);
+}
+
+TEST_F(GpuMemoryBudgetTest, VisitsLeastRecentlyShownFirst) {
+  FakeClient recent(50, 0);
+  FakeClient stale(50, 0);
+  budget_.AddClient(1, &recent);
+  budget_.AddClient(2, &stale);
+
+  now_ += std::chrono::seconds(1);
+  recent.frames_shown++;
+  budget_.SetBudget(50);
+  EXPECT_EQ(budget_.Update(), 50u);
+  EXPECT_EQ(stale.cache, 0u);
+  EXPECT_EQ(recent.cache, 50u);
+  EXPECT_EQ(budget_.stats().trims, 1u);
+  EXPECT_EQ(budget_.stats().bytes_freed, 50u);
+}
@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "input_batch.h"
+
+namespace {
+
+// Decodes a batch of 240 records, as a 240 Hz mouse produces per second.
+void BM_InputBatchDecode(benchmark::State& state) {
+  constexpr size_t kRecordCount = 240;
+  std::vector<uint8_t> batch(kRecordCount * InputBatch::kRecordSize);
+  for (size_t i = 0; i < kRecordCount; i++) {
+    auto record = batch.data() + i * InputBatch::kRecordSize;
+    // Pointer updates with valid coordinates.
+    record[0] = static_cast<uint8_t>(InputBatch::Kind::kPointerUpdate);
+    record[1] = 5;
+    const double x = i * 0.5;
+    const double y = i * 0.25;
+    const uint32_t sequence = static_cast<uint32_t>(i + 1);
+    std::memcpy(record + 8, &x, sizeof(x));
+    std::memcpy(record + 16, &y, sizeof(y));
+    std::memcpy(record + 36, &sequence, sizeof(sequence));
+  }
+
+  std::vector<InputBatch::Record> records;
+  for (auto _ : state) {
+    records.clear();
+    InputBatch::Decode(batch.data(), batch.size(), records);
+    benchmark::DoNotOptimize(records.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          kRecordCount);
+}
+BENCHMARK(BM_InputBatchDecode);
+
+}  // namespace
@@ -0,0 +1,137 @@
+#include "input_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+template <typename T>
+void Put(uint8_t* dst, T value) {
+  std::memcpy(dst, &value, sizeof(value));
+}
+
+// Encodes a record like lib/src/input_batch.dart does.
+void Encode(uint8_t* dst, InputBatch::Kind kind, uint8_t event,
+            int32_t pointer, double x, double y, float size, float pressure,
+            uint32_t buttons, uint32_t sequence, int64_t timestamp_us) {
+  std::memset(dst, 0, InputBatch::kRecordSize);
+  dst[0] = static_cast<uint8_t>(kind);
+  dst[1] = event;
+  Put(dst + 4, pointer);
+  Put(dst + 8, x);
+  Put(dst + 16, y);
+  Put(dst + 24, size);
+  Put(dst + 28, pressure);
+  Put(dst + 32, buttons);
+  Put(dst + 36, sequence);
+  Put(dst + 40, timestamp_us);
+}
+
+class InputBatchTest : public ::testing::Test {
+ protected:
+  std::vector<uint8_t> batch_ =
+      std::vector<uint8_t>(InputBatch::kRecordSize * 4);
+  std::vector<InputBatch::Record> records_;
+
+  void SetUp() override {
+    using Kind = InputBatch::Kind;
+    Encode(Record(0), Kind::kCursorPos, 0, 0, 1.5, 2.5, 0, 0, 0, 1, 100);
+    Encode(Record(1), Kind::kPointerUpdate, 5, 7, 3, 4, 1, 0.5f, 0, 2, 200);
+    Encode(Record(2), Kind::kPointerButton, 2, 0, 0, 0, 0, 0, 2, 3, 300);
+    Encode(Record(3), Kind::kScrollDelta, 0, 0, -10, 20, 0, 0, 0, 4, 400);
+  }
+
+  uint8_t* Record(size_t index) {
+    return batch_.data() + index * InputBatch::kRecordSize;
+  }
+
+  bool Decode(const std::vector<uint8_t>& batch) {
+    return InputBatch::Decode(batch.data(), batch.size(), records_);
+  }
+};
+
+}  // namespace
+
+TEST_F(InputBatchTest, DecodesAllKinds) {
+  ASSERT_TRUE(Decode(batch_));
+  ASSERT_EQ(records_.size(), 4u);
+
+  EXPECT_EQ(records_[0].kind, InputBatch::Kind::kCursorPos);
+  EXPECT_EQ(records_[0].x, 1.5);
+  EXPECT_EQ(records_[0].y, 2.5);
+  EXPECT_EQ(records_[0].timestamp_us, 100);
+
+  EXPECT_EQ(records_[1].kind, InputBatch::Kind::kPointerUpdate);
+  EXPECT_EQ(records_[1].event, 5);
+  EXPECT_EQ(records_[1].pointer, 7);
+  EXPECT_EQ(records_[1].size, 1.0f);
+  EXPECT_EQ(records_[1].pressure, 0.5f);
+
+  EXPECT_EQ(records_[2].kind, InputBatch::Kind::kPointerButton);
+  EXPECT_EQ(records_[2].buttons & InputBatch::ButtonMask(records_[2].event),
+            2u);
+
+  EXPECT_EQ(records_[3].kind, InputBatch::Kind::kScrollDelta);
+  EXPECT_EQ(records_[3].x, -10);
+  EXPECT_EQ(records_[3].y, 20);
+}
+
+TEST_F(InputBatchTest, DecodesSequenceNumbers) {
+  Put(Record(3) + 36, std::numeric_limits<uint32_t>::max());
+  ASSERT_TRUE(Decode(batch_));
+  ASSERT_EQ(records_.size(), 4u);
+  EXPECT_EQ(records_[0].sequence, 1u);
+  EXPECT_EQ(records_[1].sequence, 2u);
+  EXPECT_EQ(records_[2].sequence, 3u);
+  // The full range is passed on as is.
+  EXPECT_EQ(records_[3].sequence, std::numeric_limits<uint32_t>::max());
+}
+
+TEST_F(InputBatchTest, ButtonMaskMatchesFlutter) {
+  EXPECT_EQ(InputBatch::ButtonMask(0), 0u);
+  EXPECT_EQ(InputBatch::ButtonMask(1), 1u);
+  EXPECT_EQ(InputBatch::ButtonMask(3), 4u);
+}
+
+TEST_F(InputBatchTest, RejectsMalformedBatchAsAWhole) {
+  ASSERT_TRUE(Decode(batch_));
+
+  auto batch = batch_;
+  // Unknown button.
+  Record(2)[1] = 4;
+  EXPECT_FALSE(Decode(batch_));
+  batch_ = batch;
+  // Unknown pointer event.
+  Record(1)[1] = 6;
+  EXPECT_FALSE(Decode(batch_));
+  batch_ = batch;
+  // Unknown kind.
+  Record(0)[0] = 9;
+  EXPECT_FALSE(Decode(batch_));
+  batch_ = batch;
+  // Non-finite coordinate.
+  Put(Record(0) + 8, std::numeric_limits<double>::quiet_NaN());
+  EXPECT_FALSE(Decode(batch_));
+  batch_ = batch;
+  // Partial record.
+  batch_.pop_back();
+  EXPECT_FALSE(Decode(batch_));
+
+  EXPECT_EQ(records_.size(), 4u);
+}
+
+TEST_F(InputBatchTest, AcceptsEmptyAndUnalignedBatches) {
+  EXPECT_TRUE(InputBatch::Decode(nullptr, 0, records_));
+  EXPECT_TRUE(records_.empty());
+
+  std::vector<uint8_t> unaligned(batch_.size() + 1);
+  std::memcpy(unaligned.data() + 1, batch_.data(), batch_.size());
+  ASSERT_TRUE(
+      InputBatch::Decode(unaligned.data() + 1, batch_.size(), records_));
+  ASSERT_EQ(records_.size(), 4u);
+  EXPECT_EQ(records_[3].y, 20);
+}
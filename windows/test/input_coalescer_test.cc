@@ -0,0 +1,184 @@
+#include "input_coalescer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+struct TestEvent {
+  std::string name;
+  int value = 0;
+};
+
+typedef std::vector<std::string> Names;
+
+constexpr int64_t kScrollKey = -1;
+
+void AddValues(TestEvent& queued, const TestEvent& event) {
+  queued.value += event.value;
+}
+
+class InputCoalescerTest : public ::testing::Test {
+ protected:
+  // Flushes and returns the dispatched events as "name=value".
+  Names Flush() {
+    Names dispatched;
+    coalescer_.Flush([&dispatched](const TestEvent& event) {
+      dispatched.push_back(event.name + "=" + std::to_string(event.value));
+    });
+    return dispatched;
+  }
+
+  InputCoalescer<TestEvent>::TimePoint now_;
+  InputCoalescer<TestEvent> coalescer_{milliseconds(16),
+                                       [this]() { return now_; }};
+};
+
+}  // namespace
+
+TEST_F(InputCoalescerTest, DispatchesInOrder) {
+  coalescer_.Push({"down", 1}, std::nullopt);
+  coalescer_.Push({"key", 2}, std::nullopt);
+  coalescer_.Push({"up", 3}, std::nullopt);
+
+  EXPECT_EQ(Flush(), (Names{"down=1", "key=2", "up=3"}));
+  EXPECT_TRUE(coalescer_.empty());
+  EXPECT_EQ(coalescer_.stats().events_dispatched, 3u);
+}
+
+TEST_F(InputCoalescerTest, CollapsesMovesOfSamePointer) {
+  coalescer_.Push({"move0", 1}, 0);
+  coalescer_.Push({"move1", 1}, 1);
+  coalescer_.Push({"move0", 2}, 0);
+  coalescer_.Push({"move0", 3}, 0);
+
+  // The replaced move keeps its position.
+  EXPECT_EQ(Flush(), (Names{"move0=3", "move1=1"}));
+  const auto& stats = coalescer_.stats();
+  EXPECT_EQ(stats.events_queued, 4u);
+  EXPECT_EQ(stats.events_coalesced, 2u);
+  EXPECT_EQ(stats.events_dispatched, 2u);
+}
+
+TEST_F(InputCoalescerTest, NeverCollapsesAcrossBarrier) {
+  coalescer_.Push({"move", 1}, 0);
+  coalescer_.Push({"down", 0}, std::nullopt);
+  coalescer_.Push({"move", 2}, 0);
+  coalescer_.Push({"move", 3}, 0);
+
+  EXPECT_EQ(Flush(), (Names{"move=1", "down=0", "move=3"}));
+}
+
+TEST_F(InputCoalescerTest, MergesConsecutiveMergeableEvents) {
+  coalescer_.PushMergeable({"scroll", 1}, kScrollKey, AddValues);
+  coalescer_.PushMergeable({"scroll", 2}, kScrollKey, AddValues);
+  coalescer_.PushMergeable({"scroll", 4}, kScrollKey, AddValues);
+
+  EXPECT_EQ(Flush(), (Names{"scroll=7"}));
+  EXPECT_EQ(coalescer_.stats().events_coalesced, 2u);
+}
+
+TEST_F(InputCoalescerTest, NeverMergesAcrossOtherEvents) {
+  coalescer_.PushMergeable({"scroll", 1}, kScrollKey, AddValues);
+  coalescer_.Push({"move", 1}, 0);
+  coalescer_.PushMergeable({"scroll", 2}, kScrollKey, AddValues);
+  coalescer_.Push({"down", 0}, std::nullopt);
+  coalescer_.PushMergeable({"scroll", 4}, kScrollKey, AddValues);
+
+  // Each scroll applies at the position the pointer was at.
+  EXPECT_EQ(Flush(),
+            (Names{"scroll=1", "move=1", "scroll=2", "down=0", "scroll=4"}));
+}
+
+TEST_F(InputCoalescerTest, MergeableEventIsBarrierForMoves) {
+  coalescer_.Push({"move", 1}, 0);
+  coalescer_.PushMergeable({"scroll", 1}, kScrollKey, AddValues);
+  coalescer_.Push({"move", 2}, 0);
+  coalescer_.Push({"move", 3}, 0);
+
+  EXPECT_EQ(Flush(), (Names{"move=1", "scroll=1", "move=3"}));
+}
+
+TEST_F(InputCoalescerTest, DoesNotMergeEventsPushedWithSameKey) {
+  coalescer_.Push({"move", 1}, kScrollKey);
+  coalescer_.PushMergeable({"scroll", 2}, kScrollKey, AddValues);
+
+  EXPECT_EQ(Flush(), (Names{"move=1", "scroll=2"}));
+}
+
+TEST_F(InputCoalescerTest, DoesNotMergeIntoFlushedEvent) {
+  coalescer_.PushMergeable({"scroll", 1}, kScrollKey, AddValues);
+  EXPECT_EQ(Flush(), (Names{"scroll=1"}));
+
+  coalescer_.PushMergeable({"scroll", 2}, kScrollKey, AddValues);
+  EXPECT_EQ(Flush(), (Names{"scroll=2"}));
+}
+
+TEST_F(InputCoalescerTest, FlushesOnceOldestEventIsDue) {
+  EXPECT_FALSE(coalescer_.deadline().has_value());
+  const auto start = now_;
+  coalescer_.Push({"move", 1}, 0);
+  now_ += milliseconds(10);
+  coalescer_.Push({"move", 2}, 0);
+
+  // Collapsing doesn't push the deadline out.
+  ASSERT_TRUE(coalescer_.deadline().has_value());
+  EXPECT_EQ(*coalescer_.deadline(), start + milliseconds(16));
+
+  int dispatched = 0;
+  const auto count = [&dispatched](const TestEvent&) { dispatched++; };
+  now_ += milliseconds(5);
+  EXPECT_FALSE(coalescer_.FlushIfDue(count));
+  now_ += milliseconds(1);
+  EXPECT_TRUE(coalescer_.FlushIfDue(count));
+  EXPECT_EQ(dispatched, 1);
+  EXPECT_FALSE(coalescer_.deadline().has_value());
+  EXPECT_FALSE(coalescer_.FlushIfDue(count));
+}
+
+TEST_F(InputCoalescerTest, QueuesEventsPushedWhileFlushing) {
+  coalescer_.Push({"down", 1}, std::nullopt);
+  Names dispatched;
+  coalescer_.Flush([this, &dispatched](const TestEvent& event) {
+    dispatched.push_back(event.name);
+    coalescer_.Push({"up", 2}, std::nullopt);
+  });
+
+  EXPECT_EQ(dispatched, (Names{"down"}));
+  EXPECT_EQ(Flush(), (Names{"up=2"}));
+}
+
+TEST_F(InputCoalescerTest, SyntheticDragAndWheelTrace) {
+  // A drag at 1000 Hz with a wheel notch every 4 ms, flushed every 16 ms.
+  size_t dispatched = 0;
+  int scrolled = 0;
+  for (int ms = 0; ms < 160; ms++) {
+    now_ += milliseconds(1);
+    coalescer_.Push({"move", ms}, 0);
+    if (ms % 4 == 0) {
+      coalescer_.PushMergeable({"scroll", 1}, kScrollKey, AddValues);
+    }
+    if (ms % 16 == 15) {
+      coalescer_.Flush([&](const TestEvent& event) {
+        dispatched++;
+        if (event.name == "scroll") {
+          scrolled += event.value;
+        }
+      });
+    }
+  }
+
+  // No wheel delta is lost. Each window dispatches the 4 notches with the
+  // moves in between collapsed, plus the moves after the last notch.
+  EXPECT_EQ(scrolled, 40);
+  EXPECT_EQ(dispatched, 90u);
+  const auto& stats = coalescer_.stats();
+  EXPECT_EQ(stats.events_queued, 200u);
+  EXPECT_EQ(stats.events_dispatched + stats.events_coalesced,
+            stats.events_queued);
+}
@@ -0,0 +1,197 @@
+#include "input_latency_tracker.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using TimePoint = InputLatencyTracker::TimePoint;
+
+class InputLatencyTrackerTest : public ::testing::Test {
+ protected:
+  TimePoint now_ = TimePoint() + seconds(100);
+  InputLatencyTracker tracker_{[this]() { return now_; }};
+};
+
+}  // namespace
+
+TEST_F(InputLatencyTrackerTest, SplitsLatencyIntoStages) {
+  tracker_.OnInputReceived(1, now_ - milliseconds(3));
+  now_ += milliseconds(2);
+  tracker_.OnInputInjected();
+  now_ += milliseconds(10);
+  tracker_.OnFrameArrived(now_);
+
+  const auto snapshot = tracker_.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_received, 1u);
+  EXPECT_EQ(snapshot.inputs_matched, 1u);
+  EXPECT_EQ(snapshot.last_matched_sequence, 1u);
+  EXPECT_EQ(snapshot.delivery_latency.sum, milliseconds(3));
+  EXPECT_EQ(snapshot.queue_latency.sum, milliseconds(2));
+  EXPECT_EQ(snapshot.render_latency.sum, milliseconds(10));
+  EXPECT_EQ(snapshot.total_latency.sum, milliseconds(15));
+}
+
+TEST_F(InputLatencyTrackerTest, OnlyMatchesFramesAfterInjection) {
+  tracker_.OnInputReceived(1, std::nullopt);
+  now_ += milliseconds(2);
+  // Not injected yet.
+  tracker_.OnFrameArrived(now_);
+  EXPECT_EQ(tracker_.GetSnapshot().inputs_matched, 0u);
+
+  tracker_.OnInputInjected();
+  // Captured before the injection, but reported late.
+  tracker_.OnFrameArrived(now_ - milliseconds(1));
+  EXPECT_EQ(tracker_.GetSnapshot().inputs_matched, 0u);
+
+  now_ += milliseconds(5);
+  tracker_.OnFrameArrived(now_);
+  EXPECT_EQ(tracker_.GetSnapshot().inputs_matched, 1u);
+
+  // Later frames have nothing left to match.
+  now_ += milliseconds(16);
+  tracker_.OnFrameArrived(now_);
+  const auto snapshot = tracker_.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_matched, 1u);
+  EXPECT_EQ(snapshot.render_latency.count, 1u);
+}
+
+TEST_F(InputLatencyTrackerTest, IgnoresImplausibleEventTimes) {
+  tracker_.OnInputReceived(1, now_ + seconds(1));
+  tracker_.OnInputReceived(2, now_ - seconds(5));
+  tracker_.OnInputReceived(3, now_ - milliseconds(1));
+  tracker_.OnInputInjected();
+  now_ += milliseconds(5);
+  tracker_.OnFrameArrived(now_);
+
+  const auto snapshot = tracker_.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_matched, 3u);
+  EXPECT_EQ(snapshot.delivery_latency.count, 1u);
+  EXPECT_EQ(snapshot.total_latency.count, 3u);
+  EXPECT_EQ(snapshot.total_latency.max, milliseconds(6));
+}
+
+TEST_F(InputLatencyTrackerTest, ReportsSendersSequenceNumbers) {
+  tracker_.OnInputReceived(41, std::nullopt);
+  tracker_.OnInputReceived(42, std::nullopt);
+  // Unnumbered input doesn't reset the number.
+  tracker_.OnInputReceived(0, std::nullopt);
+  tracker_.OnInputInjected();
+  now_ += milliseconds(5);
+  tracker_.OnFrameArrived(now_);
+
+  const auto snapshot = tracker_.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_received, 3u);
+  EXPECT_EQ(snapshot.inputs_matched, 3u);
+  EXPECT_EQ(snapshot.last_matched_sequence, 42u);
+}
+
+TEST_F(InputLatencyTrackerTest, CountsInputWithoutFrameAsUnmatched) {
+  tracker_.OnInputReceived(1, std::nullopt);
+  tracker_.OnInputInjected();
+  now_ += milliseconds(600);
+  tracker_.OnFrameArrived(now_);
+
+  const auto snapshot = tracker_.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_matched, 0u);
+  EXPECT_EQ(snapshot.inputs_unmatched, 1u);
+  EXPECT_EQ(snapshot.last_matched_sequence, 0u);
+}
+
+TEST_F(InputLatencyTrackerTest, DropsInputNotInjected) {
+  tracker_.OnInputReceived(1, std::nullopt);
+  tracker_.OnInputInjected();
+  tracker_.OnInputReceived(2, std::nullopt);
+  tracker_.OnInputReceived(3, std::nullopt);
+  tracker_.OnInputDropped();
+  auto snapshot = tracker_.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_unmatched, 2u);
+
+  // Dropped input isn't attributed to later injections and frames.
+  now_ += milliseconds(5);
+  tracker_.OnInputInjected();
+  tracker_.OnFrameArrived(now_);
+  snapshot = tracker_.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_matched, 1u);
+  EXPECT_EQ(snapshot.last_matched_sequence, 1u);
+  EXPECT_EQ(snapshot.queue_latency.sum, microseconds(0));
+
+  // Nothing is left pending.
+  tracker_.OnInputDropped();
+  EXPECT_EQ(tracker_.GetSnapshot().inputs_unmatched, 2u);
+}
+
+TEST_F(InputLatencyTrackerTest, BoundsPendingInput) {
+  InputLatencyTracker::Config config;
+  config.max_pending = 4;
+  InputLatencyTracker tracker(config, [this]() { return now_; });
+  for (uint64_t sequence = 1; sequence <= 10; sequence++) {
+    tracker.OnInputReceived(sequence, std::nullopt);
+  }
+  tracker.OnInputInjected();
+  now_ += milliseconds(1);
+  tracker.OnFrameArrived(now_);
+
+  const auto snapshot = tracker.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_received, 10u);
+  EXPECT_EQ(snapshot.inputs_unmatched, 6u);
+  EXPECT_EQ(snapshot.inputs_matched, 4u);
+  EXPECT_EQ(snapshot.last_matched_sequence, 10u);
+}
+
+TEST_F(InputLatencyTrackerTest, SyntheticInputStream) {
+  // A 240 Hz mouse delivered in 1 ms, injected once per 16 ms frame, with
+  // the page taking 8 ms to render.
+  auto next_frame = now_ + milliseconds(16);
+  for (uint64_t sequence = 1; sequence <= 2400; sequence++) {
+    now_ += microseconds(4167);
+    tracker_.OnInputReceived(sequence, now_ - milliseconds(1));
+    if (now_ >= next_frame) {
+      tracker_.OnInputInjected();
+      tracker_.OnFrameArrived(now_ + milliseconds(8));
+      next_frame += milliseconds(16);
+    }
+  }
+
+  const auto snapshot = tracker_.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_unmatched, 0u);
+  // All but the input after the last frame.
+  EXPECT_GE(snapshot.inputs_matched, 2396u);
+  EXPECT_EQ(snapshot.delivery_latency.mean(), milliseconds(1));
+  EXPECT_EQ(snapshot.render_latency.mean(), milliseconds(8));
+  // Input waits up to a frame for the next flush, the one received right
+  // before it not at all.
+  EXPECT_GT(snapshot.queue_latency.mean(), milliseconds(4));
+  EXPECT_LT(snapshot.queue_latency.mean(), milliseconds(8));
+}
+
+TEST(InputLatencyTrackerStressTest, AccountsForAllInputAcrossThreads) {
+  InputLatencyTracker tracker;
+  std::atomic<bool> stop = false;
+  std::thread capture([&tracker, &stop]() {
+    while (!stop) {
+      tracker.OnFrameArrived(std::chrono::steady_clock::now());
+    }
+  });
+
+  constexpr uint64_t kInputCount = 100000;
+  for (uint64_t sequence = 1; sequence <= kInputCount; sequence++) {
+    tracker.OnInputReceived(sequence, std::chrono::steady_clock::now());
+    if (sequence % 10 == 0) {
+      tracker.OnInputInjected();
+    }
+  }
+  stop = true;
+  capture.join();
+  tracker.OnFrameArrived(std::chrono::steady_clock::now());
+
+  const auto snapshot = tracker.GetSnapshot();
+  EXPECT_EQ(snapshot.inputs_matched + snapshot.inputs_unmatched, kInputCount);
+}
@@ -0,0 +1,132 @@
+#include "keyed_object_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+// A reference counted object standing in for a COM object.
+struct FakeObject {
+  static int live;
+
+  int refs = 1;
+  int flags = 0;
+
+  FakeObject() { live++; }
+  ~FakeObject() { live--; }
+
+  void AddRef() { refs++; }
+  void Release() {
+    if (--refs == 0) {
+      delete this;
+    }
+  }
+};
+
+int FakeObject::live = 0;
+
+// Holds a reference like wil::com_ptr.
+class FakePtr {
+ public:
+  FakePtr() = default;
+  explicit FakePtr(FakeObject* object) : object_(object) {}
+  FakePtr(const FakePtr& other) : object_(other.object_) {
+    if (object_) {
+      object_->AddRef();
+    }
+  }
+  FakePtr(FakePtr&& other) noexcept
+      : object_(std::exchange(other.object_, nullptr)) {}
+  FakePtr& operator=(FakePtr other) {
+    std::swap(object_, other.object_);
+    return *this;
+  }
+  ~FakePtr() {
+    if (object_) {
+      object_->Release();
+    }
+  }
+
+  FakeObject* get() const { return object_; }
+  FakeObject* operator->() const { return object_; }
+  explicit operator bool() const { return object_ != nullptr; }
+
+ private:
+  FakeObject* object_ = nullptr;
+};
+
+typedef KeyedObjectPool<int32_t, FakePtr> Pool;
+
+class KeyedObjectPoolTest : public ::testing::Test {
+ protected:
+  bool fail_ = false;
+  int resets_ = 0;
+  Pool pool_{[this]() { return fail_ ? FakePtr() : FakePtr(new FakeObject); },
+             [this](const FakePtr& object) {
+               resets_++;
+               object->flags = 0;
+             },
+             Pool::Config{2}};
+
+  void TearDown() override {
+    pool_.Clear();
+    EXPECT_EQ(FakeObject::live, 0);
+  }
+};
+
+}  // namespace
+
+TEST_F(KeyedObjectPoolTest, SameKeyGetsSameObject) {
+  const auto a = pool_.Acquire(1);
+  const auto b = pool_.Acquire(1);
+  const auto c = pool_.Acquire(2);
+  EXPECT_EQ(a.get(), b.get());
+  EXPECT_NE(a.get(), c.get());
+
+  const auto stats = pool_.stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.active, 2u);
+  EXPECT_EQ(stats.idle, 0u);
+}
+
+TEST_F(KeyedObjectPoolTest, ReusesReleasedObjectAfterReset) {
+  const auto object = pool_.Acquire(1).get();
+  object->flags = 5;
+  pool_.Release(1);
+  // Releasing twice or unknown keys does nothing.
+  pool_.Release(1);
+  pool_.Release(99);
+
+  const auto reused = pool_.Acquire(3);
+  EXPECT_EQ(reused.get(), object);
+  EXPECT_EQ(reused->flags, 0);
+  EXPECT_EQ(resets_, 1);
+}
+
+TEST_F(KeyedObjectPoolTest, KeepsAtMostMaxIdle) {
+  for (int32_t key = 0; key < 4; key++) {
+    pool_.Acquire(key);
+  }
+  for (int32_t key = 0; key < 4; key++) {
+    pool_.Release(key);
+  }
+
+  const auto stats = pool_.stats();
+  EXPECT_EQ(stats.idle, 2u);
+  EXPECT_EQ(stats.active, 0u);
+  EXPECT_EQ(FakeObject::live, 2);
+}
+
+TEST_F(KeyedObjectPoolTest, ReportsFactoryFailure) {
+  pool_.Acquire(1);
+  pool_.Release(1);
+  fail_ = true;
+
+  // The idle object is still handed out.
+  EXPECT_TRUE(pool_.Acquire(2));
+  EXPECT_FALSE(pool_.Acquire(3));
+  EXPECT_EQ(pool_.stats().failures, 1u);
+}
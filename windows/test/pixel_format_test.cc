@@ -0,0 +1,135 @@
+#include "util/pixel_format.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using util::PixelFormat;
+
+// Encodes linear |value| like the FP16 conversion is expected to.
+int ReferenceSrgb(double value) {
+  const double encoded = value <= 0.0031308
+                             ? value * 12.92
+                             : 1.055 * std::pow(value, 1 / 2.4) - 0.055;
+  return static_cast<int>(std::lround(encoded * 255));
+}
+
+}  // namespace
+
+TEST(PixelFormatTest, Sizes) {
+  EXPECT_EQ(util::BytesPerPixel(PixelFormat::kBgra8), 4u);
+  EXPECT_EQ(util::BytesPerPixel(PixelFormat::kRgba8), 4u);
+  EXPECT_EQ(util::BytesPerPixel(PixelFormat::kRgba16Float), 8u);
+  EXPECT_EQ(util::RowBytes(PixelFormat::kRgba16Float, 33), 264u);
+  EXPECT_EQ(util::ImageBytes(PixelFormat::kBgra8, 7, 3), 84u);
+}
+
+TEST(PixelFormatTest, Rgba8IsNeverCaptured) {
+  EXPECT_EQ(util::NegotiateCaptureFormat(PixelFormat::kRgba8),
+            PixelFormat::kBgra8);
+  EXPECT_EQ(util::NegotiateCaptureFormat(PixelFormat::kBgra8),
+            PixelFormat::kBgra8);
+  EXPECT_EQ(util::NegotiateCaptureFormat(PixelFormat::kRgba16Float),
+            PixelFormat::kRgba16Float);
+}
+
+TEST(PixelFormatTest, HalfToFloat) {
+  EXPECT_EQ(util::HalfToFloat(0x3c00), 1.0f);
+  EXPECT_EQ(util::HalfToFloat(0xc000), -2.0f);
+  EXPECT_EQ(util::HalfToFloat(0x7bff), 65504.0f);
+  // Subnormals.
+  EXPECT_EQ(util::HalfToFloat(0x0001), std::ldexp(1.0f, -24));
+  EXPECT_EQ(util::HalfToFloat(0x03ff), std::ldexp(1023.0f, -24));
+  EXPECT_TRUE(std::signbit(util::HalfToFloat(0x8000)));
+  EXPECT_TRUE(std::isinf(util::HalfToFloat(0x7c00)));
+  EXPECT_TRUE(std::isnan(util::HalfToFloat(0x7e00)));
+}
+
+TEST(PixelFormatTest, Converts8BitFormats) {
+  const size_t width = 37;
+  const size_t height = 5;
+  const size_t src_stride = width * 4 + 12;
+  const size_t dst_stride = width * 4 + 4;
+  std::vector<uint8_t> src(src_stride * height);
+  for (size_t i = 0; i < src.size(); i++) {
+    src[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  std::vector<uint8_t> dst(dst_stride * height);
+
+  ASSERT_TRUE(util::ConvertPixels(PixelFormat::kBgra8, src.data(), src_stride,
+                                  PixelFormat::kRgba8, dst.data(), dst_stride,
+                                  width, height));
+  for (size_t y = 0; y < height; y++) {
+    for (size_t x = 0; x < width; x++) {
+      const auto s = &src[y * src_stride + x * 4];
+      const auto d = &dst[y * dst_stride + x * 4];
+      ASSERT_EQ(d[0], s[2]);
+      ASSERT_EQ(d[1], s[1]);
+      ASSERT_EQ(d[2], s[0]);
+      ASSERT_EQ(d[3], s[3]);
+    }
+  }
+
+  ASSERT_TRUE(util::ConvertPixels(PixelFormat::kRgba8, src.data(), src_stride,
+                                  PixelFormat::kRgba8, dst.data(), dst_stride,
+                                  width, height));
+  for (size_t y = 0; y < height; y++) {
+    EXPECT_EQ(std::memcmp(&src[y * src_stride], &dst[y * dst_stride],
+                          width * 4),
+              0);
+  }
+
+  // Only 8-bit destinations are supported.
+  EXPECT_FALSE(util::ConvertPixels(PixelFormat::kBgra8, src.data(),
+                                   src_stride, PixelFormat::kRgba16Float,
+                                   dst.data(), dst_stride, width, height));
+}
+
+TEST(PixelFormatTest, ClampsAndEncodesFp16) {
+  // 1, 0, 0.5, 0.5 and -1, 2, NaN, 4.
+  const uint16_t pixels[] = {0x3c00, 0x0000, 0x3800, 0x3800,
+                             0xbc00, 0x4000, 0x7e00, 0x4400};
+  uint8_t rgba[8];
+  ASSERT_TRUE(util::ConvertPixels(
+      PixelFormat::kRgba16Float, reinterpret_cast<const uint8_t*>(pixels), 16,
+      PixelFormat::kRgba8, rgba, 8, 2, 1));
+  // Color is sRGB encoded, alpha stays linear.
+  EXPECT_EQ(rgba[0], 255);
+  EXPECT_EQ(rgba[1], 0);
+  EXPECT_EQ(rgba[2], 188);
+  EXPECT_EQ(rgba[3], 128);
+  EXPECT_EQ(rgba[4], 0);
+  EXPECT_EQ(rgba[5], 255);
+  EXPECT_EQ(rgba[6], 0);
+  EXPECT_EQ(rgba[7], 255);
+
+  uint8_t bgra[8];
+  ASSERT_TRUE(util::ConvertPixels(
+      PixelFormat::kRgba16Float, reinterpret_cast<const uint8_t*>(pixels), 16,
+      PixelFormat::kBgra8, bgra, 8, 2, 1));
+  for (size_t i = 0; i < 2; i++) {
+    EXPECT_EQ(bgra[i * 4], rgba[i * 4 + 2]);
+    EXPECT_EQ(bgra[i * 4 + 1], rgba[i * 4 + 1]);
+    EXPECT_EQ(bgra[i * 4 + 2], rgba[i * 4]);
+    EXPECT_EQ(bgra[i * 4 + 3], rgba[i * 4 + 3]);
+  }
+}
+
+TEST(PixelFormatTest, Fp16MatchesReferenceEncoding) {
+  for (uint16_t half = 0; half <= 0x3c00; half++) {
+    const uint16_t pixel[] = {half, half, half, half};
+    uint8_t rgba[4];
+    ASSERT_TRUE(util::ConvertPixels(
+        PixelFormat::kRgba16Float, reinterpret_cast<const uint8_t*>(pixel), 8,
+        PixelFormat::kRgba8, rgba, 4, 1, 1));
+    const double value = util::HalfToFloat(half);
+    ASSERT_EQ(rgba[0], ReferenceSrgb(value)) << "half " << half;
+    ASSERT_EQ(rgba[3], std::lround(value * 255)) << "half " << half;
+  }
+}
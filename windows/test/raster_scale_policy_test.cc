@@ -0,0 +1,106 @@
+#include "raster_scale_policy.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace {
+
+using Counts = RasterScalePolicy::FrameCounts;
+using std::chrono::milliseconds;
+
+class RasterScalePolicyTest : public ::testing::Test {
+ protected:
+  RasterScalePolicy::TimePoint now_;
+  RasterScalePolicy policy_{RasterScalePolicy::Config{},
+                            [this]() { return now_; }};
+
+  void SetUp() override { policy_.SetEnabled(true); }
+};
+
+}  // namespace
+
+TEST_F(RasterScalePolicyTest, DisabledKeepsFullScale) {
+  ASSERT_FALSE(policy_.SetEnabled(false));
+  EXPECT_FALSE(policy_.OnResize());
+  EXPECT_EQ(policy_.scale(), 1.0);
+  EXPECT_FALSE(policy_.Update(Counts{1000, 0}));
+}
+
+TEST_F(RasterScalePolicyTest, ResizeReducesUntilHoldPassed) {
+  EXPECT_TRUE(policy_.OnResize());
+  EXPECT_EQ(policy_.scale(), 0.5);
+  EXPECT_EQ(policy_.deadline(), now_ + milliseconds(500));
+
+  // Every resize extends the hold.
+  now_ += milliseconds(300);
+  EXPECT_FALSE(policy_.OnResize());
+  EXPECT_EQ(policy_.deadline(), now_ + milliseconds(500));
+
+  now_ += milliseconds(499);
+  EXPECT_FALSE(policy_.Update(Counts{0, 0}));
+  EXPECT_TRUE(policy_.reduced());
+  now_ += milliseconds(1);
+  EXPECT_TRUE(policy_.Update(Counts{0, 0}));
+  EXPECT_FALSE(policy_.reduced());
+  EXPECT_FALSE(policy_.deadline());
+}
+
+TEST_F(RasterScalePolicyTest, PressureReducesUntilHoldPassed) {
+  Counts counts{0, 0};
+  EXPECT_FALSE(policy_.Update(counts));
+
+  // 60 FPS delivered, 40 consumed.
+  now_ += milliseconds(500);
+  counts = {30, 20};
+  EXPECT_TRUE(policy_.Update(counts));
+  EXPECT_TRUE(policy_.reduced());
+  EXPECT_EQ(policy_.deadline(), now_ + milliseconds(3000));
+
+  // Keeping up at the reduced scale doesn't extend the hold.
+  now_ += milliseconds(100);
+  EXPECT_FALSE(policy_.Update(counts));
+  now_ += milliseconds(500);
+  counts = {60, 50};
+  EXPECT_FALSE(policy_.Update(counts));
+
+  now_ += milliseconds(2400);
+  EXPECT_TRUE(policy_.Update(counts));
+  EXPECT_FALSE(policy_.reduced());
+}
+
+TEST_F(RasterScalePolicyTest, NoPressureWhenKeepingUpOrIdle) {
+  Counts counts{0, 0};
+  policy_.Update(counts);
+
+  // Only 4 FPS consumed, the page isn't animating.
+  now_ += milliseconds(500);
+  counts = {38, 2};
+  EXPECT_FALSE(policy_.Update(counts));
+
+  // All frames consumed.
+  now_ += milliseconds(500);
+  counts = {68, 32};
+  EXPECT_FALSE(policy_.Update(counts));
+
+  // Counters that went backwards start a new window.
+  now_ += milliseconds(500);
+  counts = {5, 5};
+  EXPECT_FALSE(policy_.Update(counts));
+  EXPECT_FALSE(policy_.reduced());
+}
+
+TEST_F(RasterScalePolicyTest, DisablingRestoresFullScale) {
+  policy_.OnResize();
+  EXPECT_TRUE(policy_.SetEnabled(false));
+  EXPECT_EQ(policy_.scale(), 1.0);
+}
+
+TEST_F(RasterScalePolicyTest, ClampsReducedScale) {
+  RasterScalePolicy::Config config;
+  config.reduced_scale = 0;
+  RasterScalePolicy policy(config, [this]() { return now_; });
+  policy.SetEnabled(true);
+  policy.OnResize();
+  EXPECT_EQ(policy.scale(), 0.1);
+}
@@ -0,0 +1,248 @@
+#include "readback_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace {
+
+// A GPU on which copies finish |latency| ticks after being enqueued.
+struct FakeGpu {
+  int time = 0;
+  int latency = 2;
+  int live_staging = 0;
+  int created = 0;
+  bool fail_map = false;
+};
+
+struct FakeImage {
+  size_t width;
+  size_t height;
+  size_t stride;
+  std::vector<uint8_t> bgra;
+};
+
+struct FakeStaging {
+  // Counts the staging buffers alive.
+  std::shared_ptr<int> token;
+  std::vector<uint8_t> data;
+  size_t stride = 0;
+  int ready_at = 0;
+  bool mapped = false;
+};
+
+class FakeDevice {
+ public:
+  typedef const FakeImage* Source;
+  typedef FakeStaging Staging;
+
+  explicit FakeDevice(FakeGpu* gpu) : gpu_(gpu) {}
+
+  std::optional<Staging> CreateStaging(size_t width, size_t height) {
+    auto gpu = gpu_;
+    gpu->created++;
+    gpu->live_staging++;
+    Staging staging;
+    staging.token =
+        std::shared_ptr<int>(new int(0), [gpu](int* token) {
+          gpu->live_staging--;
+          delete token;
+        });
+    // Padded rows, like a mapped texture's row pitch.
+    staging.stride = width * 4 + 12;
+    staging.data.resize(staging.stride * height);
+    return staging;
+  }
+
+  bool Copy(const Source& source, Staging& staging, size_t width,
+            size_t height) {
+    if (width > source->width || height > source->height) {
+      return false;
+    }
+    for (size_t y = 0; y < height; y++) {
+      std::memcpy(&staging.data[y * staging.stride],
+                  &source->bgra[y * source->stride], width * 4);
+    }
+    staging.ready_at = gpu_->time + gpu_->latency;
+    return true;
+  }
+
+  ReadbackMapStatus TryMap(Staging& staging, ReadbackMapping* mapping) {
+    if (gpu_->fail_map) {
+      return ReadbackMapStatus::kFailed;
+    }
+    if (gpu_->time < staging.ready_at) {
+      return ReadbackMapStatus::kPending;
+    }
+    EXPECT_FALSE(staging.mapped);
+    staging.mapped = true;
+    *mapping = {staging.data.data(), staging.stride};
+    return ReadbackMapStatus::kReady;
+  }
+
+  void Unmap(Staging& staging) {
+    EXPECT_TRUE(staging.mapped);
+    staging.mapped = false;
+  }
+
+ private:
+  FakeGpu* gpu_;
+};
+
+typedef ReadbackScheduler<FakeDevice> Scheduler;
+
+FakeImage MakeImage(size_t width, size_t height, uint8_t seed) {
+  FakeImage image{width, height, width * 4 + 8, {}};
+  image.bgra.resize(image.stride * height);
+  for (size_t i = 0; i < image.bgra.size(); i++) {
+    image.bgra[i] = static_cast<uint8_t>(i * 7 + seed);
+  }
+  return image;
+}
+
+// Whether |result| holds the top left of |image| as packed RGBA.
+bool Matches(const FakeImage& image, const Scheduler::Image& result,
+             size_t width, size_t height) {
+  if (result.width != width || result.height != height ||
+      result.pixels.size() != width * height * 4) {
+    return false;
+  }
+  for (size_t y = 0; y < height; y++) {
+    for (size_t x = 0; x < width; x++) {
+      const auto src = &image.bgra[y * image.stride + x * 4];
+      const auto dst = &result.pixels[(y * width + x) * 4];
+      if (dst[0] != src[2] || dst[1] != src[1] || dst[2] != src[0] ||
+          dst[3] != src[3]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+class ReadbackSchedulerTest : public testing::Test {
+ protected:
+  FakeGpu gpu_;
+  std::optional<Scheduler> scheduler_{std::in_place, FakeDevice(&gpu_)};
+  FakeImage small_ = MakeImage(33, 17, 1);
+  FakeImage large_ = MakeImage(64, 48, 2);
+
+  size_t Tick() {
+    gpu_.time++;
+    return scheduler_->Poll();
+  }
+
+  void Drain() {
+    for (int i = 0; i < 20 && Tick() > 0; i++) {
+    }
+  }
+};
+
+}  // namespace
+
+TEST_F(ReadbackSchedulerTest, CompletesInSubmissionOrder) {
+  std::vector<int> order;
+  ASSERT_TRUE(scheduler_->Submit(&small_, 33, 17, [&](auto image) {
+    ASSERT_TRUE(image);
+    EXPECT_TRUE(Matches(small_, *image, 33, 17));
+    order.push_back(1);
+  }));
+  ASSERT_TRUE(scheduler_->Submit(&large_, 40, 30, [&](auto image) {
+    ASSERT_TRUE(image);
+    EXPECT_TRUE(Matches(large_, *image, 40, 30));
+    order.push_back(2);
+  }));
+
+  // Polling never waits for the GPU.
+  EXPECT_EQ(Tick(), 2u);
+  EXPECT_TRUE(order.empty());
+  EXPECT_EQ(Tick(), 0u);
+  EXPECT_EQ(order, std::vector<int>({1, 2}));
+  EXPECT_EQ(scheduler_->stats().completed, 2u);
+}
+
+TEST_F(ReadbackSchedulerTest, ReusesStagingOfSameSize) {
+  scheduler_->Submit(&small_, 33, 17, [](auto) {});
+  Drain();
+  EXPECT_EQ(scheduler_->pooled_count(), 1u);
+
+  scheduler_->Submit(&small_, 33, 17, [](auto) {});
+  Drain();
+  EXPECT_EQ(scheduler_->stats().staging_reuses, 1u);
+  EXPECT_EQ(gpu_.created, 1);
+
+  scheduler_->Clear();
+  EXPECT_EQ(gpu_.live_staging, 0);
+}
+
+TEST_F(ReadbackSchedulerTest, RejectsBeyondInFlightLimit) {
+  int cancelled = 0;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(scheduler_->Submit(&large_, 64, 48, [&](auto image) {
+      cancelled += !image;
+    }));
+  }
+  EXPECT_FALSE(scheduler_->Submit(&large_, 64, 48, [](auto) { FAIL(); }));
+  EXPECT_EQ(scheduler_->stats().rejected, 1u);
+
+  scheduler_->CancelAll();
+  EXPECT_EQ(cancelled, 4);
+  EXPECT_EQ(scheduler_->pending_count(), 0u);
+}
+
+TEST_F(ReadbackSchedulerTest, RejectsFailedCopy) {
+  EXPECT_FALSE(scheduler_->Submit(&large_, 65, 48, [](auto) { FAIL(); }));
+  EXPECT_EQ(scheduler_->stats().rejected, 1u);
+  // The staging buffer went back to the pool.
+  EXPECT_EQ(scheduler_->pooled_count(), 1u);
+}
+
+TEST_F(ReadbackSchedulerTest, ReportsMapFailure) {
+  gpu_.fail_map = true;
+  bool failed = false;
+  scheduler_->Submit(&small_, 33, 17, [&](auto image) { failed = !image; });
+  Tick();
+  EXPECT_TRUE(failed);
+  EXPECT_EQ(scheduler_->stats().failed, 1u);
+}
+
+TEST_F(ReadbackSchedulerTest, CallbackMaySubmit) {
+  int count = 0;
+  std::function<void(std::optional<Scheduler::Image>)> callback =
+      [&](auto) {
+        if (++count < 3) {
+          scheduler_->Submit(&small_, 33, 17, callback);
+        }
+      };
+  scheduler_->Submit(&small_, 33, 17, callback);
+  Drain();
+  EXPECT_EQ(count, 3);
+}
+
+TEST_F(ReadbackSchedulerTest, UsesCustomConverter) {
+  std::optional<Scheduler::Image> result;
+  scheduler_->Submit(
+      &small_, 33, 17, [&](auto image) { result = std::move(image); },
+      [](const ReadbackMapping& mapping, size_t, size_t) {
+        return std::optional<Scheduler::Image>(
+            {1, 1, std::vector<uint8_t>(mapping.data, mapping.data + 4)});
+      });
+  Drain();
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->width, 1u);
+  EXPECT_EQ(result->pixels.size(), 4u);
+}
+
+TEST_F(ReadbackSchedulerTest, DestructionCancelsPendingReadbacks) {
+  bool cancelled = false;
+  scheduler_->Submit(&small_, 33, 17,
+                     [&](auto image) { cancelled = !image; });
+  scheduler_.reset();
+  EXPECT_TRUE(cancelled);
+  EXPECT_EQ(gpu_.live_staging, 0);
+}
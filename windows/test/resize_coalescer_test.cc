@@ -0,0 +1,106 @@
+#include "resize_coalescer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace {
+
+using Size = ResizeCoalescer::Size;
+using std::chrono::milliseconds;
+
+class ResizeCoalescerTest : public ::testing::Test {
+ protected:
+  ResizeCoalescer::TimePoint now_;
+  ResizeCoalescer coalescer_{milliseconds(16), [this]() { return now_; }};
+};
+
+}  // namespace
+
+TEST_F(ResizeCoalescerTest, AppliesFirstRequestRightAway) {
+  const auto size = coalescer_.Request({100, 100, 1});
+  ASSERT_TRUE(size.has_value());
+  EXPECT_EQ(*size, (Size{100, 100, 1}));
+  EXPECT_FALSE(coalescer_.deadline().has_value());
+}
+
+TEST_F(ResizeCoalescerTest, IgnoresCurrentSize) {
+  coalescer_.Request({100, 100, 1});
+  now_ += milliseconds(100);
+  EXPECT_FALSE(coalescer_.Request({100, 100, 1}).has_value());
+  EXPECT_EQ(coalescer_.stats().resizes_collapsed, 1u);
+
+  // A different scale factor is a different size.
+  EXPECT_TRUE(coalescer_.Request({100, 100, 1.5f}).has_value());
+}
+
+TEST_F(ResizeCoalescerTest, DefersBurstToItsLastSize) {
+  coalescer_.Request({100, 100, 1});
+  now_ += milliseconds(2);
+  EXPECT_FALSE(coalescer_.Request({110, 100, 1}).has_value());
+  now_ += milliseconds(2);
+  EXPECT_FALSE(coalescer_.Request({120, 100, 1}).has_value());
+
+  ASSERT_TRUE(coalescer_.deadline().has_value());
+  EXPECT_EQ(*coalescer_.deadline(), ResizeCoalescer::TimePoint() +
+                                        milliseconds(16));
+
+  now_ += milliseconds(2);
+  EXPECT_FALSE(coalescer_.Poll().has_value());
+  now_ += milliseconds(10);
+  const auto size = coalescer_.Poll();
+  ASSERT_TRUE(size.has_value());
+  EXPECT_EQ(size->width, 120u);
+  EXPECT_FALSE(coalescer_.deadline().has_value());
+}
+
+TEST_F(ResizeCoalescerTest, DropsBurstEndingAtAppliedSize) {
+  coalescer_.Request({100, 100, 1});
+  now_ += milliseconds(1);
+  coalescer_.Request({140, 100, 1});
+  coalescer_.Request({100, 100, 1});
+
+  now_ += milliseconds(20);
+  EXPECT_FALSE(coalescer_.Poll().has_value());
+  EXPECT_FALSE(coalescer_.deadline().has_value());
+}
+
+TEST_F(ResizeCoalescerTest, RequestAfterDeadlineAppliesPendingSize) {
+  coalescer_.Request({100, 100, 1});
+  now_ += milliseconds(1);
+  coalescer_.Request({110, 100, 1});
+
+  // No poll in between, the next request picks up the due size.
+  now_ += milliseconds(20);
+  const auto size = coalescer_.Request({120, 100, 1});
+  ASSERT_TRUE(size.has_value());
+  EXPECT_EQ(size->width, 120u);
+}
+
+TEST_F(ResizeCoalescerTest, AppliesAtMostOncePerIntervalDuringStorm) {
+  coalescer_.Request({100, 100, 1});
+  int applied = 0;
+  ResizeCoalescer::TimePoint last_applied = now_;
+  for (size_t i = 1; i <= 1000; i++) {
+    now_ += milliseconds(1);
+    auto size = coalescer_.Request({100 + i, 100, 1});
+    if (!size) {
+      size = coalescer_.Poll();
+    }
+    if (size) {
+      EXPECT_GE(now_ - last_applied, milliseconds(16));
+      last_applied = now_;
+      applied++;
+    }
+  }
+  now_ += milliseconds(16);
+  const auto last = coalescer_.Poll();
+  ASSERT_TRUE(last.has_value());
+  EXPECT_EQ(last->width, 1100u);
+
+  EXPECT_LE(applied, 1000 / 16 + 1);
+  const auto& stats = coalescer_.stats();
+  EXPECT_EQ(stats.resizes_requested, 1001u);
+  EXPECT_EQ(stats.resizes_requested,
+            stats.resizes_applied + stats.resizes_collapsed);
+}
@@ -0,0 +1,165 @@
+#include "scroll_accumulator.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+constexpr int32_t kWheelDelta = ScrollAccumulator::kWheelDelta;
+
+// The physical pixels the plugin's Dart side reports for one wheel notch:
+// Flutter's embedder scales the notch with a float multiplier, the framework
+// divides by the device pixel ratio and the plugin multiplies it back.
+double NotchAsReported(uint32_t lines_per_scroll, double device_pixel_ratio) {
+  const auto multiplier = static_cast<float>(lines_per_scroll) * 100.0 / 3.0;
+  const double logical = static_cast<double>(multiplier) / device_pixel_ratio;
+  return logical * device_pixel_ratio;
+}
+
+}  // namespace
+
+TEST(ScrollAccumulatorTest, PixelsPerNotch) {
+  EXPECT_DOUBLE_EQ(ScrollAccumulator::PixelsPerNotch(3), 100.0);
+  EXPECT_DOUBLE_EQ(ScrollAccumulator::PixelsPerNotch(6), 200.0);
+  // Disabled scrolling falls back to the default.
+  EXPECT_DOUBLE_EQ(ScrollAccumulator::PixelsPerNotch(0), 100.0);
+}
+
+TEST(ScrollAccumulatorTest, RecoversWholeNotches) {
+  for (uint32_t lines : {1u, 3u, 5u, 7u}) {
+    for (double ratio : {1.0, 1.25, 1.5, 1.75, 2.25}) {
+      ScrollAccumulator accumulator(lines);
+      for (int notch = 0; notch < 50; notch++) {
+        const int direction = notch % 7 == 3 ? -1 : 1;
+        accumulator.Add(0, direction * NotchAsReported(lines, ratio));
+        const auto delta = accumulator.Take();
+        EXPECT_EQ(delta.x, 0);
+        ASSERT_EQ(delta.y, direction * kWheelDelta)
+            << "lines " << lines << ", ratio " << ratio << ", notch "
+            << notch;
+        EXPECT_FALSE(accumulator.HasPending());
+      }
+    }
+  }
+}
+
+TEST(ScrollAccumulatorTest, AddsUpSmallDeltas) {
+  ScrollAccumulator accumulator;
+  for (int i = 0; i < 9; i++) {
+    // A tenth of a wheel unit.
+    accumulator.Add(100.0 / kWheelDelta / 10, 0);
+  }
+  EXPECT_FALSE(accumulator.HasPending());
+  EXPECT_EQ(accumulator.Take().x, 0);
+
+  accumulator.Add(100.0 / kWheelDelta / 10, 0);
+  EXPECT_TRUE(accumulator.HasPending());
+  EXPECT_EQ(accumulator.Take().x, 1);
+  EXPECT_FALSE(accumulator.HasPending());
+}
+
+TEST(ScrollAccumulatorTest, KeepsFractionAcrossTakes) {
+  ScrollAccumulator accumulator;
+  // 1.5 wheel units.
+  accumulator.Add(0, 1.25);
+  EXPECT_EQ(accumulator.Take().y, 1);
+  accumulator.Add(0, 1.25);
+  EXPECT_EQ(accumulator.Take().y, 2);
+}
+
+TEST(ScrollAccumulatorTest, DropsFractionOnDirectionChange) {
+  // 0.6 wheel units each.
+  ScrollAccumulator accumulator;
+  accumulator.Add(0.5, 0.5);
+  accumulator.Add(-0.5, 0);
+  auto delta = accumulator.Take();
+  EXPECT_EQ(delta.x, 0);
+  EXPECT_EQ(delta.y, 0);
+
+  // Only the horizontal fraction was dropped.
+  accumulator.Add(0, 0.5);
+  delta = accumulator.Take();
+  EXPECT_EQ(delta.x, 0);
+  EXPECT_EQ(delta.y, 1);
+  accumulator.Add(-0.5, 0);
+  EXPECT_EQ(accumulator.Take().x, -1);
+}
+
+TEST(ScrollAccumulatorTest, IgnoresNonFiniteDeltas) {
+  ScrollAccumulator accumulator;
+  accumulator.Add(NAN, INFINITY);
+  EXPECT_FALSE(accumulator.HasPending());
+  accumulator.Add(100, 0);
+  EXPECT_EQ(accumulator.Take().x, kWheelDelta);
+}
+
+TEST(ScrollAccumulatorTest, ClampsToWheelEventRange) {
+  ScrollAccumulator accumulator;
+  accumulator.Add(0, 1e6);
+  int64_t total = 0;
+  int takes = 0;
+  while (accumulator.HasPending()) {
+    const auto delta = accumulator.Take();
+    EXPECT_LE(std::abs(delta.y), INT16_MAX);
+    total += delta.y;
+    takes++;
+  }
+  EXPECT_EQ(total, 1200000);
+  EXPECT_EQ(takes, 37);
+}
+
+TEST(ScrollAccumulatorTest, ResetDropsFractions) {
+  ScrollAccumulator accumulator;
+  accumulator.Add(0.5, 0.5);
+  accumulator.Reset();
+  accumulator.Add(0.5, 0.5);
+  const auto delta = accumulator.Take();
+  EXPECT_EQ(delta.x, 0);
+  EXPECT_EQ(delta.y, 0);
+}
+
+TEST(ScrollAccumulatorTest, SyntheticTouchpadTrace) {
+  // Swipes with momentum from a precision touchpad, pan updates at 120 Hz
+  // and wheel events taken once per 60 Hz frame.
+  std::mt19937 rng(42);
+  std::normal_distribution<double> noise(0, 0.3);
+  for (double ratio : {1.0, 1.5}) {
+    ScrollAccumulator accumulator;
+    double units_added = 0;
+    int64_t units_taken = 0;
+    int frames = 0;
+    int wheel_events = 0;
+    double velocity = 0;
+    for (int tick = 0; tick < 2400; tick++) {
+      const int phase = tick % 480;
+      if (phase < 30) {
+        velocity = 2 + phase * 0.5;
+      } else {
+        velocity *= 0.97;
+      }
+      if (phase < 200) {
+        const double pixels = std::max(0.0, velocity + noise(rng)) * ratio;
+        accumulator.Add(0, pixels);
+        units_added += pixels * kWheelDelta / 100;
+      }
+      if (tick % 2 == 1) {
+        frames++;
+        const auto delta = accumulator.Take();
+        if (delta.y != 0) {
+          units_taken += delta.y;
+          wheel_events++;
+        }
+      }
+    }
+
+    // Nothing is lost to truncation, and there is at most one wheel event
+    // per frame.
+    EXPECT_LT(std::abs(units_added - units_taken), 1.0) << "ratio " << ratio;
+    EXPECT_LE(wheel_events, frames);
+  }
+}
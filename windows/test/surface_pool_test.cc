@@ -0,0 +1,146 @@
+#include "surface_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <vector>
+
+namespace {
+
+struct FakeSurface {
+  int id;
+};
+
+class SurfacePoolTest : public ::testing::Test {
+ protected:
+  int next_id_ = 0;
+  bool fail_ = false;
+  std::vector<std::pair<size_t, size_t>> allocations_;
+
+  SurfacePool<FakeSurface>::Allocator allocator() {
+    return [this](size_t width,
+                  size_t height) -> std::optional<FakeSurface> {
+      if (fail_) {
+        return std::nullopt;
+      }
+      allocations_.emplace_back(width, height);
+      return FakeSurface{next_id_++};
+    };
+  }
+
+  static SurfacePool<FakeSurface>::Config MakeConfig(size_t max_bytes) {
+    SurfacePool<FakeSurface>::Config config;
+    config.granularity = 64;
+    config.bytes_per_pixel = 1;
+    config.max_bytes = max_bytes;
+    return config;
+  }
+};
+
+}  // namespace
+
+TEST_F(SurfacePoolTest, RoundsUpToBucket) {
+  SurfacePool<FakeSurface> pool(allocator(), MakeConfig(1 << 20));
+  const auto entry = pool.Acquire(100, 65);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->width, 128u);
+  EXPECT_EQ(entry->height, 128u);
+  EXPECT_EQ(allocations_.back(), std::make_pair(size_t{128}, size_t{128}));
+  EXPECT_TRUE(pool.Fits(*entry, 128, 70));
+  EXPECT_FALSE(pool.Fits(*entry, 129, 70));
+  EXPECT_EQ(pool.stats().bytes_in_use, 128u * 128);
+}
+
+TEST_F(SurfacePoolTest, ReusesSurfaceOfSameBucket) {
+  SurfacePool<FakeSurface> pool(allocator(), MakeConfig(1 << 20));
+  auto entry = pool.Acquire(100, 100);
+  pool.Recycle(std::move(*entry));
+  EXPECT_EQ(pool.stats().bytes_in_use, 0u);
+  EXPECT_EQ(pool.stats().bytes_pooled, 128u * 128);
+
+  const auto reused = pool.Acquire(120, 65);
+  ASSERT_TRUE(reused.has_value());
+  EXPECT_EQ(reused->surface.id, 0);
+  EXPECT_EQ(pool.stats().reuses, 1u);
+  EXPECT_EQ(pool.stats().allocations, 1u);
+  EXPECT_EQ(pool.pooled_count(), 0u);
+}
+
+TEST_F(SurfacePoolTest, AllocatesForOtherBucket) {
+  SurfacePool<FakeSurface> pool(allocator(), MakeConfig(1 << 20));
+  auto small = pool.Acquire(100, 100);
+  pool.Recycle(std::move(*small));
+
+  const auto large = pool.Acquire(130, 100);
+  ASSERT_TRUE(large.has_value());
+  EXPECT_EQ(large->surface.id, 1);
+  EXPECT_EQ(large->width, 192u);
+  EXPECT_EQ(pool.pooled_count(), 1u);
+}
+
+TEST_F(SurfacePoolTest, EvictsLeastRecentlyUsedToStayUnderCap) {
+  SurfacePool<FakeSurface> pool(allocator(), MakeConfig(2 * 64 * 64));
+  auto a = pool.Acquire(64, 64);
+  auto b = pool.Acquire(64, 128);
+  pool.Recycle(std::move(*a));
+  // Three buckets' worth exceed the cap, so |a| goes.
+  pool.Recycle(std::move(*b));
+
+  EXPECT_EQ(pool.pooled_count(), 1u);
+  EXPECT_EQ(pool.stats().evictions, 1u);
+  EXPECT_LE(pool.stats().bytes_pooled, 2u * 64 * 64);
+
+  const auto again = pool.Acquire(64, 64);
+  EXPECT_EQ(again->surface.id, 2);
+}
+
+TEST_F(SurfacePoolTest, MakesRoomBeforeAllocating) {
+  const size_t cap = 3 * 128 * 128;
+  SurfacePool<FakeSurface> pool(allocator(), MakeConfig(cap));
+  auto a = pool.Acquire(128, 128);
+  auto b = pool.Acquire(192, 128);
+  pool.Recycle(std::move(*a));
+  pool.Recycle(std::move(*b));
+
+  const auto c = pool.Acquire(256, 128);
+  ASSERT_TRUE(c.has_value());
+  EXPECT_LE(pool.stats().bytes_in_use + pool.stats().bytes_pooled, cap);
+  EXPECT_EQ(pool.stats().evictions, 2u);
+}
+
+TEST_F(SurfacePoolTest, SurfacesInUseAreNeverEvicted) {
+  SurfacePool<FakeSurface> pool(allocator(), MakeConfig(64 * 64));
+  const auto a = pool.Acquire(64, 64);
+  const auto b = pool.Acquire(128, 128);
+  ASSERT_TRUE(a.has_value());
+  ASSERT_TRUE(b.has_value());
+  EXPECT_EQ(pool.stats().bytes_in_use, 64u * 64 + 128 * 128);
+  EXPECT_EQ(pool.stats().evictions, 0u);
+}
+
+TEST_F(SurfacePoolTest, FailedAllocationLeavesAccountingUntouched) {
+  SurfacePool<FakeSurface> pool(allocator(), MakeConfig(1 << 20));
+  fail_ = true;
+  EXPECT_FALSE(pool.Acquire(100, 100).has_value());
+  EXPECT_EQ(pool.stats().bytes_in_use, 0u);
+  EXPECT_EQ(pool.stats().allocations, 0u);
+}
+
+TEST_F(SurfacePoolTest, TrimAndClearFreePooledSurfaces) {
+  SurfacePool<FakeSurface> pool(allocator(), MakeConfig(1 << 20));
+  auto a = pool.Acquire(64, 64);
+  auto b = pool.Acquire(128, 128);
+  const auto c = pool.Acquire(64, 128);
+  ASSERT_TRUE(c.has_value());
+  pool.Recycle(std::move(*a));
+  pool.Recycle(std::move(*b));
+
+  // Only the least recently used one needs to go.
+  EXPECT_EQ(pool.Trim(64 * 128 + 128 * 128), 64u * 64);
+  EXPECT_EQ(pool.pooled_count(), 1u);
+
+  pool.Clear();
+  EXPECT_EQ(pool.pooled_count(), 0u);
+  EXPECT_EQ(pool.stats().bytes_pooled, 0u);
+  EXPECT_EQ(pool.stats().bytes_in_use, 64u * 128);
+}
@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "util/aligned_buffer.h"
+#include "util/swizzle.h"
+
+namespace {
+
+// Converts a 1080p frame with the kernel given by the first argument.
+void BM_SwizzleBgraToRgba(benchmark::State& state) {
+  const auto kernel = static_cast<util::SwizzleKernel>(state.range(0));
+  constexpr size_t kWidth = 1920;
+  constexpr size_t kHeight = 1080;
+  constexpr size_t kStride = kWidth * 4;
+  std::vector<uint8_t> src(kStride * kHeight, 0x5a);
+  util::AlignedBuffer dst;
+  dst.Resize(src.size());
+
+  if (!util::SwizzleBgraToRgba(kernel, src.data(), kStride, dst.data(),
+                               kStride, kWidth, kHeight)) {
+    state.SkipWithError("Kernel not supported by this CPU");
+    return;
+  }
+  for (auto _ : state) {
+    util::SwizzleBgraToRgba(kernel, src.data(), kStride, dst.data(), kStride,
+                            kWidth, kHeight);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(src.size()));
+}
+BENCHMARK(BM_SwizzleBgraToRgba)
+    ->Arg(static_cast<int>(util::SwizzleKernel::kScalar))
+    ->Arg(static_cast<int>(util::SwizzleKernel::kSse2))
+    ->Arg(static_cast<int>(util::SwizzleKernel::kAvx2));
+
+}  // namespace
@@ -0,0 +1,119 @@
+#include "util/swizzle.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "util/aligned_buffer.h"
+
+namespace {
+
+using util::SwizzleKernel;
+
+constexpr SwizzleKernel kKernels[] = {SwizzleKernel::kScalar,
+                                      SwizzleKernel::kSse2,
+                                      SwizzleKernel::kAvx2};
+
+std::vector<uint8_t> RandomBytes(size_t size) {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> bytes(size);
+  for (auto& byte : bytes) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  return bytes;
+}
+
+// Swaps the red and blue channels one pixel at a time.
+std::vector<uint8_t> Reference(const std::vector<uint8_t>& src,
+                               size_t src_stride, size_t width,
+                               size_t height) {
+  std::vector<uint8_t> dst(width * 4 * height);
+  for (size_t y = 0; y < height; y++) {
+    for (size_t x = 0; x < width; x++) {
+      const auto s = &src[y * src_stride + x * 4];
+      const auto d = &dst[(y * width + x) * 4];
+      d[0] = s[2];
+      d[1] = s[1];
+      d[2] = s[0];
+      d[3] = s[3];
+    }
+  }
+  return dst;
+}
+
+}  // namespace
+
+TEST(SwizzleTest, KernelsMatchReference) {
+  // Widths around the vector sizes exercise the remainder loops.
+  for (size_t width : {1, 3, 4, 7, 8, 9, 15, 16, 17, 33, 1001}) {
+    for (size_t height : {1, 3}) {
+      // Padded source rows, like a mapped texture's row pitch.
+      const size_t src_stride = width * 4 + 12;
+      const size_t dst_stride = width * 4;
+      const auto src = RandomBytes(src_stride * height);
+      const auto expected = Reference(src, src_stride, width, height);
+
+      for (const auto kernel : kKernels) {
+        util::AlignedBuffer dst;
+        ASSERT_NE(dst.Resize(dst_stride * height), nullptr);
+        if (!util::SwizzleBgraToRgba(kernel, src.data(), src_stride,
+                                     dst.data(), dst_stride, width, height)) {
+          continue;
+        }
+        EXPECT_EQ(std::memcmp(dst.data(), expected.data(), expected.size()),
+                  0)
+            << "kernel " << static_cast<int>(kernel) << ", width " << width;
+      }
+    }
+  }
+}
+
+TEST(SwizzleTest, KernelsConvertInPlace) {
+  const size_t width = 37;
+  const size_t height = 5;
+  const size_t stride = width * 4 + 12;
+  const auto src = RandomBytes(stride * height);
+  const auto expected = Reference(src, stride, width, height);
+
+  for (const auto kernel : kKernels) {
+    auto pixels = src;
+    if (!util::SwizzleBgraToRgba(kernel, pixels.data(), stride, pixels.data(),
+                                 stride, width, height)) {
+      continue;
+    }
+    for (size_t y = 0; y < height; y++) {
+      EXPECT_EQ(std::memcmp(&pixels[y * stride], &expected[y * width * 4],
+                            width * 4),
+                0)
+          << "kernel " << static_cast<int>(kernel) << ", row " << y;
+    }
+  }
+}
+
+TEST(SwizzleTest, BestKernelIsSupported) {
+  const auto src = RandomBytes(64);
+  std::vector<uint8_t> dst(src.size());
+  EXPECT_TRUE(util::SwizzleBgraToRgba(util::GetBestSwizzleKernel(),
+                                      src.data(), 64, dst.data(), 64, 16, 1));
+}
+
+TEST(AlignedBufferTest, ReusesAlignedAllocation) {
+  util::AlignedBuffer buffer;
+  const auto data = buffer.Resize(1000);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(data) %
+                util::AlignedBuffer::kAlignment,
+            0u);
+
+  // Shrinking keeps the allocation.
+  EXPECT_EQ(buffer.Resize(100), data);
+  EXPECT_EQ(buffer.size(), 100u);
+  EXPECT_EQ(buffer.capacity(), 1000u);
+
+  buffer.Release();
+  EXPECT_EQ(buffer.data(), nullptr);
+  EXPECT_EQ(buffer.capacity(), 0u);
+}
@@ -0,0 +1,134 @@
+#include "tile_change_tracker.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// 3 x 2 tiles of 64 pixels, the last column and row only partially covered.
+constexpr size_t kWidth = 150;
+constexpr size_t kHeight = 100;
+constexpr size_t kColumns = 3;
+constexpr size_t kRows = 2;
+
+bool operator==(const TileChangeTracker::Rect& a,
+                const TileChangeTracker::Rect& b) {
+  return a.x == b.x && a.y == b.y && a.width == b.width &&
+         a.height == b.height;
+}
+
+class TileChangeTrackerTest : public testing::Test {
+ protected:
+  // One BGRA texel per tile.
+  std::vector<uint32_t> tiles_ = std::vector<uint32_t>(kColumns * kRows, 7);
+  TileChangeTracker tracker_;
+
+  void Add(uint64_t generation) {
+    tracker_.Add(generation, kWidth, kHeight,
+                 reinterpret_cast<const uint8_t*>(tiles_.data()),
+                 kColumns * sizeof(uint32_t), sizeof(uint32_t));
+  }
+
+  void Touch(size_t column, size_t row) { tiles_[row * kColumns + column]++; }
+};
+
+}  // namespace
+
+TEST_F(TileChangeTrackerTest, UnknownUntilAdded) {
+  EXPECT_FALSE(tracker_.GetChanges(0, 1).has_value());
+  Add(1);
+  EXPECT_EQ(tracker_.latest_generation(), 1u);
+  // Nothing is known about frames before the first one.
+  EXPECT_FALSE(tracker_.GetChanges(0, 1).has_value());
+  EXPECT_FALSE(tracker_.GetChanges(1, 2).has_value());
+
+  const auto changes = tracker_.GetChanges(1, 1);
+  ASSERT_TRUE(changes.has_value());
+  EXPECT_TRUE(changes->rects.empty());
+  EXPECT_EQ(changes->tile_count, kColumns * kRows);
+  EXPECT_EQ(changes->changed_tile_count, 0u);
+}
+
+TEST_F(TileChangeTrackerTest, ReportsChangesInPixels) {
+  Add(1);
+  Touch(2, 1);
+  Add(2);
+
+  const auto changes = tracker_.GetChanges(1, 2);
+  ASSERT_TRUE(changes.has_value());
+  ASSERT_EQ(changes->rects.size(), 1u);
+  EXPECT_TRUE(changes->rects[0] == (TileChangeTracker::Rect{128, 64, 22, 36}));
+  EXPECT_EQ(changes->changed_tile_count, 1u);
+}
+
+TEST_F(TileChangeTrackerTest, AccumulatesChangesAcrossFrames) {
+  Add(1);
+  Touch(0, 0);
+  Add(2);
+  Touch(1, 0);
+  Add(3);
+  // Changing back still counts as a change.
+  Touch(0, 1);
+  Add(4);
+  tiles_[kColumns]--;
+  Add(5);
+
+  auto changes = tracker_.GetChanges(1, 5);
+  ASSERT_TRUE(changes.has_value());
+  EXPECT_EQ(changes->changed_tile_count, 3u);
+
+  changes = tracker_.GetChanges(2, 3);
+  ASSERT_TRUE(changes.has_value());
+  // Tiles changed after |generation| are included.
+  EXPECT_EQ(changes->changed_tile_count, 2u);
+
+  changes = tracker_.GetChanges(3, 5);
+  ASSERT_TRUE(changes.has_value());
+  ASSERT_EQ(changes->rects.size(), 1u);
+  EXPECT_TRUE(changes->rects[0] == (TileChangeTracker::Rect{0, 64, 64, 36}));
+}
+
+TEST_F(TileChangeTrackerTest, SkippedGenerationRestarts) {
+  Add(1);
+  Add(3);
+  EXPECT_FALSE(tracker_.GetChanges(1, 3).has_value());
+
+  const auto changes = tracker_.GetChanges(3, 3);
+  ASSERT_TRUE(changes.has_value());
+  EXPECT_EQ(changes->changed_tile_count, 0u);
+
+  Add(4);
+  EXPECT_TRUE(tracker_.GetChanges(3, 4).has_value());
+}
+
+TEST_F(TileChangeTrackerTest, ResizeRestarts) {
+  Add(1);
+  tracker_.Add(2, kWidth - 1, kHeight,
+               reinterpret_cast<const uint8_t*>(tiles_.data()),
+               kColumns * sizeof(uint32_t), sizeof(uint32_t));
+  EXPECT_FALSE(tracker_.GetChanges(1, 2).has_value());
+
+  tracker_.Reset();
+  EXPECT_EQ(tracker_.latest_generation(), 0u);
+  EXPECT_FALSE(tracker_.GetChanges(2, 2).has_value());
+}
+
+TEST_F(TileChangeTrackerTest, ComparesWideFingerprints) {
+  // One RGBA16F texel per tile, a change only affecting its upper half.
+  std::vector<uint64_t> tiles(kColumns * kRows, 1);
+  const auto add = [&](uint64_t generation) {
+    tracker_.Add(generation, kWidth, kHeight,
+                 reinterpret_cast<const uint8_t*>(tiles.data()),
+                 kColumns * sizeof(uint64_t), sizeof(uint64_t));
+  };
+  add(1);
+  tiles[4] |= uint64_t{1} << 48;
+  add(2);
+
+  const auto changes = tracker_.GetChanges(1, 2);
+  ASSERT_TRUE(changes.has_value());
+  ASSERT_EQ(changes->rects.size(), 1u);
+  EXPECT_TRUE(changes->rects[0] == (TileChangeTracker::Rect{64, 64, 64, 36}));
+}
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "tile_differ.h"
+
+namespace {
+
+constexpr size_t kWidth = 1920;
+constexpr size_t kHeight = 1080;
+constexpr size_t kStride = kWidth * 4;
+
+// Diffs a synthetic 1080p BGRA frame in which a 200x200 block changes every
+// iteration, with the hash kernel given by the first argument.
+void BM_TileDifferUpdate(benchmark::State& state) {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> pixels(kStride * kHeight);
+  for (auto& byte : pixels) {
+    byte = static_cast<uint8_t>(rng());
+  }
+
+  TileDiffer differ;
+  if (!differ.SetHashKernel(
+          static_cast<TileDiffer::HashKernel>(state.range(0)))) {
+    state.SkipWithError("Kernel not supported by this CPU");
+    return;
+  }
+  differ.Update(pixels.data(), kStride, kWidth, kHeight);
+
+  for (auto _ : state) {
+    for (size_t y = 400; y < 600; y++) {
+      pixels[y * kStride + 800 * 4] ^= 1;
+    }
+    benchmark::DoNotOptimize(
+        differ.Update(pixels.data(), kStride, kWidth, kHeight).data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(pixels.size()));
+}
+BENCHMARK(BM_TileDifferUpdate)
+    ->Arg(static_cast<int>(TileDiffer::HashKernel::kScalar))
+    ->Arg(static_cast<int>(TileDiffer::HashKernel::kSse2))
+    ->Arg(static_cast<int>(TileDiffer::HashKernel::kAvx2));
+
+}  // namespace
@@ -0,0 +1,141 @@
+#include "tile_differ.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t kWidth = 1920;
+constexpr size_t kHeight = 1080;
+
+bool operator==(const TileDiffer::Rect& a, const TileDiffer::Rect& b) {
+  return a.x == b.x && a.y == b.y && a.width == b.width &&
+         a.height == b.height;
+}
+
+class TileDifferTest : public testing::Test {
+ protected:
+  std::vector<uint8_t> pixels_ = std::vector<uint8_t>(kWidth * kHeight * 4, 7);
+  TileDiffer differ_;
+
+  const std::vector<TileDiffer::Rect>& Update() {
+    return differ_.Update(pixels_.data(), kWidth * 4, kWidth, kHeight);
+  }
+
+  void Touch(size_t x, size_t y) { pixels_[(y * kWidth + x) * 4] ^= 1; }
+};
+
+}  // namespace
+
+TEST_F(TileDifferTest, FirstFrameIsFullyDirty) {
+  const auto& rects = Update();
+  ASSERT_EQ(rects.size(), 1u);
+  EXPECT_TRUE(rects[0] == (TileDiffer::Rect{0, 0, kWidth, kHeight}));
+  EXPECT_EQ(differ_.dirty_tile_count(), differ_.rows() * differ_.columns());
+}
+
+TEST_F(TileDifferTest, StaticFrameHasNoDirtyRects) {
+  Update();
+  EXPECT_TRUE(Update().empty());
+  EXPECT_EQ(differ_.dirty_tile_count(), 0u);
+}
+
+TEST_F(TileDifferTest, ChangedBlockIsAlignedToTiles) {
+  Update();
+  for (size_t y = 70; y < 170; y++) {
+    for (size_t x = 70; x < 170; x++) {
+      Touch(x, y);
+    }
+  }
+
+  const auto& rects = Update();
+  ASSERT_EQ(rects.size(), 1u);
+  EXPECT_TRUE(rects[0] == (TileDiffer::Rect{64, 64, 128, 128}));
+  EXPECT_EQ(differ_.dirty_tile_count(), 4u);
+}
+
+TEST_F(TileDifferTest, LShapeNeedsTwoRects) {
+  Update();
+  Touch(0, 0);
+  Touch(65, 0);
+  Touch(0, 65);
+
+  EXPECT_EQ(Update().size(), 2u);
+  EXPECT_EQ(differ_.dirty_tile_count(), 3u);
+}
+
+TEST_F(TileDifferTest, ScatteredChangesFallBackToBoundingBox) {
+  Update();
+  for (size_t i = 0; i < 40; i++) {
+    Touch((i * 128) % kWidth, (i * 128) % kHeight);
+  }
+
+  EXPECT_EQ(Update().size(), 1u);
+}
+
+TEST_F(TileDifferTest, ResetMakesEverythingDirty) {
+  Update();
+  differ_.Reset();
+  const auto& rects = Update();
+  ASSERT_EQ(rects.size(), 1u);
+  EXPECT_TRUE(rects[0] == (TileDiffer::Rect{0, 0, kWidth, kHeight}));
+}
+
+TEST(TileDifferKernelTest, KernelsAgreeOnRandomFrames) {
+  std::mt19937 rng(1);
+  for (int trial = 0; trial < 200; trial++) {
+    const size_t width = 1 + rng() % 300;
+    const size_t height = 1 + rng() % 200;
+    const size_t stride = width * 4 + (rng() % 3) * 4;
+    std::vector<uint8_t> pixels(stride * height);
+    for (auto& byte : pixels) {
+      byte = static_cast<uint8_t>(rng());
+    }
+
+    TileDiffer::Config config;
+    config.tile_size = 1 + rng() % 70;
+    TileDiffer scalar(config);
+    TileDiffer sse2(config);
+    TileDiffer avx2(config);
+    ASSERT_TRUE(scalar.SetHashKernel(TileDiffer::HashKernel::kScalar));
+    // Unsupported kernels are skipped below.
+    const bool has_sse2 = sse2.SetHashKernel(TileDiffer::HashKernel::kSse2);
+    const bool has_avx2 = avx2.SetHashKernel(TileDiffer::HashKernel::kAvx2);
+    for (auto* differ : {&scalar, &sse2, &avx2}) {
+      differ->Update(pixels.data(), stride, width, height);
+    }
+
+    const size_t changes = rng() % 5;
+    for (size_t i = 0; i < changes; i++) {
+      const size_t x = rng() % width;
+      const size_t y = rng() % height;
+      pixels[y * stride + x * 4 + rng() % 4] ^= 1 + rng() % 255;
+    }
+
+    const auto expected = scalar.Update(pixels.data(), stride, width, height);
+    EXPECT_LE(scalar.dirty_tile_count(), changes);
+    if (changes == 0) {
+      EXPECT_TRUE(expected.empty());
+    }
+    for (const auto& rect : expected) {
+      EXPECT_GT(rect.width, 0u);
+      EXPECT_GT(rect.height, 0u);
+      EXPECT_LE(rect.x + rect.width, width);
+      EXPECT_LE(rect.y + rect.height, height);
+    }
+
+    for (auto* differ : {&sse2, &avx2}) {
+      if ((differ == &sse2 && !has_sse2) || (differ == &avx2 && !has_avx2)) {
+        continue;
+      }
+      const auto& rects = differ->Update(pixels.data(), stride, width, height);
+      ASSERT_EQ(rects.size(), expected.size());
+      for (size_t i = 0; i < rects.size(); i++) {
+        EXPECT_TRUE(rects[i] == expected[i]);
+      }
+    }
+  }
+}
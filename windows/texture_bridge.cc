@@ -7,15 +7,83 @@
 #include <cassert>
 #include <iostream>
 
+#include "util/d3dutil.h"
 #include "util/direct3d11.interop.h"
 
 namespace {
-const int kNumBuffers = 1;
+
+// How often the FPS governor is evaluated on the platform thread, in
+// addition to whenever frames arrive.
+constexpr auto kFpsGovernorPollInterval = std::chrono::milliseconds(250);
+
+// How often fingerprints of suppressed frames are checked while no frames
+// arrive.
+constexpr auto kStaticFramePollInterval = std::chrono::milliseconds(16);
+
+class CaptureFramePoolSource : public FrameSource<CapturedFrame> {
+ public:
+  explicit CaptureFramePoolSource(
+      ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePool* frame_pool)
+      : frame_pool_(frame_pool) {}
+
+  std::optional<CapturedFrame> TryGetNextFrame() override {
+    CapturedFrame captured;
+    auto hr = frame_pool_->TryGetNextFrame(captured.frame.put());
+    if (FAILED(hr) || !captured.frame) {
+      return std::nullopt;
+    }
+
+    winrt::com_ptr<
+        ABI::Windows::Graphics::DirectX::Direct3D11::IDirect3DSurface>
+        frame_surface;
+    if (FAILED(captured.frame->get_Surface(frame_surface.put()))) {
+      return std::nullopt;
+    }
+
+    captured.texture =
+        util::TryGetDXGIInterfaceFromObject<ID3D11Texture2D>(frame_surface);
+    if (!captured.texture) {
+      return std::nullopt;
+    }
+    captured.arrival_time = std::chrono::steady_clock::now();
+    return captured;
+  }
+
+ private:
+  ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePool* frame_pool_;
+};
+
 }  // namespace
 
 TextureBridge::TextureBridge(GraphicsContext* graphics_context,
-                             ABI::Windows::UI::Composition::IVisual* visual)
-    : graphics_context_(graphics_context) {
+                             ABI::Windows::UI::Composition::IVisual* visual,
+                             TaskRunner* task_runner,
+                             const TextureBridgeOptions& options)
+    : graphics_context_(graphics_context),
+      task_runner_(task_runner),
+      pixel_format_(util::NegotiateCaptureFormat(options.pixel_format)),
+      frame_ring_(std::clamp(options.frame_buffer_count, size_t{1},
+                             kMaxFrameBufferCount)) {
+  // Bound to the first thread consuming frames.
+  raster_thread_checker_.Detach();
+
+  if (options.suppress_static_frames) {
+    StaticFrameDetector::Config config;
+    config.pixel_format = pixel_format_;
+    static_frame_detector_ =
+        std::make_unique<StaticFrameDetector>(graphics_context, config);
+  }
+
+  if (options.free_threaded_capture) {
+    capture_thread_checker_.Detach();
+    frame_worker_ = std::make_shared<FrameWorker>(
+        [this]() { OnFrameArrived(); },
+        // The capture objects are agile, but may only be used from threads
+        // that initialized COM.
+        []() { CoInitializeEx(nullptr, COINIT_MULTITHREADED); },
+        []() { CoUninitialize(); });
+  }
+
   capture_item_ =
       graphics_context_->CreateGraphicsCaptureItemFromVisual(visual);
   assert(capture_item_);
@@ -34,14 +102,25 @@ TextureBridge::TextureBridge(GraphicsContext* graphics_context,
 }
 
 TextureBridge::~TextureBridge() {
-  const std::lock_guard<std::mutex> lock(mutex_);
-  StopInternal();
+  fps_governor_timer_ = nullptr;
+  static_frame_timer_ = nullptr;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    StopInternal();
+  }
+
+  // Waits for a pending |OnFrameArrived| to finish.
+  if (frame_worker_) {
+    frame_worker_->Stop();
+  }
+
   if (capture_item_) {
     capture_item_->remove_Closed(on_closed_token_);
   }
 }
 
 bool TextureBridge::Start() {
+  assert(platform_thread_checker_.IsCurrent());
   const std::lock_guard<std::mutex> lock(mutex_);
   if (is_running_ || !capture_item_) {
     return false;
@@ -50,21 +129,36 @@ bool TextureBridge::Start() {
   ABI::Windows::Graphics::SizeInt32 size;
   capture_item_->get_Size(&size);
 
-  frame_pool_ = graphics_context_->CreateCaptureFramePool(
-      graphics_context_->device(),
+  const auto pixel_format =
       static_cast<ABI::Windows::Graphics::DirectX::DirectXPixelFormat>(
-          kPixelFormat),
-      kNumBuffers, size);
+          ToDxgiFormat(pixel_format_));
+  frame_pool_ =
+      frame_worker_
+          ? graphics_context_->CreateFreeThreadedCaptureFramePool(
+                graphics_context_->device(), pixel_format,
+                GetCapturePoolBufferCount(), size)
+          : graphics_context_->CreateCaptureFramePool(
+                graphics_context_->device(), pixel_format,
+                GetCapturePoolBufferCount(), size);
   assert(frame_pool_);
+  frame_source_ = std::make_unique<CaptureFramePoolSource>(frame_pool_.get());
+  UpdateCapturePoolBytes(size);
 
   frame_pool_->add_FrameArrived(
       Microsoft::WRL::Callback<ABI::Windows::Foundation::ITypedEventHandler<
           ABI::Windows::Graphics::Capture::Direct3D11CaptureFramePool*,
           IInspectable*>>(
-          [this](ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePool*
-                     pool,
-                 IInspectable* args) -> HRESULT {
-            OnFrameArrived();
+          [this, worker = frame_worker_](
+              ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePool*
+                  pool,
+              IInspectable* args) -> HRESULT {
+            // The free-threaded pool calls back on a thread pool thread,
+            // so hand the work over to the worker.
+            if (worker) {
+              worker->Signal();
+            } else {
+              OnFrameArrived();
+            }
             return S_OK;
           })
           .Get(),
@@ -77,6 +171,8 @@ bool TextureBridge::Start() {
   }
 
   if (SUCCEEDED(capture_session_->StartCapture())) {
+    // A signal sent before stopping may never have been answered.
+    frame_signal_pending_ = false;
     is_running_ = true;
     return true;
   }
@@ -85,6 +181,7 @@ bool TextureBridge::Start() {
 }
 
 void TextureBridge::Stop() {
+  assert(platform_thread_checker_.IsCurrent());
   const std::lock_guard<std::mutex> lock(mutex_);
   StopInternal();
 }
@@ -98,79 +195,354 @@ void TextureBridge::StopInternal() {
     assert(closable);
     closable->Close();
     capture_session_ = nullptr;
+
+    // Hand all buffered frames back to the pool.
+    frame_ring_.Clear();
+
+    // Always signal the first frame after resuming.
+    if (static_frame_detector_) {
+      static_frame_detector_->Reset();
+    }
   }
 }
 
 void TextureBridge::OnFrameArrived() {
-  const std::lock_guard<std::mutex> lock(mutex_);
-  if (!is_running_) {
-    return;
+  assert(capture_thread_checker_.IsCurrent());
+  // Signaling may run the callbacks synchronously, which e.g. flush input
+  // into the webview, so they are only invoked once |mutex_| is released.
+  bool has_frame = false;
+  bool poll_static_frames = false;
+  std::optional<FpsGovernor::Decision> decision;
+  std::vector<std::chrono::steady_clock::time_point> arrival_times;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_running_) {
+      return;
+    }
+
+    const auto visible_rect = GetVisibleRect();
+    const bool is_hidden = visible_rect && visible_rect->IsEmpty();
+
+    // Drain the pool so that none of its buffers stay checked out.
+    while (auto frame = frame_source_->TryGetNextFrame()) {
+      // Frames exceeding the FPS limit still get published so that the most
+      // recent one is picked up by the next raster pass.
+      const bool should_drop = !frame_pacer_.ShouldAcceptFrame();
+      frame_stats_.RecordFrameArrived(should_drop);
+      arrival_times.push_back(frame->arrival_time);
+      // Probably unchanged and hidden frames are still published, but Flutter
+      // isn't asked to redraw for them.
+      const bool is_held =
+          !should_drop && !is_hidden && static_frame_detector_ &&
+          static_frame_detector_->IsUnchanged(frame->texture.get(),
+                                              frame->arrival_time);
+      const auto texture = frame->texture;
+      const bool published = frame_ring_.Publish(std::move(*frame));
+      // Hidden frames are rarely consumed, so they're not worth inspecting.
+      if (published && !is_hidden) {
+        OnFramePublished(texture.get(), frame_ring_.latest_generation());
+      }
+      bool delivered = published && !should_drop;
+      // Held frames only count as suppressed once their fingerprint was read
+      // back.
+      if (delivered && is_hidden) {
+        frame_stats_.RecordFramesSuppressed(1);
+      }
+      delivered &= !is_held && !is_hidden;
+      fps_governor_.OnFrameArrived(delivered);
+      has_frame |= delivered;
+    }
+
+    if (EvaluateFpsGovernor()) {
+      decision = fps_governor_.decision();
+    }
+    // Held frames may turn out to have changed after all.
+    if (static_frame_detector_) {
+      has_frame |= RecordHeldFrames();
+      poll_static_frames = static_frame_detector_->HasHeldPending();
+    }
+
+    if (needs_update_) {
+      ABI::Windows::Graphics::SizeInt32 size;
+      capture_item_->get_Size(&size);
+      frame_pool_->Recreate(
+          graphics_context_->device(),
+          static_cast<ABI::Windows::Graphics::DirectX::DirectXPixelFormat>(
+              ToDxgiFormat(pixel_format_)),
+          GetCapturePoolBufferCount(), size);
+      UpdateCapturePoolBytes(size);
+      needs_update_ = false;
+      frame_stats_.RecordResizeRecreation();
+    }
   }
 
-  bool has_frame = false;
+  if (frame_arrived_) {
+    for (const auto& arrival_time : arrival_times) {
+      frame_arrived_(arrival_time);
+    }
+  }
 
-  winrt::com_ptr<ABI::Windows::Graphics::Capture::IDirect3D11CaptureFrame>
-      frame;
-  auto hr = frame_pool_->TryGetNextFrame(frame.put());
-  if (SUCCEEDED(hr) && frame) {
-    winrt::com_ptr<
-        ABI::Windows::Graphics::DirectX::Direct3D11::IDirect3DSurface>
-        frame_surface;
+  if (has_frame) {
+    RunOnPlatformThread([this]() { SignalFrameAvailable(); });
+  }
 
-    if (SUCCEEDED(frame->get_Surface(frame_surface.put()))) {
-      last_frame_ =
-          util::TryGetDXGIInterfaceFromObject<ID3D11Texture2D>(frame_surface);
-      has_frame = !ShouldDropFrame();
+  if (poll_static_frames) {
+    RunOnPlatformThread([this]() { StartStaticFramePoll(); });
+  }
+
+  if (decision) {
+    RunOnPlatformThread([this, decision = *decision]() {
+      if (fps_governor_decision_changed_) {
+        fps_governor_decision_changed_(decision);
+      }
+    });
+  }
+}
+
+void TextureBridge::StartStaticFramePoll() {
+  assert(platform_thread_checker_.IsCurrent());
+  if (is_static_frame_poll_active_) {
+    return;
+  }
+
+  if (static_frame_timer_) {
+    is_static_frame_poll_active_ = static_frame_timer_->Start();
+  } else {
+    static_frame_timer_ = task_runner_->CreateTimer(
+        kStaticFramePollInterval, [this]() { PollStaticFrames(); });
+    is_static_frame_poll_active_ = static_frame_timer_ != nullptr;
+  }
+}
+
+void TextureBridge::PollStaticFrames() {
+  assert(platform_thread_checker_.IsCurrent());
+  bool changed = false;
+  bool pending = false;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (is_running_) {
+      changed = RecordHeldFrames();
+      pending = static_frame_detector_->HasHeldPending();
     }
   }
 
-  if (needs_update_) {
-    ABI::Windows::Graphics::SizeInt32 size;
-    capture_item_->get_Size(&size);
-    frame_pool_->Recreate(
-        graphics_context_->device(),
-        static_cast<ABI::Windows::Graphics::DirectX::DirectXPixelFormat>(
-            kPixelFormat),
-        kNumBuffers, size);
-    needs_update_ = false;
+  if (!pending) {
+    static_frame_timer_->Stop();
+    is_static_frame_poll_active_ = false;
   }
+  // The held frame is still in |frame_ring_|.
+  if (changed) {
+    SignalFrameAvailable();
+  }
+}
 
-  if (has_frame && frame_available_) {
-    frame_available_();
+bool TextureBridge::RecordHeldFrames() {
+  const auto held = static_frame_detector_->PollHeldFrames();
+  frame_stats_.RecordFramesSuppressed(held.unchanged_count);
+  if (held.changed_arrival_time) {
+    frame_stats_.RecordHeldFrameSignaled(*held.changed_arrival_time);
   }
+  return held.changed_arrival_time.has_value();
 }
 
-bool TextureBridge::ShouldDropFrame() {
-  if (!frame_duration_.has_value()) {
-    return false;
+void TextureBridge::RunOnPlatformThread(std::function<void()> task) {
+  if (platform_thread_checker_.IsCurrent()) {
+    return task();
   }
-  auto now = std::chrono::high_resolution_clock::now();
 
-  bool should_drop_frame = false;
-  if (last_frame_timestamp_.has_value()) {
-    auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - last_frame_timestamp_.value());
-    should_drop_frame = diff < frame_duration_.value();
+  task_runner_->PostTask(
+      [alive = std::weak_ptr<int>(alive_), task = std::move(task)]() {
+        // Destruction happens on this thread as well, so the instance can't
+        // go away while |task| runs.
+        if (alive.lock()) {
+          task();
+        }
+      });
+}
+
+int32_t TextureBridge::GetCapturePoolBufferCount() const {
+  // One extra buffer for the frame in flight while all ring slots are
+  // occupied.
+  return static_cast<int32_t>(frame_ring_.depth() + 1);
+}
+
+void TextureBridge::UpdateCapturePoolBytes(
+    ABI::Windows::Graphics::SizeInt32 size) {
+  capture_pool_bytes_ =
+      util::ImageBytes(pixel_format_, static_cast<size_t>(size.Width),
+                       static_cast<size_t>(size.Height)) *
+      GetCapturePoolBufferCount();
+}
+
+size_t TextureBridge::TrimGpuMemory(GpuMemoryBudget::TrimLevel level) {
+  assert(platform_thread_checker_.IsCurrent());
+  if (level != GpuMemoryBudget::TrimLevel::kAll) {
+    return 0;
+  }
+
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (is_running_ || !frame_pool_) {
+    return 0;
+  }
+
+  // |Start| creates a new pool.
+  if (auto closable =
+          frame_pool_.try_as<ABI::Windows::Foundation::IClosable>()) {
+    closable->Close();
   }
+  frame_source_ = nullptr;
+  frame_pool_ = nullptr;
+  size_t freed = capture_pool_bytes_.exchange(0);
+  if (static_frame_detector_) {
+    freed += static_frame_detector_->ReleaseResources();
+  }
+  return freed;
+}
 
-  if (!should_drop_frame) {
-    last_frame_timestamp_ = now;
+bool TextureBridge::ReadCurrentFrame(const FrameReader& reader) {
+  // Keeps the capture callback from recycling the frame.
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto frame = frame_ring_.PeekLatest();
+  if (!frame) {
+    return false;
   }
-  return should_drop_frame;
+
+  D3D11_TEXTURE2D_DESC desc;
+  frame->texture->GetDesc(&desc);
+  return reader(frame->texture.get(), desc.Width, desc.Height);
 }
 
 void TextureBridge::NotifySurfaceSizeChanged() {
+  assert(platform_thread_checker_.IsCurrent());
   const std::lock_guard<std::mutex> lock(mutex_);
   needs_update_ = true;
 }
 
+void TextureBridge::SetVisibleRect(
+    std::optional<CopyRegionPlanner::Rect> rect) {
+  assert(platform_thread_checker_.IsCurrent());
+  {
+    const std::lock_guard<std::mutex> lock(visible_rect_mutex_);
+    if (visible_rect_ == rect) {
+      return;
+    }
+    visible_rect_ = rect;
+  }
+  is_hidden_.store(rect && rect->IsEmpty(), std::memory_order_relaxed);
+
+  // Have the consumer copy newly exposed parts of the latest frame.
+  if (!(rect && rect->IsEmpty())) {
+    SignalFrameAvailable();
+  }
+}
+
+void TextureBridge::SignalFrameAvailable() {
+  assert(platform_thread_checker_.IsCurrent());
+  // The pending request picks up the latest frame anyway, so another signal
+  // would only queue a redundant engine task.
+  if (frame_signal_pending_.exchange(true, std::memory_order_acq_rel)) {
+    frame_stats_.RecordSignalCoalesced();
+    return;
+  }
+  frame_stats_.RecordFrameSignaled();
+  if (frame_available_) {
+    frame_available_();
+  }
+}
+
+std::optional<CopyRegionPlanner::Rect> TextureBridge::GetVisibleRect() {
+  const std::lock_guard<std::mutex> lock(visible_rect_mutex_);
+  return visible_rect_;
+}
+
 void TextureBridge::SetFpsLimit(std::optional<int> max_fps) {
+  assert(platform_thread_checker_.IsCurrent());
   const std::lock_guard<std::mutex> lock(mutex_);
-  auto value = max_fps.value_or(0);
-  if (value != 0) {
-    frame_duration_ = FrameDuration(1000.0 / value);
-  } else {
-    frame_duration_.reset();
-    last_frame_timestamp_.reset();
+  fps_limit_ = max_fps;
+  ApplyFpsLimit();
+}
+
+void TextureBridge::SetAdaptiveFpsEnabled(bool enabled) {
+  assert(platform_thread_checker_.IsCurrent());
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    fps_governor_.SetEnabled(enabled);
+    ApplyFpsLimit();
+  }
+
+  // Frames may stop arriving altogether, in which case only the timer gets
+  // the governor to step down.
+  if (!enabled) {
+    fps_governor_timer_ = nullptr;
+  } else if (!fps_governor_timer_) {
+    fps_governor_timer_ = task_runner_->CreateTimer(
+        kFpsGovernorPollInterval, [this]() { UpdateFpsGovernor(); });
+  }
+}
+
+void TextureBridge::NotifyActivity() {
+  assert(platform_thread_checker_.IsCurrent());
+  FpsGovernor::Decision decision;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!fps_governor_.OnActivity()) {
+      return;
+    }
+    ApplyFpsLimit();
+    decision = fps_governor_.decision();
+  }
+
+  if (fps_governor_decision_changed_) {
+    fps_governor_decision_changed_(decision);
+  }
+}
+
+void TextureBridge::UpdateFpsGovernor() {
+  assert(platform_thread_checker_.IsCurrent());
+  FpsGovernor::Decision decision;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_running_ || !EvaluateFpsGovernor()) {
+      return;
+    }
+    decision = fps_governor_.decision();
+  }
+
+  if (fps_governor_decision_changed_) {
+    fps_governor_decision_changed_(decision);
   }
 }
+
+bool TextureBridge::EvaluateFpsGovernor() {
+  const auto frames_consumed = frames_consumed_.load(std::memory_order_relaxed);
+  fps_governor_.OnFramesConsumed(frames_consumed - frames_consumed_reported_);
+  frames_consumed_reported_ = frames_consumed;
+
+  if (!fps_governor_.Update()) {
+    return false;
+  }
+  ApplyFpsLimit();
+  return true;
+}
+
+void TextureBridge::ApplyFpsLimit() {
+  std::optional<double> limit;
+  if (fps_limit_.has_value()) {
+    limit = *fps_limit_;
+  }
+
+  const auto& governor_limit = fps_governor_.decision().max_fps;
+  if (governor_limit.has_value() &&
+      (!limit.has_value() || *governor_limit < *limit)) {
+    limit = governor_limit;
+  }
+
+  if (limit != frame_pacer_.target_fps()) {
+    frame_pacer_.SetTargetFps(limit);
+  }
+}
+
+FramePacer::Stats TextureBridge::GetPacerStats() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return frame_pacer_.stats();
+}
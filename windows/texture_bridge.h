@@ -3,27 +3,90 @@
 #include <windows.graphics.capture.h>
 #include <wrl.h>
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <vector>
 
+#include "copy_region_planner.h"
+#include "fps_governor.h"
+#include "frame_pacer.h"
+#include "frame_ring.h"
+#include "frame_stats.h"
+#include "frame_worker.h"
+#include "gpu_memory_budget.h"
 #include "graphics_context.h"
+#include "static_frame_detector.h"
+#include "task_runner.h"
+#include "tile_differ.h"
+#include "util/pixel_format.h"
+#include "util/thread_checker.h"
 
 typedef struct {
   size_t width;
   size_t height;
 } Size;
 
-class TextureBridge {
+enum class TextureMode {
+  // Shares a DXGI surface with Flutter (|TextureBridgeGpu|).
+  kGpuSurface,
+  // Copies frames into system memory (|TextureBridgePixelBuffer|).
+  kPixelBuffer,
+};
+
+struct TextureBridgeOptions {
+  // The number of captured frames buffered between the capture pool and the
+  // Flutter texture (1 = single, 2 = double, 3 = triple buffering).
+  size_t frame_buffer_count = 1;
+  // Receives frames from a free-threaded capture pool on a dedicated worker
+  // thread instead of the platform thread.
+  bool free_threaded_capture = false;
+  TextureMode texture_mode = TextureMode::kGpuSurface;
+  // Doesn't signal frames whose content matches the previous one. The first
+  // frame to change after a static period is only signaled once its
+  // fingerprint was read back, see |StaticFrameDetector|.
+  bool suppress_static_frames = false;
+  // The requested format, see |TextureBridge::pixel_format| for the one
+  // actually used.
+  util::PixelFormat pixel_format = util::PixelFormat::kBgra8;
+};
+
+struct CapturedFrame {
+  // Keeps the frame's buffer checked out from the capture pool.
+  winrt::com_ptr<ABI::Windows::Graphics::Capture::IDirect3D11CaptureFrame>
+      frame;
+  winrt::com_ptr<ID3D11Texture2D> texture;
+  std::chrono::steady_clock::time_point arrival_time;
+};
+
+// Threading: all methods not documented otherwise must be called on the
+// platform thread, which is also where callbacks are invoked. Frames are
+// acquired on the capture thread (the platform thread or, with
+// |TextureBridgeOptions::free_threaded_capture|, a dedicated worker) and
+// consumed on the raster thread.
+class TextureBridge : public GpuMemoryBudget::Client {
  public:
   typedef std::function<void()> FrameAvailableCallback;
+  typedef std::function<void(std::chrono::steady_clock::time_point)>
+      FrameArrivedCallback;
   typedef std::function<void(Size size)> SurfaceSizeChangedCallback;
-  typedef std::chrono::duration<double, std::milli> FrameDuration;
+  typedef std::function<void(const FpsGovernor::Decision&)>
+      FpsGovernorDecisionCallback;
+  // Receives a texture in |pixel_format| whose top left |width| x |height|
+  // pixels hold the frame.
+  typedef std::function<bool(ID3D11Texture2D* texture, uint32_t width,
+                             uint32_t height)>
+      FrameReader;
+
+  static constexpr size_t kMaxFrameBufferCount = 4;
 
   TextureBridge(GraphicsContext* graphics_context,
-                ABI::Windows::UI::Composition::IVisual* visual);
+                ABI::Windows::UI::Composition::IVisual* visual,
+                TaskRunner* task_runner, const TextureBridgeOptions& options);
   virtual ~TextureBridge();
 
   bool Start();
@@ -33,31 +96,133 @@ class TextureBridge {
     frame_available_ = std::move(callback);
   }
 
+  // Called on the capture thread with the arrival time of every frame taken
+  // from the capture pool, including ones Flutter isn't signaled for. Must be
+  // set before |Start|.
+  void SetOnFrameArrived(FrameArrivedCallback callback) {
+    frame_arrived_ = std::move(callback);
+  }
+
   void SetOnSurfaceSizeChanged(SurfaceSizeChangedCallback callback) {
     surface_size_changed_ = std::move(callback);
   }
 
+  void SetOnFpsGovernorDecisionChanged(FpsGovernorDecisionCallback callback) {
+    fps_governor_decision_changed_ = std::move(callback);
+  }
+
   void NotifySurfaceSizeChanged();
   void SetFpsLimit(std::optional<int> max_fps);
+  // May be called from any thread.
+  FramePacer::Stats GetPacerStats();
+  // The format of captured frames and of the surfaces handed to Flutter in
+  // |TextureMode::kGpuSurface|, negotiated from
+  // |TextureBridgeOptions::pixel_format|.
+  util::PixelFormat pixel_format() const { return pixel_format_; }
+  // Doesn't lock and may be called from any thread.
+  FrameStats::Snapshot GetFrameStats() const {
+    return frame_stats_.GetSnapshot();
+  }
+  // Calls |reader| with the newest captured frame, which Flutter may not
+  // have picked up yet. The texture may only be used for enqueuing GPU
+  // copies until |reader| returns, which blocks the capture callback.
+  // Returns false if there is no such frame, e.g. while stopped, or |reader|
+  // failed.
+  bool ReadCurrentFrame(const FrameReader& reader);
+
+  // Returns the regions of the last frame handed to Flutter which differed
+  // from the one before, or std::nullopt if the bridge doesn't track them.
+  // May be called from any thread.
+  virtual std::optional<std::vector<TileDiffer::Rect>> GetDirtyRects() {
+    return std::nullopt;
+  }
+
+  // Sets the part of the texture that's on screen, in physical pixels, or
+  // std::nullopt if all of it is. Frames aren't signaled while the rect is
+  // empty, and |TextureBridgeGpu| only copies the visible part.
+  void SetVisibleRect(std::optional<CopyRegionPlanner::Rect> rect);
+
+  // Enables lowering the frame rate automatically while frames aren't
+  // needed. The limit set by |SetFpsLimit| still applies on top.
+  void SetAdaptiveFpsEnabled(bool enabled);
+  // Signals input or navigation, which restores the full frame rate.
+  void NotifyActivity();
+
+  // GpuMemoryBudget::Client:
+  // The capture pool and surfaces, may be queried from any thread.
+  size_t GetGpuMemoryUsage() const override {
+    return capture_pool_bytes_.load(std::memory_order_relaxed) +
+           surface_bytes_.load(std::memory_order_relaxed) +
+           (static_frame_detector_ ? static_frame_detector_->gpu_bytes() : 0);
+  }
+  bool IsSuspended() const override { return !is_running_; }
+  bool IsHidden() const override {
+    return is_hidden_.load(std::memory_order_relaxed);
+  }
+  uint64_t GetFramesShown() const override {
+    return frames_consumed_.load(std::memory_order_relaxed);
+  }
+  // Releases the capture pool and the static frame detector's resources of
+  // a stopped bridge at |TrimLevel::kAll|.
+  size_t TrimGpuMemory(GpuMemoryBudget::TrimLevel level) override;
 
  protected:
-  bool is_running_ = false;
+  std::atomic<bool> is_running_ = false;
 
   const GraphicsContext* graphics_context_;
+  TaskRunner* task_runner_;
+  const util::PixelFormat pixel_format_;
+  util::ThreadChecker platform_thread_checker_;
+  util::ThreadChecker capture_thread_checker_;
+  util::ThreadChecker raster_thread_checker_;
+  // Runs |OnFrameArrived| in free-threaded mode. Shared with the
+  // FrameArrived handler, which may still fire after being removed.
+  std::shared_ptr<FrameWorker> frame_worker_;
+  // Lets tasks posted to the platform thread detect that this instance is
+  // gone.
+  std::shared_ptr<int> alive_ = std::make_shared<int>();
+  // Guards the capture session. Frames are handed over to the consumer via
+  // |frame_ring_|, so this is never taken on the raster thread.
   std::mutex mutex_;
-  std::optional<FrameDuration> frame_duration_ = std::nullopt;
+  FramePacer frame_pacer_;
+  // Guards |visible_rect_|, which the consumer reads as well.
+  std::mutex visible_rect_mutex_;
+  std::optional<CopyRegionPlanner::Rect> visible_rect_;
+  // Set while |visible_rect_| is empty.
+  std::atomic<bool> is_hidden_ = false;
+  // Set if |TextureBridgeOptions::suppress_static_frames| is enabled.
+  std::unique_ptr<StaticFrameDetector> static_frame_detector_;
+  FpsGovernor fps_governor_;
+  // Evaluates |fps_governor_| while no frames arrive.
+  std::unique_ptr<TaskRunner::Timer> fps_governor_timer_;
+  // Checks frames held by |static_frame_detector_| whose fingerprint wasn't
+  // read back yet, running while |is_static_frame_poll_active_|.
+  std::unique_ptr<TaskRunner::Timer> static_frame_timer_;
+  bool is_static_frame_poll_active_ = false;
+  std::optional<int> fps_limit_;
+  // Incremented by the consumer for each new frame it picks up.
+  std::atomic<uint64_t> frames_consumed_ = 0;
+  uint64_t frames_consumed_reported_ = 0;
+  std::atomic<size_t> capture_pool_bytes_ = 0;
+  // Maintained by subclasses.
+  std::atomic<size_t> surface_bytes_ = 0;
+  FrameStats frame_stats_;
 
   FrameAvailableCallback frame_available_;
+  FrameArrivedCallback frame_arrived_;
+  // Set while Flutter has been signaled but hasn't requested the texture
+  // yet.
+  std::atomic<bool> frame_signal_pending_ = false;
   SurfaceSizeChangedCallback surface_size_changed_;
+  FpsGovernorDecisionCallback fps_governor_decision_changed_;
   std::atomic<bool> needs_update_ = false;
-  winrt::com_ptr<ID3D11Texture2D> last_frame_;
-  std::optional<std::chrono::high_resolution_clock::time_point>
-      last_frame_timestamp_;
+  FrameRing<CapturedFrame> frame_ring_;
 
   winrt::com_ptr<ABI::Windows::Graphics::Capture::IGraphicsCaptureItem>
       capture_item_;
   winrt::com_ptr<ABI::Windows::Graphics::Capture::IDirect3D11CaptureFramePool>
       frame_pool_;
+  std::unique_ptr<FrameSource<CapturedFrame>> frame_source_;
   winrt::com_ptr<ABI::Windows::Graphics::Capture::IGraphicsCaptureSession>
       capture_session_;
 
@@ -66,9 +231,38 @@ class TextureBridge {
 
   virtual void StopInternal();
   void OnFrameArrived();
-  bool ShouldDropFrame();
-
-  // corresponds to DXGI_FORMAT_B8G8R8A8_UNORM
-  static constexpr auto kPixelFormat = ABI::Windows::Graphics::DirectX::
-      DirectXPixelFormat::DirectXPixelFormat_B8G8R8A8UIntNormalized;
+  // Called on the capture thread, with |mutex_| held, for each visible frame
+  // published to |frame_ring_|.
+  virtual void OnFramePublished(ID3D11Texture2D* texture,
+                                uint64_t generation) {}
+  // Runs |task| right away if called on the platform thread, otherwise posts
+  // it there.
+  void RunOnPlatformThread(std::function<void()> task);
+  int32_t GetCapturePoolBufferCount() const;
+  void UpdateCapturePoolBytes(ABI::Windows::Graphics::SizeInt32 size);
+  void ApplyFpsLimit();
+  // Runs |EvaluateFpsGovernor| and reports a changed decision.
+  void UpdateFpsGovernor();
+  // Feeds the consumed frames to |fps_governor_| and applies its decision if
+  // it changed, which is returned. Requires |mutex_|.
+  bool EvaluateFpsGovernor();
+  // Calls |frame_available_| unless a previous signal is still pending.
+  void SignalFrameAvailable();
+  // Polls the held frames' fingerprints until all were read back and signals
+  // a frame if one of them changed.
+  void StartStaticFramePoll();
+  void PollStaticFrames();
+  // Records the held frames read back by now. Returns true if one of them
+  // changed, so that a frame needs to be signaled. Requires |mutex_|.
+  bool RecordHeldFrames();
+  // Called by the consumer before picking up the latest frame. Signals held
+  // back until now are covered by that frame.
+  void MarkSignalConsumed() {
+    frame_signal_pending_.exchange(false, std::memory_order_acq_rel);
+  }
+  // May be called from any thread.
+  std::optional<CopyRegionPlanner::Rect> GetVisibleRect();
+  void MarkFrameConsumed() {
+    frames_consumed_.fetch_add(1, std::memory_order_relaxed);
+  }
 };
@@ -2,19 +2,38 @@
 
 #include <iostream>
 
+#include "util/d3dutil.h"
 #include "util/direct3d11.interop.h"
 
+namespace {
+// Changes too subtle to alter a tile's average go unnoticed, so the whole
+// visible rect is copied at least this often.
+constexpr auto kFullCopyInterval = std::chrono::milliseconds(1000);
+}  // namespace
+
 TextureBridgeGpu::TextureBridgeGpu(
     GraphicsContext* graphics_context,
-    ABI::Windows::UI::Composition::IVisual* visual)
-    : TextureBridge(graphics_context, visual) {
+    ABI::Windows::UI::Composition::IVisual* visual, TaskRunner* task_runner,
+    const TextureBridgeOptions& options)
+    : TextureBridge(graphics_context, visual, task_runner, options),
+      surface_pool_(
+          [this](size_t width, size_t height) {
+            return AllocateSurface(width, height);
+          },
+          GetSurfacePoolConfig(pixel_format_)),
+      tile_fingerprinter_(graphics_context,
+                          GetFingerprinterConfig(pixel_format_)) {
   surface_descriptor_.struct_size = sizeof(FlutterDesktopGpuSurfaceDescriptor);
   surface_descriptor_.format =
       kFlutterDesktopPixelFormatNone;  // no format required for DXGI surfaces
+  surface_descriptor_.release_callback = [](void* release_context) {
+    auto texture = reinterpret_cast<ID3D11Texture2D*>(release_context);
+    texture->Release();
+  };
 }
 
 void TextureBridgeGpu::ProcessFrame(
-    winrt::com_ptr<ID3D11Texture2D> src_texture) {
+    winrt::com_ptr<ID3D11Texture2D> src_texture, uint64_t generation) {
   D3D11_TEXTURE2D_DESC desc;
   src_texture->GetDesc(&desc);
 
@@ -22,78 +41,238 @@ void TextureBridgeGpu::ProcessFrame(
   const auto height = desc.Height;
 
   EnsureSurface(width, height);
+  if (!surface_) {
+    return;
+  }
 
-  auto device_context = graphics_context_->d3d_device_context();
+  // Only the tiles which changed since the frame the surface holds need to
+  // be copied.
+  const auto copied_generation = copy_planner_.generation();
+  std::optional<TileChangeTracker::Changes> changes;
+  {
+    const std::lock_guard<std::mutex> lock(fingerprint_mutex_);
+    tile_fingerprinter_.ReadFinished();
+    changes = tile_fingerprinter_.tracker().GetChanges(copied_generation,
+                                                       generation);
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<CopyRegionPlanner::Rect> changed;
+  const bool is_partial = changes && now - last_full_copy_ < kFullCopyInterval;
+  if (generation != copied_generation) {
+    if (changes) {
+      frame_stats_.RecordTileDiff(changes->tile_count,
+                                  changes->changed_tile_count);
+    }
+    if (is_partial) {
+      changed.reserve(changes->rects.size());
+      for (const auto& rect : changes->rects) {
+        changed.push_back({static_cast<uint32_t>(rect.x),
+                           static_cast<uint32_t>(rect.y),
+                           static_cast<uint32_t>(rect.width),
+                           static_cast<uint32_t>(rect.height)});
+      }
+    } else {
+      last_full_copy_ = now;
+    }
 
-  device_context->CopyResource(surface_.get(), src_texture.get());
+    const std::lock_guard<std::mutex> lock(dirty_rects_mutex_);
+    if (changes) {
+      dirty_rects_ = std::move(changes->rects);
+    } else {
+      dirty_rects_.assign(1, {0, 0, width, height});
+    }
+  }
+
+  const auto regions = copy_planner_.Plan(generation, width, height,
+                                          is_partial ? &changed : nullptr);
+  if (regions.empty()) {
+    return;
+  }
+
+  // Regions are copied to the same position, the surface may be larger than
+  // the frame.
+  auto device_context = graphics_context_->d3d_device_context();
+  for (const auto& region : regions) {
+    const D3D11_BOX box = {region.x, region.y, 0, region.x + region.width,
+                           region.y + region.height, 1};
+    device_context->CopySubresourceRegion(surface_->surface.texture.get(), 0,
+                                          region.x, region.y, 0,
+                                          src_texture.get(), 0, &box);
+  }
   device_context->Flush();
 }
 
 void TextureBridgeGpu::EnsureSurface(uint32_t width, uint32_t height) {
-  if (!surface_ || surface_size_.width != width ||
-      surface_size_.height != height) {
-    D3D11_TEXTURE2D_DESC dstDesc = {};
-    dstDesc.ArraySize = 1;
-    dstDesc.MipLevels = 1;
-    dstDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
-    dstDesc.CPUAccessFlags = 0;
-    dstDesc.Format = static_cast<DXGI_FORMAT>(kPixelFormat);
-    dstDesc.Width = width;
-    dstDesc.Height = height;
-    dstDesc.MiscFlags = D3D11_RESOURCE_MISC_SHARED;
-    dstDesc.SampleDesc.Count = 1;
-    dstDesc.SampleDesc.Quality = 0;
-    dstDesc.Usage = D3D11_USAGE_DEFAULT;
-
-    surface_ = nullptr;
-    if (!SUCCEEDED(graphics_context_->d3d_device()->CreateTexture2D(
-            &dstDesc, nullptr, surface_.put()))) {
-      std::cerr << "Creating intermediate texture failed" << std::endl;
+  if (!surface_ || !surface_pool_.Fits(*surface_, width, height)) {
+    if (surface_) {
+      surface_pool_.Recycle(std::move(*surface_));
+    }
+
+    surface_ = surface_pool_.Acquire(width, height);
+    // A different surface holds none of the frame.
+    copy_planner_.Invalidate();
+    if (!surface_) {
       return;
     }
 
-    HANDLE shared_handle;
-    surface_.try_as(dxgi_surface_);
-    assert(dxgi_surface_);
-    dxgi_surface_->GetSharedHandle(&shared_handle);
-
-    surface_descriptor_.handle = shared_handle;
-    surface_descriptor_.width = surface_descriptor_.visible_width = width;
-    surface_descriptor_.height = surface_descriptor_.visible_height = height;
-    surface_descriptor_.release_context = surface_.get();
-    surface_descriptor_.release_callback = [](void* release_context) {
-      auto texture = reinterpret_cast<ID3D11Texture2D*>(release_context);
-      texture->Release();
-    };
-
-    surface_size_ = {width, height};
+    surface_descriptor_.handle = surface_->surface.shared_handle;
+    surface_descriptor_.width = surface_->width;
+    surface_descriptor_.height = surface_->height;
+    surface_descriptor_.release_context = surface_->surface.texture.get();
+    UpdateSurfaceBytes();
   }
+
+  surface_descriptor_.visible_width = width;
+  surface_descriptor_.visible_height = height;
+}
+
+TextureBridgeGpu::SharedSurfacePool::Config
+TextureBridgeGpu::GetSurfacePoolConfig(util::PixelFormat format) {
+  SharedSurfacePool::Config config;
+  config.bytes_per_pixel = util::BytesPerPixel(format);
+  return config;
+}
+
+GpuTileFingerprinter::Config TextureBridgeGpu::GetFingerprinterConfig(
+    util::PixelFormat format) {
+  GpuTileFingerprinter::Config config;
+  config.pixel_format = format;
+  return config;
+}
+
+std::optional<TextureBridgeGpu::SharedSurface>
+TextureBridgeGpu::AllocateSurface(size_t width, size_t height) {
+  D3D11_TEXTURE2D_DESC dstDesc = {};
+  dstDesc.ArraySize = 1;
+  dstDesc.MipLevels = 1;
+  dstDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+  dstDesc.CPUAccessFlags = 0;
+  dstDesc.Format = ToDxgiFormat(pixel_format_);
+  dstDesc.Width = static_cast<UINT>(width);
+  dstDesc.Height = static_cast<UINT>(height);
+  dstDesc.MiscFlags = D3D11_RESOURCE_MISC_SHARED;
+  dstDesc.SampleDesc.Count = 1;
+  dstDesc.SampleDesc.Quality = 0;
+  dstDesc.Usage = D3D11_USAGE_DEFAULT;
+
+  SharedSurface surface;
+  if (!SUCCEEDED(graphics_context_->d3d_device()->CreateTexture2D(
+          &dstDesc, nullptr, surface.texture.put()))) {
+    std::cerr << "Creating intermediate texture failed" << std::endl;
+    return std::nullopt;
+  }
+
+  auto dxgi_surface = surface.texture.try_as<IDXGIResource>();
+  assert(dxgi_surface);
+  if (!dxgi_surface ||
+      FAILED(dxgi_surface->GetSharedHandle(&surface.shared_handle))) {
+    std::cerr << "Retrieving the shared handle failed" << std::endl;
+    return std::nullopt;
+  }
+
+  return surface;
+}
+
+void TextureBridgeGpu::ReleaseSurfaces() {
+  if (surface_) {
+    surface_pool_.Recycle(std::move(*surface_));
+    surface_.reset();
+  }
+  surface_pool_.Clear();
+  UpdateSurfaceBytes();
+}
+
+void TextureBridgeGpu::UpdateSurfaceBytes() {
+  const auto& stats = surface_pool_.stats();
+  surface_bytes_.store(stats.bytes_in_use + stats.bytes_pooled,
+                       std::memory_order_relaxed);
+}
+
+size_t TextureBridgeGpu::TrimGpuMemory(GpuMemoryBudget::TrimLevel level) {
+  size_t freed = 0;
+  {
+    const std::lock_guard<std::mutex> lock(surface_mutex_);
+    const auto bytes_before = surface_bytes_.load(std::memory_order_relaxed);
+    if (level == GpuMemoryBudget::TrimLevel::kAll) {
+      // |GetSurfaceDescriptor| copies the latest frame into a new surface
+      // once the texture is shown again.
+      ReleaseSurfaces();
+    } else {
+      surface_pool_.Clear();
+      UpdateSurfaceBytes();
+    }
+    freed = bytes_before - surface_bytes_.load(std::memory_order_relaxed);
+  }
+  if (level == GpuMemoryBudget::TrimLevel::kAll) {
+    // Frames without fingerprints are copied as a whole.
+    const std::lock_guard<std::mutex> lock(fingerprint_mutex_);
+    freed += tile_fingerprinter_.ReleaseResources();
+  }
+  return freed + TextureBridge::TrimGpuMemory(level);
+}
+
+std::optional<std::vector<TileDiffer::Rect>>
+TextureBridgeGpu::GetDirtyRects() {
+  const std::lock_guard<std::mutex> lock(dirty_rects_mutex_);
+  return dirty_rects_;
 }
 
 const FlutterDesktopGpuSurfaceDescriptor*
 TextureBridgeGpu::GetSurfaceDescriptor(size_t width, size_t height) {
-  const std::lock_guard<std::mutex> lock(mutex_);
-
+  // Runs on the raster thread and must not block on the capture callback.
+  assert(raster_thread_checker_.IsCurrent());
   if (!is_running_) {
     return nullptr;
   }
 
-  if (last_frame_) {
-    ProcessFrame(last_frame_);
+  frame_stats_.RecordDescriptorRequest();
+  MarkSignalConsumed();
+  const std::lock_guard<std::mutex> lock(surface_mutex_);
+
+  if (surface_invalidated_.exchange(false)) {
+    ReleaseSurfaces();
   }
 
-  if (surface_) {
-    // Gets released in the SurfaceDescriptor's release callback.
-    surface_->AddRef();
+  copy_planner_.SetVisibleRect(GetVisibleRect());
+
+  // Flutter asks for the texture on every raster pass. Only copy if a newer
+  // frame arrived since the last one, the surface needs to be refilled or
+  // more of it became visible.
+  if (surface_ && frame_ring_.latest_generation() == copied_generation_ &&
+      copy_planner_.IsUpToDate()) {
+    frame_stats_.RecordCopySkipped();
+  } else if (const auto frame = frame_ring_.AcquireLatest()) {
+    // Copying newly exposed parts of the same frame doesn't consume a frame.
+    const bool is_new_frame = frame.generation() != copied_generation_;
+    ProcessFrame(frame->texture, frame.generation());
+    copied_generation_ = surface_ ? frame.generation() : 0;
+    if (is_new_frame && surface_) {
+      frame_stats_.RecordCopyMade(frame->arrival_time);
+      MarkFrameConsumed();
+    }
+  }
+
+  if (!surface_) {
+    return nullptr;
   }
 
+  // Gets released in the SurfaceDescriptor's release callback.
+  surface_->surface.texture->AddRef();
   return &surface_descriptor_;
 }
 
+void TextureBridgeGpu::OnFramePublished(ID3D11Texture2D* texture,
+                                        uint64_t generation) {
+  const std::lock_guard<std::mutex> lock(fingerprint_mutex_);
+  tile_fingerprinter_.Submit(texture, generation);
+}
+
 void TextureBridgeGpu::StopInternal() {
   TextureBridge::StopInternal();
 
   // For some reason, the destination surface needs to be recreated upon
-  // resuming. Force |EnsureSurface| to create a new one by resetting it here.
-  surface_ = nullptr;
+  // resuming. Force |EnsureSurface| to create a new one, rather than taking
+  // one from the pool, on the next call to |GetSurfaceDescriptor|.
+  surface_invalidated_ = true;
 }
@@ -2,25 +2,86 @@
 
 #include <flutter/texture_registrar.h>
 
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "gpu_tile_fingerprinter.h"
+#include "surface_pool.h"
 #include "texture_bridge.h"
 
 class TextureBridgeGpu : public TextureBridge {
  public:
   TextureBridgeGpu(GraphicsContext* graphics_context,
-                   ABI::Windows::UI::Composition::IVisual* visual);
+                   ABI::Windows::UI::Composition::IVisual* visual,
+                   TaskRunner* task_runner,
+                   const TextureBridgeOptions& options);
+
+  size_t GetGpuMemoryUsage() const override {
+    return TextureBridge::GetGpuMemoryUsage() +
+           tile_fingerprinter_.gpu_bytes();
+  }
+  // Releases pooled surfaces and, at |TrimLevel::kAll|, the current one and
+  // the tile fingerprints.
+  size_t TrimGpuMemory(GpuMemoryBudget::TrimLevel level) override;
+
+  // With a visible rect set, the parts of the frame outside it may be stale.
+  // The whole frame counts as dirty if its tile fingerprints weren't read
+  // back in time.
+  std::optional<std::vector<TileDiffer::Rect>> GetDirtyRects() override;
 
+  // Must be called on the raster thread.
   const FlutterDesktopGpuSurfaceDescriptor* GetSurfaceDescriptor(size_t width,
                                                                  size_t height);
 
  protected:
   void StopInternal() override;
+  void OnFramePublished(ID3D11Texture2D* texture,
+                        uint64_t generation) override;
 
  private:
+  struct SharedSurface {
+    winrt::com_ptr<ID3D11Texture2D> texture;
+    HANDLE shared_handle;
+  };
+  typedef SurfacePool<SharedSurface> SharedSurfacePool;
+
+  // Guards the surfaces against being trimmed while in use. Only contended
+  // while the memory budget trims this instance.
+  std::mutex surface_mutex_;
   FlutterDesktopGpuSurfaceDescriptor surface_descriptor_ = {};
-  Size surface_size_ = {0, 0};
-  winrt::com_ptr<ID3D11Texture2D> surface_{nullptr};
-  winrt::com_ptr<IDXGIResource> dxgi_surface_;
+  // Set on the platform thread to have the consumer recreate its surface.
+  std::atomic<bool> surface_invalidated_ = false;
+  // The generation of the frame |surface_| currently holds.
+  uint64_t copied_generation_ = 0;
+  // Only used on the raster thread.
+  SharedSurfacePool surface_pool_;
+  std::optional<SharedSurfacePool::Entry> surface_;
+  // Limits copies to the visible rect and the tiles that changed. Only used
+  // on the raster thread.
+  CopyRegionPlanner copy_planner_;
+  // When all of the visible rect of a new frame was last copied. Only used on
+  // the raster thread.
+  std::chrono::steady_clock::time_point last_full_copy_;
+
+  // Guards |tile_fingerprinter_|, which frames are submitted to on the
+  // capture thread and whose results are read on the raster thread.
+  std::mutex fingerprint_mutex_;
+  GpuTileFingerprinter tile_fingerprinter_;
+
+  std::mutex dirty_rects_mutex_;
+  std::vector<TileDiffer::Rect> dirty_rects_;
 
-  void ProcessFrame(winrt::com_ptr<ID3D11Texture2D> src_texture);
+  void ProcessFrame(winrt::com_ptr<ID3D11Texture2D> src_texture,
+                    uint64_t generation);
   void EnsureSurface(uint32_t width, uint32_t height);
+  static SharedSurfacePool::Config GetSurfacePoolConfig(
+      util::PixelFormat format);
+  static GpuTileFingerprinter::Config GetFingerprinterConfig(
+      util::PixelFormat format);
+  std::optional<SharedSurface> AllocateSurface(size_t width, size_t height);
+  // Drops the current surface and all pooled ones.
+  void ReleaseSurfaces();
+  void UpdateSurfaceBytes();
 };
@@ -0,0 +1,279 @@
+#include "texture_bridge_pixel_buffer.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "util/d3dutil.h"
+#include "util/pixel_format.h"
+
+namespace {
+// Flutter's pixel buffers are always RGBA8.
+constexpr auto kBufferFormat = util::PixelFormat::kRgba8;
+// |TileDiffer| hashes pixels of this size.
+constexpr size_t kTileDifferBytesPerPixel = 4;
+}  // namespace
+
+TextureBridgePixelBuffer::TextureBridgePixelBuffer(
+    GraphicsContext* graphics_context,
+    ABI::Windows::UI::Composition::IVisual* visual, TaskRunner* task_runner,
+    const TextureBridgeOptions& options)
+    : TextureBridge(graphics_context, visual, task_runner, options) {
+  // Flutter uploads the buffer after |CopyPixelBuffer| returned, so it stays
+  // locked until released.
+  pixel_buffer_.release_callback = [](void* release_context) {
+    auto mutex = reinterpret_cast<std::mutex*>(release_context);
+    mutex->unlock();
+  };
+  pixel_buffer_.release_context = &buffer_mutex_;
+}
+
+bool TextureBridgePixelBuffer::SubmitLatestFrame() {
+  // Keep the texture the buffer was converted from if possible.
+  StagingTexture* target = nullptr;
+  for (auto& staging : staging_textures_) {
+    if (!staging.pending && (!target || target == converted_staging_)) {
+      target = &staging;
+    }
+  }
+  // All copies are still in flight.
+  if (!target) {
+    return false;
+  }
+
+  const auto frame = frame_ring_.AcquireLatest();
+  if (!frame) {
+    return false;
+  }
+
+  D3D11_TEXTURE2D_DESC desc;
+  frame->texture->GetDesc(&desc);
+  if (!EnsureStagingTexture(*target, desc.Width, desc.Height)) {
+    return false;
+  }
+
+  auto device_context = graphics_context_->d3d_device_context();
+  device_context->CopyResource(target->texture.get(), frame->texture.get());
+  // Get the copy going so that it has finished by the next raster pass.
+  device_context->Flush();
+
+  if (converted_staging_ == target) {
+    converted_staging_ = nullptr;
+  }
+  target->generation = frame.generation();
+  target->pending = true;
+  submitted_generation_ = frame.generation();
+  frame_stats_.RecordCopyMade(frame->arrival_time);
+  MarkFrameConsumed();
+  return true;
+}
+
+bool TextureBridgePixelBuffer::ConvertFinishedFrame() {
+  // Newest first, an older copy is superseded once a newer one finished.
+  std::array<StagingTexture*, kStagingTextureCount> pending = {};
+  size_t pending_count = 0;
+  for (auto& staging : staging_textures_) {
+    if (staging.pending) {
+      pending[pending_count++] = &staging;
+    }
+  }
+  std::sort(pending.begin(), pending.begin() + pending_count,
+            [](const StagingTexture* a, const StagingTexture* b) {
+              return a->generation > b->generation;
+            });
+
+  auto device_context = graphics_context_->d3d_device_context();
+  for (size_t i = 0; i < pending_count; i++) {
+    auto& staging = *pending[i];
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    const auto hr =
+        device_context->Map(staging.texture.get(), 0, D3D11_MAP_READ,
+                            D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+      continue;
+    }
+
+    staging.pending = false;
+    if (FAILED(hr)) {
+      std::cerr << "Mapping the staging texture failed" << std::endl;
+      continue;
+    }
+
+    const bool converted = ConvertFrame(staging, mapped);
+    device_context->Unmap(staging.texture.get(), 0);
+    if (converted) {
+      converted_generation_ = staging.generation;
+      converted_staging_ = &staging;
+    }
+
+    for (size_t j = i + 1; j < pending_count; j++) {
+      pending[j]->pending = false;
+    }
+    return false;
+  }
+  return pending_count > 0;
+}
+
+bool TextureBridgePixelBuffer::ConvertFrame(
+    StagingTexture& staging, const D3D11_MAPPED_SUBRESOURCE& mapped) {
+  const auto width = static_cast<uint32_t>(staging.size.width);
+  const auto height = static_cast<uint32_t>(staging.size.height);
+
+  // Tiles which didn't change since the previous frame can only be kept if
+  // the buffer still holds it.
+  if (!pixel_buffer_.buffer || pixel_buffer_.width != width ||
+      pixel_buffer_.height != height) {
+    tile_differ_.Reset();
+  }
+
+  // Flutter expects tightly packed rows.
+  const auto stride = util::RowBytes(kBufferFormat, width);
+  auto buffer = buffer_.Resize(stride * height);
+  if (!buffer) {
+    pixel_buffer_.buffer = nullptr;
+    return false;
+  }
+
+  const auto src = static_cast<const uint8_t*>(mapped.pData);
+  const auto src_bytes_per_pixel = util::BytesPerPixel(pixel_format_);
+  const auto dst_bytes_per_pixel = util::BytesPerPixel(kBufferFormat);
+
+  // Wider pixels are diffed as several narrow ones. Tile boundaries are
+  // multiples of the tile size, so rects map back to whole pixels.
+  const auto units_per_pixel = src_bytes_per_pixel / kTileDifferBytesPerPixel;
+  auto rects = tile_differ_.Update(src, mapped.RowPitch,
+                                   width * units_per_pixel, height);
+  for (auto& rect : rects) {
+    rect.x /= units_per_pixel;
+    rect.width /= units_per_pixel;
+    util::ConvertPixels(
+        pixel_format_,
+        src + rect.y * mapped.RowPitch + rect.x * src_bytes_per_pixel,
+        mapped.RowPitch, kBufferFormat,
+        buffer + rect.y * stride + rect.x * dst_bytes_per_pixel, stride,
+        rect.width, rect.height);
+  }
+  frame_stats_.RecordTileDiff(tile_differ_.rows() * tile_differ_.columns(),
+                              tile_differ_.dirty_tile_count());
+  {
+    const std::lock_guard<std::mutex> lock(dirty_rects_mutex_);
+    dirty_rects_ = rects;
+  }
+
+  pixel_buffer_.buffer = buffer;
+  pixel_buffer_.width = width;
+  pixel_buffer_.height = height;
+  return true;
+}
+
+bool TextureBridgePixelBuffer::EnsureStagingTexture(StagingTexture& staging,
+                                                    uint32_t width,
+                                                    uint32_t height) {
+  if (staging.texture && staging.size.width == width &&
+      staging.size.height == height) {
+    return true;
+  }
+
+  D3D11_TEXTURE2D_DESC desc = {};
+  desc.ArraySize = 1;
+  desc.MipLevels = 1;
+  desc.BindFlags = 0;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+  desc.Format = ToDxgiFormat(pixel_format_);
+  desc.Width = width;
+  desc.Height = height;
+  desc.MiscFlags = 0;
+  desc.SampleDesc.Count = 1;
+  desc.SampleDesc.Quality = 0;
+  desc.Usage = D3D11_USAGE_STAGING;
+
+  staging = {};
+  UpdateSurfaceBytes();
+  if (FAILED(graphics_context_->d3d_device()->CreateTexture2D(
+          &desc, nullptr, staging.texture.put()))) {
+    std::cerr << "Creating staging texture failed" << std::endl;
+    return false;
+  }
+
+  staging.size = {width, height};
+  UpdateSurfaceBytes();
+  return true;
+}
+
+void TextureBridgePixelBuffer::UpdateSurfaceBytes() {
+  size_t bytes = 0;
+  for (const auto& staging : staging_textures_) {
+    if (staging.texture) {
+      bytes += util::ImageBytes(pixel_format_, staging.size.width,
+                                staging.size.height);
+    }
+  }
+  surface_bytes_ = bytes;
+}
+
+size_t TextureBridgePixelBuffer::ReleaseBuffers() {
+  staging_textures_ = {};
+  converted_staging_ = nullptr;
+  buffer_.Release();
+  pixel_buffer_.buffer = nullptr;
+  converted_generation_ = 0;
+  submitted_generation_ = 0;
+  return surface_bytes_.exchange(0);
+}
+
+std::optional<std::vector<TileDiffer::Rect>>
+TextureBridgePixelBuffer::GetDirtyRects() {
+  const std::lock_guard<std::mutex> lock(dirty_rects_mutex_);
+  return dirty_rects_;
+}
+
+size_t TextureBridgePixelBuffer::TrimGpuMemory(
+    GpuMemoryBudget::TrimLevel level) {
+  size_t freed = 0;
+  if (level == GpuMemoryBudget::TrimLevel::kAll) {
+    const std::lock_guard<std::mutex> lock(buffer_mutex_);
+    // |CopyPixelBuffer| converts the latest frame again once the texture is
+    // shown again.
+    freed = ReleaseBuffers();
+  }
+  return freed + TextureBridge::TrimGpuMemory(level);
+}
+
+const FlutterDesktopPixelBuffer* TextureBridgePixelBuffer::CopyPixelBuffer(
+    size_t width, size_t height) {
+  // Runs on the raster thread and must not block on the capture callback.
+  assert(raster_thread_checker_.IsCurrent());
+  if (!is_running_) {
+    return nullptr;
+  }
+
+  frame_stats_.RecordDescriptorRequest();
+  MarkSignalConsumed();
+  std::unique_lock<std::mutex> lock(buffer_mutex_);
+
+  // Converting first frees a staging texture for the new copy.
+  bool is_pending = ConvertFinishedFrame();
+
+  // Flutter asks for the buffer on every raster pass. Only copy if a newer
+  // frame arrived since the last one.
+  if (frame_ring_.latest_generation() == submitted_generation_) {
+    frame_stats_.RecordCopySkipped();
+  } else {
+    // If all staging textures are in flight, the copy is retried once the
+    // pending ones converted.
+    is_pending |= SubmitLatestFrame();
+  }
+
+  // Hand out the previous buffer while the copy is in flight, and have
+  // Flutter come back for the new one.
+  if (is_pending) {
+    RunOnPlatformThread([this]() { SignalFrameAvailable(); });
+  }
+
+  if (!pixel_buffer_.buffer) {
+    return nullptr;
+  }
+
+  // Gets unlocked in the pixel buffer's release callback.
+  lock.release();
+  return &pixel_buffer_;
+}
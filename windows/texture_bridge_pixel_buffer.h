@@ -0,0 +1,80 @@
+#pragma once
+
+#include <flutter/texture_registrar.h>
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "texture_bridge.h"
+#include "tile_differ.h"
+#include "util/aligned_buffer.h"
+
+// Hands frames to Flutter as RGBA pixel buffers in system memory.
+//
+// Slower than |TextureBridgeGpu|, but works on systems where Flutter can't
+// open DXGI shared handles.
+//
+// Frames are copied into alternating staging textures, which are only
+// mapped once the GPU finished the copy. Until then, Flutter keeps getting
+// the previously converted buffer and is asked for another frame, so the
+// raster thread never waits for the GPU.
+class TextureBridgePixelBuffer : public TextureBridge {
+ public:
+  TextureBridgePixelBuffer(GraphicsContext* graphics_context,
+                           ABI::Windows::UI::Composition::IVisual* visual,
+                           TaskRunner* task_runner,
+                           const TextureBridgeOptions& options);
+
+  // Releases the staging textures and pixel buffer at |TrimLevel::kAll|.
+  size_t TrimGpuMemory(GpuMemoryBudget::TrimLevel level) override;
+
+  std::optional<std::vector<TileDiffer::Rect>> GetDirtyRects() override;
+
+  // Must be called on the raster thread.
+  const FlutterDesktopPixelBuffer* CopyPixelBuffer(size_t width,
+                                                   size_t height);
+
+ private:
+  struct StagingTexture {
+    winrt::com_ptr<ID3D11Texture2D> texture;
+    Size size = {0, 0};
+    // The generation of the frame copied in, 0 if none.
+    uint64_t generation = 0;
+    // Set while the copy hasn't been mapped yet.
+    bool pending = false;
+  };
+
+  static constexpr size_t kStagingTextureCount = 2;
+
+  // Guards the buffers against being trimmed while in use. Held from
+  // |CopyPixelBuffer| until Flutter releases the pixel buffer.
+  std::mutex buffer_mutex_;
+  FlutterDesktopPixelBuffer pixel_buffer_ = {};
+  // The generation of the frame |pixel_buffer_| currently holds, 0 if none.
+  uint64_t converted_generation_ = 0;
+  // The generation of the frame last copied into a staging texture.
+  uint64_t submitted_generation_ = 0;
+  std::array<StagingTexture, kStagingTextureCount> staging_textures_;
+  // The staging texture |pixel_buffer_| was converted from.
+  StagingTexture* converted_staging_ = nullptr;
+  util::AlignedBuffer buffer_;
+  // Limits the conversion to the tiles which changed.
+  TileDiffer tile_differ_;
+
+  std::mutex dirty_rects_mutex_;
+  std::vector<TileDiffer::Rect> dirty_rects_;
+
+  // Starts copying the latest frame into a staging texture which isn't in
+  // flight. Returns false if there was no frame to copy.
+  bool SubmitLatestFrame();
+  // Converts the newest staging texture whose copy finished, without
+  // waiting for pending ones. Returns true if any copy is still pending.
+  bool ConvertFinishedFrame();
+  bool ConvertFrame(StagingTexture& staging,
+                    const D3D11_MAPPED_SUBRESOURCE& mapped);
+  bool EnsureStagingTexture(StagingTexture& staging, uint32_t width,
+                            uint32_t height);
+  void UpdateSurfaceBytes();
+  size_t ReleaseBuffers();
+};
@@ -0,0 +1,70 @@
+#include "tile_change_tracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+void TileChangeTracker::Add(uint64_t generation, size_t width, size_t height,
+                            const uint8_t* fingerprints, size_t stride,
+                            size_t bytes_per_fingerprint) {
+  const auto tile_size = config_.tile_size;
+  const bool restart = latest_generation_ == 0 ||
+                       generation != latest_generation_ + 1 ||
+                       width != width_ || height != height_;
+  if (restart) {
+    first_generation_ = generation;
+    width_ = width;
+    height_ = height;
+    columns_ = (width + tile_size - 1) / tile_size;
+    rows_ = (height + tile_size - 1) / tile_size;
+    fingerprints_.assign(columns_ * rows_, 0);
+    changed_in_.assign(columns_ * rows_, generation);
+  }
+  latest_generation_ = generation;
+
+  bytes_per_fingerprint = std::min(bytes_per_fingerprint, sizeof(uint64_t));
+  for (size_t row = 0; row < rows_; row++) {
+    const auto src = fingerprints + row * stride;
+    for (size_t column = 0; column < columns_; column++) {
+      uint64_t fingerprint = 0;
+      std::memcpy(&fingerprint, src + column * bytes_per_fingerprint,
+                  bytes_per_fingerprint);
+
+      const auto index = row * columns_ + column;
+      if (fingerprints_[index] != fingerprint) {
+        fingerprints_[index] = fingerprint;
+        if (!restart) {
+          changed_in_[index] = generation;
+        }
+      }
+    }
+  }
+}
+
+std::optional<TileChangeTracker::Changes> TileChangeTracker::GetChanges(
+    uint64_t since, uint64_t generation) const {
+  if (since < first_generation_ || since > generation ||
+      generation > latest_generation_) {
+    return std::nullopt;
+  }
+
+  // Tiles last changed up to |since| stayed the same until
+  // |latest_generation_|, and thus until |generation|.
+  std::vector<bool> changed(changed_in_.size());
+  size_t changed_tile_count = 0;
+  for (size_t i = 0; i < changed_in_.size(); i++) {
+    changed[i] = changed_in_[i] > since;
+    changed_tile_count += changed[i];
+  }
+
+  Changes changes = {{}, changed.size(), changed_tile_count};
+  TileDiffer::MergeTiles(changed, columns_, rows_, config_, width_, height_,
+                         &changes.rects);
+  return changes;
+}
+
+void TileChangeTracker::Reset() {
+  first_generation_ = 0;
+  latest_generation_ = 0;
+  width_ = 0;
+  height_ = 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "tile_differ.h"
+
+// Tracks which tiles of consecutive frames changed, given a fingerprint per
+// tile and frame, e.g. the tile averages computed by |GpuTileFingerprinter|.
+//
+// For each tile, the generation of the frame it last changed in is kept, so
+// that the changes between any two frames since the fingerprints started
+// can be told, not just those between consecutive ones. Fingerprints have to
+// be added in generation order. A skipped generation, like a resize, counts
+// as a change of every tile, since whatever happened in between is unknown.
+//
+// Not thread-safe.
+class TileChangeTracker {
+ public:
+  typedef TileDiffer::Config Config;
+  typedef TileDiffer::Rect Rect;
+
+  struct Changes {
+    // In pixels, covering all changed tiles.
+    std::vector<Rect> rects;
+    size_t tile_count;
+    size_t changed_tile_count;
+  };
+
+  explicit TileChangeTracker(const Config& config) : config_(config) {}
+  TileChangeTracker() : TileChangeTracker(Config{}) {}
+
+  // Adds the fingerprints of the |width| x |height| frame |generation|: one
+  // per tile, |bytes_per_fingerprint| bytes each, in rows of |stride| bytes.
+  void Add(uint64_t generation, size_t width, size_t height,
+           const uint8_t* fingerprints, size_t stride,
+           size_t bytes_per_fingerprint);
+
+  // Returns the changes between the frames |since| and |generation|, or
+  // std::nullopt if they aren't known, e.g. because the fingerprints of
+  // |generation| weren't added yet. May cover changes made after
+  // |generation|.
+  std::optional<Changes> GetChanges(uint64_t since, uint64_t generation) const;
+
+  // Forgets all frames.
+  void Reset();
+
+  // The newest frame added, 0 if none.
+  uint64_t latest_generation() const { return latest_generation_; }
+  const Config& config() const { return config_; }
+
+ private:
+  Config config_;
+  // The first frame of the current run of consecutive generations.
+  uint64_t first_generation_ = 0;
+  uint64_t latest_generation_ = 0;
+  size_t width_ = 0;
+  size_t height_ = 0;
+  size_t columns_ = 0;
+  size_t rows_ = 0;
+  // Indexed by row * |columns_| + column.
+  std::vector<uint64_t> fingerprints_;
+  std::vector<uint64_t> changed_in_;
+};
@@ -0,0 +1,325 @@
+#include "tile_differ.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/cpu_features.h"
+
+#ifdef UTIL_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// The hash keeps 16 32-bit lanes, each fed every 16th pixel of a row. A round
+// is xxHash32's minus its first multiply: every step is invertible, so a
+// single changed pixel always changes its lane. Independent lanes hide the
+// multiply latency. All kernels compute the same value.
+constexpr size_t kLanes = 16;
+constexpr uint32_t kPrime1 = 2654435761u;
+constexpr uint32_t kPrime3 = 3266489917u;
+constexpr uint64_t kFinalPrime = 0x100000001b3ull;
+
+struct Lanes {
+  uint32_t values[kLanes];
+};
+
+Lanes InitialLanes() {
+  Lanes lanes;
+  for (size_t i = 0; i < kLanes; i++) {
+    lanes.values[i] = kPrime3 * static_cast<uint32_t>(i + 1);
+  }
+  return lanes;
+}
+
+uint32_t Round(uint32_t acc, uint32_t value) {
+  acc += value;
+  acc = (acc << 13) | (acc >> 19);
+  return acc * kPrime1;
+}
+
+// Feeds |count| pixels starting at lane 0.
+void HashPixelsScalar(Lanes& lanes, const uint8_t* pixels, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    uint32_t value;
+    std::memcpy(&value, pixels + i * 4, sizeof(value));
+    auto& lane = lanes.values[i % kLanes];
+    lane = Round(lane, value);
+  }
+}
+
+uint64_t Finalize(const Lanes& lanes) {
+  uint64_t hash = 0;
+  for (size_t i = 0; i < kLanes; i++) {
+    hash = (hash ^ lanes.values[i]) * kFinalPrime;
+  }
+  return hash ^ (hash >> 29);
+}
+
+uint64_t HashTileScalar(const uint8_t* pixels, size_t stride, size_t width,
+                        size_t height) {
+  auto lanes = InitialLanes();
+  for (size_t y = 0; y < height; y++) {
+    HashPixelsScalar(lanes, pixels + y * stride, width);
+  }
+  return Finalize(lanes);
+}
+
+#ifdef UTIL_ARCH_X86
+
+// SSE2 has no 32-bit multiply keeping the low halves, so emulate it with two
+// 32x32->64 multiplies.
+__m128i MultiplyLow(__m128i a, __m128i b) {
+  const auto even = _mm_mul_epu32(a, b);
+  const auto odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+__m128i RoundSse2(__m128i acc, __m128i value, __m128i prime1) {
+  acc = _mm_add_epi32(acc, value);
+  acc = _mm_or_si128(_mm_slli_epi32(acc, 13), _mm_srli_epi32(acc, 19));
+  return MultiplyLow(acc, prime1);
+}
+
+uint64_t HashTileSse2(const uint8_t* pixels, size_t stride, size_t width,
+                      size_t height) {
+  constexpr size_t kVectors = kLanes / 4;
+  const auto prime1 = _mm_set1_epi32(static_cast<int>(kPrime1));
+  const auto full = width / kLanes * kLanes;
+
+  auto lanes = InitialLanes();
+  __m128i acc[kVectors];
+  for (size_t i = 0; i < kVectors; i++) {
+    acc[i] =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.values) + i);
+  }
+  for (size_t y = 0; y < height; y++) {
+    const auto row = pixels + y * stride;
+    for (size_t x = 0; x < full; x += kLanes) {
+      const auto values = reinterpret_cast<const __m128i*>(row + x * 4);
+      for (size_t i = 0; i < kVectors; i++) {
+        acc[i] = RoundSse2(acc[i], _mm_loadu_si128(values + i), prime1);
+      }
+    }
+    if (full < width) {
+      for (size_t i = 0; i < kVectors; i++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.values) + i, acc[i]);
+      }
+      HashPixelsScalar(lanes, row + full * 4, width - full);
+      for (size_t i = 0; i < kVectors; i++) {
+        acc[i] =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.values) + i);
+      }
+    }
+  }
+  for (size_t i = 0; i < kVectors; i++) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.values) + i, acc[i]);
+  }
+  return Finalize(lanes);
+}
+
+UTIL_TARGET_AVX2 __m256i RoundAvx2(__m256i acc, __m256i value,
+                                   __m256i prime1) {
+  acc = _mm256_add_epi32(acc, value);
+  acc = _mm256_or_si256(_mm256_slli_epi32(acc, 13), _mm256_srli_epi32(acc, 19));
+  return _mm256_mullo_epi32(acc, prime1);
+}
+
+UTIL_TARGET_AVX2 uint64_t HashTileAvx2(const uint8_t* pixels, size_t stride,
+                                       size_t width, size_t height) {
+  const auto prime1 = _mm256_set1_epi32(static_cast<int>(kPrime1));
+  const auto full = width / kLanes * kLanes;
+
+  auto lanes = InitialLanes();
+  const auto lane_values = reinterpret_cast<__m256i*>(lanes.values);
+  auto low = _mm256_loadu_si256(lane_values);
+  auto high = _mm256_loadu_si256(lane_values + 1);
+  for (size_t y = 0; y < height; y++) {
+    const auto row = pixels + y * stride;
+    for (size_t x = 0; x < full; x += kLanes) {
+      const auto values = reinterpret_cast<const __m256i*>(row + x * 4);
+      low = RoundAvx2(low, _mm256_loadu_si256(values), prime1);
+      high = RoundAvx2(high, _mm256_loadu_si256(values + 1), prime1);
+    }
+    if (full < width) {
+      _mm256_storeu_si256(lane_values, low);
+      _mm256_storeu_si256(lane_values + 1, high);
+      HashPixelsScalar(lanes, row + full * 4, width - full);
+      low = _mm256_loadu_si256(lane_values);
+      high = _mm256_loadu_si256(lane_values + 1);
+    }
+  }
+  _mm256_storeu_si256(lane_values, low);
+  _mm256_storeu_si256(lane_values + 1, high);
+  return Finalize(lanes);
+}
+
+#endif  // UTIL_ARCH_X86
+
+}  // namespace
+
+TileDiffer::TileDiffer(const Config& config) : config_(config) {
+  config_.tile_size = std::max<size_t>(config_.tile_size, 1);
+  config_.max_rects = std::max<size_t>(config_.max_rects, 1);
+  SetHashKernel(GetBestHashKernel());
+}
+
+TileDiffer::HashKernel TileDiffer::GetBestHashKernel() {
+#ifdef UTIL_ARCH_X86
+  return util::CpuSupportsAvx2() ? HashKernel::kAvx2 : HashKernel::kSse2;
+#else
+  return HashKernel::kScalar;
+#endif
+}
+
+bool TileDiffer::SetHashKernel(HashKernel kernel) {
+  switch (kernel) {
+    case HashKernel::kScalar:
+      hash_ = HashTileScalar;
+      return true;
+#ifdef UTIL_ARCH_X86
+    case HashKernel::kSse2:
+      hash_ = HashTileSse2;
+      return true;
+    case HashKernel::kAvx2:
+      if (!util::CpuSupportsAvx2()) {
+        return false;
+      }
+      hash_ = HashTileAvx2;
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+uint64_t TileDiffer::Hash(const uint8_t* pixels, size_t stride, size_t width,
+                          size_t height) {
+  static const HashFunction hash = []() {
+    TileDiffer differ;
+    return differ.hash_;
+  }();
+  return hash(pixels, stride, width, height);
+}
+
+void TileDiffer::Reset() {
+  width_ = 0;
+  height_ = 0;
+  hashes_.clear();
+}
+
+const std::vector<TileDiffer::Rect>& TileDiffer::Update(const uint8_t* pixels,
+                                                        size_t stride,
+                                                        size_t width,
+                                                        size_t height) {
+  const auto tile_size = config_.tile_size;
+  const bool resized = width != width_ || height != height_;
+  if (resized) {
+    width_ = width;
+    height_ = height;
+    columns_ = (width + tile_size - 1) / tile_size;
+    rows_ = (height + tile_size - 1) / tile_size;
+    hashes_.assign(columns_ * rows_, 0);
+    dirty_.assign(columns_ * rows_, true);
+  }
+
+  dirty_tile_count_ = 0;
+  for (size_t row = 0; row < rows_; row++) {
+    const auto y = row * tile_size;
+    const auto tile_height = std::min(tile_size, height - y);
+    for (size_t column = 0; column < columns_; column++) {
+      const auto x = column * tile_size;
+      const auto tile_width = std::min(tile_size, width - x);
+      const auto hash =
+          hash_(pixels + y * stride + x * 4, stride, tile_width, tile_height);
+
+      const auto index = row * columns_ + column;
+      const bool dirty = resized || hashes_[index] != hash;
+      hashes_[index] = hash;
+      dirty_[index] = dirty;
+      if (dirty) {
+        dirty_tile_count_++;
+      }
+    }
+  }
+
+  stats_.frames++;
+  stats_.tiles_checked += columns_ * rows_;
+  stats_.tiles_dirty += dirty_tile_count_;
+
+  MergeTiles(dirty_, columns_, rows_, config_, width_, height_, &dirty_rects_);
+  return dirty_rects_;
+}
+
+void TileDiffer::MergeTiles(const std::vector<bool>& dirty, size_t columns,
+                            size_t rows, const Config& config, size_t width,
+                            size_t height, std::vector<Rect>* rects) {
+  auto& dirty_rects = *rects;
+  dirty_rects.clear();
+
+  // Merge runs of dirty tiles within a row, then stack runs spanning the same
+  // columns in consecutive rows. Works in tile units until the end.
+  size_t open_begin = 0;
+  for (size_t row = 0; row < rows; row++) {
+    const auto open_end = dirty_rects.size();
+    auto candidate = open_begin;
+
+    size_t column = 0;
+    while (column < columns) {
+      if (!dirty[row * columns + column]) {
+        column++;
+        continue;
+      }
+      const auto start = column;
+      while (column < columns && dirty[row * columns + column]) {
+        column++;
+      }
+
+      // Runs of the previous row are sorted by column as well.
+      while (candidate < open_end && dirty_rects[candidate].x < start) {
+        candidate++;
+      }
+      if (candidate < open_end && dirty_rects[candidate].x == start &&
+          dirty_rects[candidate].width == column - start) {
+        dirty_rects[candidate].height++;
+        // Keep it open for the next row by moving it behind |open_end|.
+        dirty_rects.push_back(dirty_rects[candidate]);
+        dirty_rects[candidate].height = 0;
+        candidate++;
+      } else {
+        dirty_rects.push_back({start, row, column - start, 1});
+      }
+    }
+    open_begin = open_end;
+  }
+
+  // Drop the husks left behind by rects moved to the next row.
+  dirty_rects.erase(
+      std::remove_if(dirty_rects.begin(), dirty_rects.end(),
+                     [](const Rect& rect) { return rect.height == 0; }),
+      dirty_rects.end());
+
+  if (dirty_rects.size() > config.max_rects) {
+    auto bounds = dirty_rects.front();
+    auto right = bounds.x + bounds.width;
+    auto bottom = bounds.y + bounds.height;
+    for (const auto& rect : dirty_rects) {
+      bounds.x = std::min(bounds.x, rect.x);
+      bounds.y = std::min(bounds.y, rect.y);
+      right = std::max(right, rect.x + rect.width);
+      bottom = std::max(bottom, rect.y + rect.height);
+    }
+    bounds.width = right - bounds.x;
+    bounds.height = bottom - bounds.y;
+    dirty_rects.assign(1, bounds);
+  }
+
+  const auto tile_size = config.tile_size;
+  for (auto& rect : dirty_rects) {
+    rect.x *= tile_size;
+    rect.y *= tile_size;
+    rect.width = std::min(rect.width * tile_size, width - rect.x);
+    rect.height = std::min(rect.height * tile_size, height - rect.y);
+  }
+}
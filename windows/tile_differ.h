@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Detects which parts of a BGRA frame changed since the previous one.
+//
+// Frames are divided into square tiles whose contents are hashed. Tiles
+// whose hash differs from the previous frame's are dirty and get merged into
+// as few rectangles as possible. Only the hashes are kept, not the previous
+// frame itself.
+//
+// Not thread-safe.
+class TileDiffer {
+ public:
+  struct Rect {
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+  };
+
+  enum class HashKernel { kScalar, kSse2, kAvx2 };
+
+  struct Config {
+    size_t tile_size = 64;
+    // If more rectangles are needed to cover the dirty tiles, their bounding
+    // box is reported instead.
+    size_t max_rects = 16;
+  };
+
+  struct Stats {
+    uint64_t frames;
+    uint64_t tiles_checked;
+    uint64_t tiles_dirty;
+  };
+
+  explicit TileDiffer(const Config& config);
+  TileDiffer() : TileDiffer(Config{}) {}
+
+  // Hashes |pixels| and returns the dirty rectangles. Everything is dirty on
+  // the first frame, after |Reset| and whenever the frame size changes.
+  const std::vector<Rect>& Update(const uint8_t* pixels, size_t stride,
+                                  size_t width, size_t height);
+
+  // Forgets the previous frame.
+  void Reset();
+
+  // Hashes a BGRA image the same way tiles are hashed, using the best kernel.
+  static uint64_t Hash(const uint8_t* pixels, size_t stride, size_t width,
+                       size_t height);
+
+  // Merges the tiles set in |dirty|, a |columns| x |rows| grid indexed by
+  // row * |columns| + column, into rects in pixels of a |width| x |height|
+  // frame divided into |config|'s tiles. Used by |Update|.
+  static void MergeTiles(const std::vector<bool>& dirty, size_t columns,
+                         size_t rows, const Config& config, size_t width,
+                         size_t height, std::vector<Rect>* rects);
+
+  // Returns false if the CPU doesn't support |kernel|.
+  bool SetHashKernel(HashKernel kernel);
+  static HashKernel GetBestHashKernel();
+
+  // The result of the last |Update|.
+  const std::vector<Rect>& dirty_rects() const { return dirty_rects_; }
+  size_t dirty_tile_count() const { return dirty_tile_count_; }
+  size_t columns() const { return columns_; }
+  size_t rows() const { return rows_; }
+  const Config& config() const { return config_; }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  typedef uint64_t (*HashFunction)(const uint8_t* pixels, size_t stride,
+                                   size_t width, size_t height);
+
+  Config config_;
+  HashFunction hash_;
+  size_t width_ = 0;
+  size_t height_ = 0;
+  size_t columns_ = 0;
+  size_t rows_ = 0;
+  // Indexed by row * |columns_| + column.
+  std::vector<uint64_t> hashes_;
+  std::vector<bool> dirty_;
+  size_t dirty_tile_count_ = 0;
+  std::vector<Rect> dirty_rects_;
+  Stats stats_ = {};
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace util {
+
+// A heap buffer aligned for vector loads and stores. It's only reallocated
+// when it needs to grow, so it can be reused for frames of varying size.
+class AlignedBuffer {
+ public:
+  static constexpr size_t kAlignment = 64;
+
+  AlignedBuffer() = default;
+  ~AlignedBuffer() { Release(); }
+
+  AlignedBuffer(AlignedBuffer&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)) {}
+  AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+    if (this != &other) {
+      Release();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      capacity_ = std::exchange(other.capacity_, 0);
+    }
+    return *this;
+  }
+
+  AlignedBuffer(const AlignedBuffer&) = delete;
+  AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+  // Sets the size to |size| bytes. The contents are undefined if the buffer
+  // had to grow. Returns nullptr if the allocation failed.
+  uint8_t* Resize(size_t size) {
+    if (size > capacity_) {
+      Release();
+      data_ = static_cast<uint8_t*>(::operator new(
+          size, std::align_val_t(kAlignment), std::nothrow));
+      if (!data_) {
+        return nullptr;
+      }
+      capacity_ = size;
+    }
+    size_ = size;
+    return data_;
+  }
+
+  void Release() {
+    if (data_) {
+      ::operator delete(data_, std::align_val_t(kAlignment));
+      data_ = nullptr;
+    }
+    size_ = 0;
+    capacity_ = 0;
+  }
+
+  uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+}  // namespace util
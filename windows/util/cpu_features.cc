@@ -0,0 +1,46 @@
+#include "cpu_features.h"
+
+#if defined(UTIL_ARCH_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace util {
+
+namespace {
+
+bool DetectAvx2() {
+#if !defined(UTIL_ARCH_X86)
+  return false;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+
+  // The OS must save the YMM registers on context switches.
+  __cpuid(info, 1);
+  constexpr int kOsxsave = 1 << 27;
+  constexpr int kAvx = 1 << 28;
+  if ((info[2] & kOsxsave) == 0 || (info[2] & kAvx) == 0 ||
+      (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  constexpr int kAvx2 = 1 << 5;
+  return (info[1] & kAvx2) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+}  // namespace
+
+bool CpuSupportsAvx2() {
+  static const bool supported = DetectAvx2();
+  return supported;
+}
+
+}  // namespace util
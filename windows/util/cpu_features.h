@@ -0,0 +1,22 @@
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || \
+    defined(__i386__)
+#define UTIL_ARCH_X86 1
+#endif
+
+// MSVC allows using intrinsics of any instruction set, other compilers need
+// them enabled per function.
+#if defined(UTIL_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define UTIL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define UTIL_TARGET_AVX2
+#endif
+
+namespace util {
+
+// SSE2 is part of the x86 baseline we build for, so only AVX2 needs a
+// runtime check. Always false on other architectures.
+bool CpuSupportsAvx2();
+
+}  // namespace util
@@ -4,6 +4,8 @@
 #include <winrt/Windows.Foundation.h>
 #include <winrt/Windows.System.h>
 
+#include "pixel_format.h"
+
 inline auto CreateD3DDevice(D3D_DRIVER_TYPE const type,
                             winrt::com_ptr<ID3D11Device>& device) {
   WINRT_ASSERT(!device);
@@ -29,3 +31,15 @@ inline auto CreateD3DDevice() {
 
   return device;
 }
+
+// DirectXPixelFormat shares its values with DXGI_FORMAT.
+inline DXGI_FORMAT ToDxgiFormat(util::PixelFormat format) {
+  switch (format) {
+    case util::PixelFormat::kRgba8:
+      return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case util::PixelFormat::kRgba16Float:
+      return DXGI_FORMAT_R16G16B16A16_FLOAT;
+    default:
+      return DXGI_FORMAT_B8G8R8A8_UNORM;
+  }
+}
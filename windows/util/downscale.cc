@@ -0,0 +1,256 @@
+#include "downscale.h"
+
+#include <algorithm>
+
+#include "cpu_features.h"
+
+#ifdef UTIL_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace util {
+
+namespace {
+
+constexpr size_t kBytesPerPixel = 4;
+
+typedef void (*HalveRowKernel)(const uint8_t* top, const uint8_t* bottom,
+                               uint8_t* dst, size_t dst_width);
+
+// Rounds up like _mm_avg_epu8 so that all kernels agree.
+uint8_t Average(uint8_t a, uint8_t b) {
+  return static_cast<uint8_t>((a + b + 1) >> 1);
+}
+
+// Averages 2x2 blocks: first vertically, then horizontally.
+void HalveRowScalar(const uint8_t* top, const uint8_t* bottom, uint8_t* dst,
+                    size_t dst_width) {
+  for (size_t x = 0; x < dst_width; x++) {
+    for (size_t c = 0; c < kBytesPerPixel; c++) {
+      const auto left = Average(top[c], bottom[c]);
+      const auto right = Average(top[c + 4], bottom[c + 4]);
+      dst[c] = Average(left, right);
+    }
+    top += 8;
+    bottom += 8;
+    dst += 4;
+  }
+}
+
+#ifdef UTIL_ARCH_X86
+
+// Splits 8 pixels into the even and odd ones and averages them.
+__m128i AverageNeighborsSse2(__m128i first, __m128i second) {
+  const auto a = _mm_castsi128_ps(first);
+  const auto b = _mm_castsi128_ps(second);
+  const auto even = _mm_castps_si128(_mm_shuffle_ps(a, b, 0x88));
+  const auto odd = _mm_castps_si128(_mm_shuffle_ps(a, b, 0xdd));
+  return _mm_avg_epu8(even, odd);
+}
+
+void HalveRowSse2(const uint8_t* top, const uint8_t* bottom, uint8_t* dst,
+                  size_t dst_width) {
+  size_t x = 0;
+  for (; x + 4 <= dst_width; x += 4) {
+    const auto t = reinterpret_cast<const __m128i*>(top + x * 8);
+    const auto b = reinterpret_cast<const __m128i*>(bottom + x * 8);
+    const auto first = _mm_avg_epu8(_mm_loadu_si128(t), _mm_loadu_si128(b));
+    const auto second =
+        _mm_avg_epu8(_mm_loadu_si128(t + 1), _mm_loadu_si128(b + 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4),
+                     AverageNeighborsSse2(first, second));
+  }
+  HalveRowScalar(top + x * 8, bottom + x * 8, dst + x * 4, dst_width - x);
+}
+
+UTIL_TARGET_AVX2 void HalveRowAvx2(const uint8_t* top, const uint8_t* bottom,
+                                   uint8_t* dst, size_t dst_width) {
+  size_t x = 0;
+  for (; x + 8 <= dst_width; x += 8) {
+    const auto t = reinterpret_cast<const __m256i*>(top + x * 8);
+    const auto b = reinterpret_cast<const __m256i*>(bottom + x * 8);
+    const auto first =
+        _mm256_avg_epu8(_mm256_loadu_si256(t), _mm256_loadu_si256(b));
+    const auto second =
+        _mm256_avg_epu8(_mm256_loadu_si256(t + 1), _mm256_loadu_si256(b + 1));
+    // The shuffles work within 128-bit lanes, so the results end up in the
+    // order 0 1 4 5 2 3 6 7 (in pairs of pixels).
+    const auto a = _mm256_castsi256_ps(first);
+    const auto c = _mm256_castsi256_ps(second);
+    const auto even = _mm256_castps_si256(_mm256_shuffle_ps(a, c, 0x88));
+    const auto odd = _mm256_castps_si256(_mm256_shuffle_ps(a, c, 0xdd));
+    const auto averaged = _mm256_permute4x64_epi64(
+        _mm256_avg_epu8(even, odd), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), averaged);
+  }
+  HalveRowSse2(top + x * 8, bottom + x * 8, dst + x * 4, dst_width - x);
+}
+
+#endif  // UTIL_ARCH_X86
+
+void Halve(HalveRowKernel kernel, const uint8_t* src, size_t src_stride,
+           uint8_t* dst, size_t dst_stride, size_t dst_width,
+           size_t dst_height) {
+  for (size_t y = 0; y < dst_height; y++) {
+    const auto top = src + y * 2 * src_stride;
+    kernel(top, top + src_stride, dst + y * dst_stride, dst_width);
+  }
+}
+
+// Maps destination pixel centers onto the source in 16.16 fixed point.
+int64_t SourceCoordinate(size_t dst, size_t src_size, size_t dst_size) {
+  const auto scaled =
+      ((2 * static_cast<int64_t>(dst) + 1) * static_cast<int64_t>(src_size)
+       << 16) /
+      (2 * static_cast<int64_t>(dst_size));
+  return std::max<int64_t>(scaled - (1 << 15), 0);
+}
+
+void ResampleBilinear(const uint8_t* src, size_t src_stride, size_t src_width,
+                      size_t src_height, uint8_t* dst, size_t dst_stride,
+                      size_t dst_width, size_t dst_height) {
+  // Output channel order for BGRA input.
+  constexpr size_t kChannelMap[kBytesPerPixel] = {2, 1, 0, 3};
+
+  for (size_t y = 0; y < dst_height; y++) {
+    const auto sy = SourceCoordinate(y, src_height, dst_height);
+    const auto y0 = std::min(static_cast<size_t>(sy >> 16), src_height - 1);
+    const auto y1 = std::min(y0 + 1, src_height - 1);
+    const uint32_t fy = (sy >> 8) & 0xff;
+    const auto row0 = src + y0 * src_stride;
+    const auto row1 = src + y1 * src_stride;
+    auto out = dst + y * dst_stride;
+
+    for (size_t x = 0; x < dst_width; x++) {
+      const auto sx = SourceCoordinate(x, src_width, dst_width);
+      const auto x0 = std::min(static_cast<size_t>(sx >> 16), src_width - 1);
+      const auto x1 = std::min(x0 + 1, src_width - 1);
+      const uint32_t fx = (sx >> 8) & 0xff;
+
+      for (size_t c = 0; c < kBytesPerPixel; c++) {
+        const auto channel = kChannelMap[c];
+        const uint32_t top = row0[x0 * 4 + channel] * (256 - fx) +
+                             row0[x1 * 4 + channel] * fx;
+        const uint32_t bottom = row1[x0 * 4 + channel] * (256 - fx) +
+                                row1[x1 * 4 + channel] * fx;
+        out[c] = static_cast<uint8_t>(
+            (top * (256 - fy) + bottom * fy + (1 << 15)) >> 16);
+      }
+      out += 4;
+    }
+  }
+}
+
+}  // namespace
+
+Downscaler::Downscaler() { SetKernel(GetBestKernel()); }
+
+DownscaleKernel Downscaler::GetBestKernel() {
+#ifdef UTIL_ARCH_X86
+  return CpuSupportsAvx2() ? DownscaleKernel::kAvx2 : DownscaleKernel::kSse2;
+#else
+  return DownscaleKernel::kScalar;
+#endif
+}
+
+bool Downscaler::SetKernel(DownscaleKernel kernel) {
+  switch (kernel) {
+    case DownscaleKernel::kScalar:
+      halve_row_ = HalveRowScalar;
+      return true;
+#ifdef UTIL_ARCH_X86
+    case DownscaleKernel::kSse2:
+      halve_row_ = HalveRowSse2;
+      return true;
+    case DownscaleKernel::kAvx2:
+      if (!CpuSupportsAvx2()) {
+        return false;
+      }
+      halve_row_ = HalveRowAvx2;
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+bool Downscaler::Scale(const uint8_t* src, size_t src_stride,
+                       size_t src_width, size_t src_height, uint8_t* dst,
+                       size_t dst_stride, size_t dst_width,
+                       size_t dst_height) {
+  if (src_width == 0 || src_height == 0 || dst_width == 0 ||
+      dst_height == 0) {
+    return true;
+  }
+
+  size_t scratch = 0;
+  while (src_width >= dst_width * 2 && src_height >= dst_height * 2) {
+    // An odd last row or column gets dropped, which doesn't matter at these
+    // ratios.
+    const auto width = src_width / 2;
+    const auto height = src_height / 2;
+    const auto stride = width * kBytesPerPixel;
+    auto buffer = scratch_[scratch].Resize(stride * height);
+    if (!buffer) {
+      return false;
+    }
+
+    Halve(halve_row_, src, src_stride, buffer, stride, width, height);
+    src = buffer;
+    src_stride = stride;
+    src_width = width;
+    src_height = height;
+    scratch ^= 1;
+  }
+
+  ResampleBilinear(src, src_stride, src_width, src_height, dst, dst_stride,
+                   dst_width, dst_height);
+  return true;
+}
+
+bool Downscaler::Scale(PixelFormat format, const uint8_t* src,
+                       size_t src_stride, size_t src_width, size_t src_height,
+                       uint8_t* dst, size_t dst_stride, size_t dst_width,
+                       size_t dst_height) {
+  if (format == PixelFormat::kBgra8) {
+    return Scale(src, src_stride, src_width, src_height, dst, dst_stride,
+                 dst_width, dst_height);
+  }
+  if (src_width == 0 || src_height == 0 || dst_width == 0 ||
+      dst_height == 0) {
+    return true;
+  }
+
+  const auto row_bytes = RowBytes(PixelFormat::kBgra8, src_width);
+  // Small enough to convert as a whole.
+  if (src_width < dst_width * 2 || src_height < dst_height * 2) {
+    auto converted = converted_.Resize(row_bytes * src_height);
+    return converted &&
+           ConvertPixels(format, src, src_stride, PixelFormat::kBgra8,
+                         converted, row_bytes, src_width, src_height) &&
+           Scale(converted, row_bytes, src_width, src_height, dst, dst_stride,
+                 dst_width, dst_height);
+  }
+
+  const auto width = src_width / 2;
+  const auto height = src_height / 2;
+  const auto stride = width * kBytesPerPixel;
+  auto rows = converted_rows_.Resize(row_bytes * 2);
+  auto halved = converted_.Resize(stride * height);
+  if (!rows || !halved) {
+    return false;
+  }
+
+  for (size_t y = 0; y < height; y++) {
+    if (!ConvertPixels(format, src + y * 2 * src_stride, src_stride,
+                       PixelFormat::kBgra8, rows, row_bytes, src_width, 2)) {
+      return false;
+    }
+    halve_row_(rows, rows + row_bytes, halved + y * stride, width);
+  }
+
+  return Scale(halved, stride, width, height, dst, dst_stride, dst_width,
+               dst_height);
+}
+
+}  // namespace util
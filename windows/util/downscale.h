@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "aligned_buffer.h"
+#include "pixel_format.h"
+
+namespace util {
+
+enum class DownscaleKernel { kScalar, kSse2, kAvx2 };
+
+// Scales BGRA images down to small RGBA ones, e.g. for thumbnails.
+//
+// The image is box-filtered by repeatedly halving it while it's at least
+// twice as large as the target, which is where the time goes and what's
+// vectorized. The remaining scale is applied by bilinear interpolation,
+// which also swaps the red and blue channels. Its cost only depends on the
+// target size.
+//
+// Other formats are converted to BGRA two rows at a time during the first
+// halving, so that no full-size copy of the image is made.
+//
+// Keeps its scratch buffers between calls. Not thread-safe.
+class Downscaler {
+ public:
+  Downscaler();
+
+  // Returns false if a scratch buffer couldn't be allocated.
+  bool Scale(const uint8_t* src, size_t src_stride, size_t src_width,
+             size_t src_height, uint8_t* dst, size_t dst_stride,
+             size_t dst_width, size_t dst_height);
+
+  // Like the above, but for |src| in |format|. Also returns false if
+  // |format| can't be converted to BGRA.
+  bool Scale(PixelFormat format, const uint8_t* src, size_t src_stride,
+             size_t src_width, size_t src_height, uint8_t* dst,
+             size_t dst_stride, size_t dst_width, size_t dst_height);
+
+  // Returns false if the CPU doesn't support |kernel|.
+  bool SetKernel(DownscaleKernel kernel);
+  static DownscaleKernel GetBestKernel();
+
+ private:
+  typedef void (*HalveRowKernel)(const uint8_t* top, const uint8_t* bottom,
+                                 uint8_t* dst, size_t dst_width);
+
+  HalveRowKernel halve_row_;
+  AlignedBuffer scratch_[2];
+  // Holds the input converted to BGRA, and the rows being converted.
+  AlignedBuffer converted_;
+  AlignedBuffer converted_rows_;
+};
+
+}  // namespace util
@@ -0,0 +1,104 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "string_converter.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace util {
+
+#ifdef _WIN32
+
+std::unique_ptr<MappedFile> MappedFile::Create(const std::string& path,
+                                               size_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+
+  std::unique_ptr<MappedFile> file(new MappedFile());
+  file->file_ = CreateFileW(Utf16FromUtf8(path).c_str(),
+                            GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                            nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file->file_ == INVALID_HANDLE_VALUE) {
+    file->file_ = nullptr;
+    return nullptr;
+  }
+
+  // Extends the file to |size|. New pages read as zeros.
+  const auto size64 = static_cast<uint64_t>(size);
+  file->mapping_ = CreateFileMappingW(
+      file->file_, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+      static_cast<DWORD>(size64 & 0xffffffff), nullptr);
+  if (!file->mapping_) {
+    return nullptr;
+  }
+
+  file->data_ = static_cast<uint8_t*>(
+      MapViewOfFile(file->mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size));
+  if (!file->data_) {
+    return nullptr;
+  }
+  file->size_ = size;
+  return file;
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+  if (file_) {
+    CloseHandle(file_);
+  }
+}
+
+bool MappedFile::Flush() {
+  return FlushViewOfFile(data_, size_) && FlushFileBuffers(file_);
+}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Create(const std::string& path,
+                                               size_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+
+  std::unique_ptr<MappedFile> file(new MappedFile());
+  file->fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file->fd_ < 0 || ftruncate(file->fd_, static_cast<off_t>(size)) != 0) {
+    return nullptr;
+  }
+
+  void* data =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd_, 0);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+  file->data_ = static_cast<uint8_t*>(data);
+  file->size_ = size;
+  return file;
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(data_, size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool MappedFile::Flush() { return msync(data_, size_, MS_SYNC) == 0; }
+
+#endif
+
+}  // namespace util
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace util {
+
+// A file of fixed size mapped into memory for reading and writing.
+class MappedFile {
+ public:
+  // Creates or truncates the file at |path| (UTF-8) and maps |size| bytes of
+  // zeros. Returns nullptr on failure.
+  static std::unique_ptr<MappedFile> Create(const std::string& path,
+                                            size_t size);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Writes changes back to the file. Blocks on I/O.
+  bool Flush();
+
+  uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile() = default;
+
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+};
+
+}  // namespace util
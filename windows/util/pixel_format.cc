@@ -0,0 +1,141 @@
+#include "pixel_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "swizzle.h"
+
+namespace util {
+
+namespace {
+
+bool Is8Bit(PixelFormat format) {
+  return format == PixelFormat::kBgra8 || format == PixelFormat::kRgba8;
+}
+
+uint8_t ToUnorm8(float value) {
+  return static_cast<uint8_t>(std::lround(value * 255.0f));
+}
+
+float EncodeSrgb(float linear) {
+  return linear <= 0.0031308f
+             ? linear * 12.92f
+             : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+}
+
+// 8-bit values for every half, so that conversion is a single lookup per
+// channel.
+struct HalfTables {
+  uint8_t color[65536];
+  uint8_t alpha[65536];
+
+  HalfTables() {
+    for (uint32_t half = 0; half < 65536; half++) {
+      const auto value = HalfToFloat(static_cast<uint16_t>(half));
+      // NaN compares false and ends up as 0.
+      const auto clamped = value > 0.0f ? std::min(value, 1.0f) : 0.0f;
+      color[half] = ToUnorm8(EncodeSrgb(clamped));
+      alpha[half] = ToUnorm8(clamped);
+    }
+  }
+};
+
+const HalfTables& GetHalfTables() {
+  static const auto tables = std::make_unique<HalfTables>();
+  return *tables;
+}
+
+void ConvertHalfRow(const HalfTables& tables, const uint8_t* src,
+                    uint8_t* dst, size_t width, bool red_first) {
+  const size_t red = red_first ? 0 : 2;
+  const size_t blue = red_first ? 2 : 0;
+  for (size_t i = 0; i < width; i++) {
+    uint16_t rgba[4];
+    std::memcpy(rgba, src + i * 8, sizeof(rgba));
+    dst[i * 4 + red] = tables.color[rgba[0]];
+    dst[i * 4 + 1] = tables.color[rgba[1]];
+    dst[i * 4 + blue] = tables.color[rgba[2]];
+    dst[i * 4 + 3] = tables.alpha[rgba[3]];
+  }
+}
+
+}  // namespace
+
+size_t BytesPerPixel(PixelFormat format) {
+  return format == PixelFormat::kRgba16Float ? 8 : 4;
+}
+
+size_t RowBytes(PixelFormat format, size_t width) {
+  return width * BytesPerPixel(format);
+}
+
+size_t ImageBytes(PixelFormat format, size_t width, size_t height) {
+  return RowBytes(format, width) * height;
+}
+
+PixelFormat NegotiateCaptureFormat(PixelFormat requested) {
+  return requested == PixelFormat::kRgba16Float ? PixelFormat::kRgba16Float
+                                                : PixelFormat::kBgra8;
+}
+
+bool ConvertPixels(PixelFormat src_format, const uint8_t* src,
+                   size_t src_stride, PixelFormat dst_format, uint8_t* dst,
+                   size_t dst_stride, size_t width, size_t height) {
+  if (!Is8Bit(dst_format)) {
+    return false;
+  }
+
+  if (src_format == dst_format) {
+    const auto row_bytes = RowBytes(src_format, width);
+    for (size_t y = 0; y < height; y++) {
+      std::memmove(dst + y * dst_stride, src + y * src_stride, row_bytes);
+    }
+    return true;
+  }
+
+  if (Is8Bit(src_format)) {
+    // Swapping red and blue works either way.
+    SwizzleBgraToRgba(src, src_stride, dst, dst_stride, width, height);
+    return true;
+  }
+
+  const auto& tables = GetHalfTables();
+  const bool red_first = dst_format == PixelFormat::kRgba8;
+  for (size_t y = 0; y < height; y++) {
+    ConvertHalfRow(tables, src + y * src_stride, dst + y * dst_stride, width,
+                   red_first);
+  }
+  return true;
+}
+
+float HalfToFloat(uint16_t half) {
+  const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1f;
+  uint32_t mantissa = half & 0x3ff;
+
+  uint32_t bits;
+  if (exponent == 0x1f) {
+    // Infinity or NaN.
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else if (mantissa == 0) {
+    bits = sign;
+  } else {
+    // Subnormal, normalize it.
+    uint32_t shift = 0;
+    while (!(mantissa & 0x400)) {
+      mantissa <<= 1;
+      shift++;
+    }
+    bits = sign | ((113 - shift) << 23) | ((mantissa & 0x3ff) << 13);
+  }
+
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+}  // namespace util
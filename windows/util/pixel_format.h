@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+enum class PixelFormat {
+  // 8 bits per channel, blue first.
+  kBgra8,
+  // 8 bits per channel, red first.
+  kRgba8,
+  // 16-bit floats per channel in linear scRGB, used for HDR content.
+  kRgba16Float,
+};
+
+size_t BytesPerPixel(PixelFormat format);
+
+// The size of a row or image of tightly packed pixels.
+size_t RowBytes(PixelFormat format, size_t width);
+size_t ImageBytes(PixelFormat format, size_t width, size_t height);
+
+// Returns the format frames get captured in if |requested| is asked for.
+//
+// Windows.Graphics.Capture only delivers BGRA8 and FP16 frames, so RGBA8
+// falls back to BGRA8 and is left to the consumer to swizzle.
+PixelFormat NegotiateCaptureFormat(PixelFormat requested);
+
+// Converts |height| rows of |width| pixels. |dst_format| must have 8 bits
+// per channel. FP16 values are clamped to [0, 1] and sRGB encoded. Returns
+// false if the conversion isn't supported.
+bool ConvertPixels(PixelFormat src_format, const uint8_t* src,
+                   size_t src_stride, PixelFormat dst_format, uint8_t* dst,
+                   size_t dst_stride, size_t width, size_t height);
+
+float HalfToFloat(uint16_t half);
+
+}  // namespace util
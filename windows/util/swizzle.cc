@@ -0,0 +1,141 @@
+#include "swizzle.h"
+
+#include "cpu_features.h"
+
+#ifdef UTIL_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace util {
+
+namespace {
+
+typedef void (*RowKernel)(const uint8_t* src, uint8_t* dst, size_t width);
+
+void SwizzleRowScalar(const uint8_t* src, uint8_t* dst, size_t width) {
+  for (size_t i = 0; i < width; i++) {
+    const auto b = src[0];
+    const auto g = src[1];
+    const auto r = src[2];
+    const auto a = src[3];
+    dst[0] = r;
+    dst[1] = g;
+    dst[2] = b;
+    dst[3] = a;
+    src += 4;
+    dst += 4;
+  }
+}
+
+#ifdef UTIL_ARCH_X86
+
+// SSE2 lacks a byte shuffle, so move red and blue using 32-bit shifts.
+void SwizzleRowSse2(const uint8_t* src, uint8_t* dst, size_t width) {
+  const auto green_alpha_mask = _mm_set1_epi32(static_cast<int>(0xff00ff00));
+  const auto red_blue_mask = _mm_set1_epi32(0x00ff00ff);
+
+  size_t i = 0;
+  for (; i + 4 <= width; i += 4) {
+    const auto pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    const auto green_alpha = _mm_and_si128(pixels, green_alpha_mask);
+    const auto red_blue = _mm_and_si128(pixels, red_blue_mask);
+    const auto swapped = _mm_or_si128(_mm_slli_epi32(red_blue, 16),
+                                      _mm_srli_epi32(red_blue, 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                     _mm_or_si128(green_alpha, swapped));
+  }
+  SwizzleRowScalar(src + i * 4, dst + i * 4, width - i);
+}
+
+UTIL_TARGET_AVX2 void SwizzleRowAvx2(const uint8_t* src, uint8_t* dst,
+                                     size_t width) {
+  const auto shuffle = _mm256_setr_epi8(
+      2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,  //
+      2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+  size_t i = 0;
+  for (; i + 16 <= width; i += 16) {
+    const auto first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    const auto second =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4 + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                        _mm256_shuffle_epi8(first, shuffle));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4 + 32),
+                        _mm256_shuffle_epi8(second, shuffle));
+  }
+  for (; i + 8 <= width; i += 8) {
+    const auto pixels =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                        _mm256_shuffle_epi8(pixels, shuffle));
+  }
+  SwizzleRowSse2(src + i * 4, dst + i * 4, width - i);
+}
+
+#endif  // UTIL_ARCH_X86
+
+bool IsSupported(SwizzleKernel kernel) {
+  switch (kernel) {
+    case SwizzleKernel::kScalar:
+      return true;
+#ifdef UTIL_ARCH_X86
+    case SwizzleKernel::kSse2:
+      return true;
+    case SwizzleKernel::kAvx2:
+      return CpuSupportsAvx2();
+#endif
+    default:
+      return false;
+  }
+}
+
+RowKernel GetRowKernel(SwizzleKernel kernel) {
+  switch (kernel) {
+#ifdef UTIL_ARCH_X86
+    case SwizzleKernel::kSse2:
+      return SwizzleRowSse2;
+    case SwizzleKernel::kAvx2:
+      return SwizzleRowAvx2;
+#endif
+    default:
+      return SwizzleRowScalar;
+  }
+}
+
+void Swizzle(RowKernel kernel, const uint8_t* src, size_t src_stride,
+             uint8_t* dst, size_t dst_stride, size_t width, size_t height) {
+  for (size_t y = 0; y < height; y++) {
+    kernel(src + y * src_stride, dst + y * dst_stride, width);
+  }
+}
+
+}  // namespace
+
+SwizzleKernel GetBestSwizzleKernel() {
+  static const SwizzleKernel kernel =
+      IsSupported(SwizzleKernel::kAvx2)   ? SwizzleKernel::kAvx2
+      : IsSupported(SwizzleKernel::kSse2) ? SwizzleKernel::kSse2
+                                          : SwizzleKernel::kScalar;
+  return kernel;
+}
+
+void SwizzleBgraToRgba(const uint8_t* src, size_t src_stride, uint8_t* dst,
+                       size_t dst_stride, size_t width, size_t height) {
+  static const RowKernel kernel = GetRowKernel(GetBestSwizzleKernel());
+  Swizzle(kernel, src, src_stride, dst, dst_stride, width, height);
+}
+
+bool SwizzleBgraToRgba(SwizzleKernel kernel, const uint8_t* src,
+                       size_t src_stride, uint8_t* dst, size_t dst_stride,
+                       size_t width, size_t height) {
+  if (!IsSupported(kernel)) {
+    return false;
+  }
+  Swizzle(GetRowKernel(kernel), src, src_stride, dst, dst_stride, width,
+          height);
+  return true;
+}
+
+}  // namespace util
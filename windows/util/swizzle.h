@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+enum class SwizzleKernel { kScalar, kSse2, kAvx2 };
+
+// Converts |height| rows of |width| BGRA pixels to RGBA (i.e. swaps the red
+// and blue channels) using the fastest kernel the CPU supports. |src| and
+// |dst| may point to the same memory.
+void SwizzleBgraToRgba(const uint8_t* src, size_t src_stride, uint8_t* dst,
+                       size_t dst_stride, size_t width, size_t height);
+
+// Like |SwizzleBgraToRgba|, but uses the given kernel. Returns false if the
+// CPU doesn't support it.
+bool SwizzleBgraToRgba(SwizzleKernel kernel, const uint8_t* src,
+                       size_t src_stride, uint8_t* dst, size_t dst_stride,
+                       size_t width, size_t height);
+
+// Returns the kernel used by |SwizzleBgraToRgba|.
+SwizzleKernel GetBestSwizzleKernel();
+
+}  // namespace util
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+namespace util {
+
+// Checks that methods are called on the same thread.
+//
+// A detached checker binds to the first thread calling |IsCurrent|, which
+// allows checking threads that don't exist yet when the owner is created.
+class ThreadChecker {
+ public:
+  ThreadChecker() : thread_id_(std::this_thread::get_id()) {}
+
+  bool IsCurrent() const {
+    const auto current = std::this_thread::get_id();
+    auto bound = std::thread::id();
+    // Binds if detached, otherwise loads the bound thread into |bound|.
+    return thread_id_.compare_exchange_strong(bound, current) ||
+           bound == current;
+  }
+
+  // Rebinds to the next thread calling |IsCurrent|.
+  void Detach() { thread_id_ = std::thread::id(); }
+
+ private:
+  mutable std::atomic<std::thread::id> thread_id_;
+};
+
+}  // namespace util
@@ -2,6 +2,7 @@
 
 #include <wrl.h>
 
+#include <climits>
 #include <format>
 #include <iostream>
 
@@ -13,6 +14,16 @@ using namespace Microsoft::WRL;
 
 namespace {
 
+// Outside the range of Flutter's int32 pointer ids.
+constexpr int64_t kMouseInputKey = INT64_MIN;
+constexpr int64_t kScrollInputKey = INT64_MIN + 1;
+
+uint32_t GetWheelScrollLines() {
+  UINT lines = ScrollAccumulator::kDefaultLinesPerScroll;
+  SystemParametersInfo(SPI_GETWHEELSCROLLLINES, 0, &lines, 0);
+  return lines;
+}
+
 inline void ConvertColor(COREWEBVIEW2_COLOR& webview_color, int32_t color) {
   webview_color.B = color & 0xFF;
   webview_color.G = (color >> 8) & 0xFF;
@@ -62,7 +73,8 @@ Webview::Webview(
     : composition_controller_(std::move(composition_controller)),
       host_(host),
       hwnd_(hwnd),
-      owns_window_(owns_window) {
+      owns_window_(owns_window),
+      scroll_accumulator_(GetWheelScrollLines()) {
   webview_controller_ =
       composition_controller_.try_query<ICoreWebView2Controller3>();
 
@@ -420,6 +432,8 @@ void Webview::RegisterEventHandlers() {
 }
 
 void Webview::SetSurfaceSize(size_t width, size_t height, float scale_factor) {
+  // Queued positions refer to the previous size.
+  FlushInput();
   if (!IsValid()) {
     return;
   }
@@ -518,10 +532,121 @@ bool Webview::SetZoomFactor(double factor) {
 }
 
 void Webview::SetCursorPos(double x, double y) {
+  if (!AcceptsInput()) {
+    return;
+  }
+
+  WebviewInputEvent event = {WebviewInputEvent::Kind::CursorPos};
+  event.x = x;
+  event.y = y;
+  QueueInput(event, kMouseInputKey);
+}
+
+void Webview::SetPointerUpdate(int32_t pointer,
+                               WebviewPointerEventKind eventKind, double x,
+                               double y, double size, double pressure) {
+  if (!AcceptsInput()) {
+    return;
+  }
+
+  WebviewInputEvent event = {WebviewInputEvent::Kind::PointerUpdate};
+  event.pointer = pointer;
+  event.pointer_event = eventKind;
+  event.x = x;
+  event.y = y;
+  event.size = size;
+  event.pressure = pressure;
+  // Contacts starting or ending keep their order.
+  QueueInput(event, eventKind == WebviewPointerEventKind::Update
+                        ? std::make_optional<int64_t>(pointer)
+                        : std::nullopt);
+}
+
+void Webview::SetPointerButtonState(WebviewPointerButton button, bool is_down) {
+  if (!AcceptsInput()) {
+    return;
+  }
+
+  WebviewInputEvent event = {WebviewInputEvent::Kind::PointerButton};
+  event.button = button;
+  event.is_down = is_down;
+  QueueInput(event, std::nullopt);
+}
+
+void Webview::SetScrollDelta(double delta_x, double delta_y) {
+  if (!AcceptsInput()) {
+    return;
+  }
+
+  // Consecutive deltas add up, but never move past other input, which
+  // e.g. sets the position the wheel events apply to.
+  WebviewInputEvent event = {WebviewInputEvent::Kind::ScrollDelta};
+  event.x = delta_x;
+  event.y = delta_y;
+  input_queue_.PushMergeable(
+      event, kScrollInputKey,
+      [](WebviewInputEvent& queued, const WebviewInputEvent& event) {
+        queued.x += event.x;
+        queued.y += event.y;
+      });
+}
+
+bool Webview::AcceptsInput() {
+  if (IsValid()) {
+    return true;
+  }
+  if (input_dispatched_callback_) {
+    input_dispatched_callback_(false);
+  }
+  return false;
+}
+
+void Webview::FlushInput() {
+  if (input_queue_.empty()) {
+    return;
+  }
+  input_queue_.Flush(
+      [this](const WebviewInputEvent& event) { DispatchInput(event); });
+  if (input_dispatched_callback_) {
+    input_dispatched_callback_(IsValid());
+  }
+}
+
+void Webview::FlushInputIfDue() {
+  const bool flushed = input_queue_.FlushIfDue(
+      [this](const WebviewInputEvent& event) { DispatchInput(event); });
+  if (flushed && input_dispatched_callback_) {
+    input_dispatched_callback_(IsValid());
+  }
+}
+
+void Webview::QueueInput(const WebviewInputEvent& event,
+                         std::optional<int64_t> key) {
+  input_queue_.Push(event, key);
+  if (!key.has_value()) {
+    FlushInput();
+  }
+}
+
+void Webview::DispatchInput(const WebviewInputEvent& event) {
   if (!IsValid()) {
     return;
   }
 
+  switch (event.kind) {
+    case WebviewInputEvent::Kind::CursorPos:
+      return SendCursorPos(event.x, event.y);
+    case WebviewInputEvent::Kind::PointerUpdate:
+      return SendPointerUpdate(event.pointer, event.pointer_event, event.x,
+                               event.y, event.size, event.pressure);
+    case WebviewInputEvent::Kind::PointerButton:
+      return SendPointerButtonState(event.button, event.is_down);
+    case WebviewInputEvent::Kind::ScrollDelta:
+      return SendScrollDelta(event.x, event.y);
+  }
+}
+
+void Webview::SendCursorPos(double x, double y) {
   POINT point;
   point.x = static_cast<LONG>(x * scale_factor_);
   point.y = static_cast<LONG>(y * scale_factor_);
@@ -533,13 +658,9 @@ void Webview::SetCursorPos(double x, double y) {
       virtual_keys_.state(), 0, point);
 }
 
-void Webview::SetPointerUpdate(int32_t pointer,
-                               WebviewPointerEventKind eventKind, double x,
-                               double y, double size, double pressure) {
-  if (!IsValid()) {
-    return;
-  }
-
+void Webview::SendPointerUpdate(int32_t pointer,
+                                WebviewPointerEventKind eventKind, double x,
+                                double y, double size, double pressure) {
   COREWEBVIEW2_POINTER_EVENT_KIND event =
       COREWEBVIEW2_POINTER_EVENT_KIND_UPDATE;
   UINT32 pointerFlags = POINTER_FLAG_NONE;
@@ -580,6 +701,7 @@ void Webview::SetPointerUpdate(int32_t pointer,
   rect.bottom = point.y + 2;
 
   host_->CreateWebViewPointerInfo(
+      pointer,
       [this, pointer, event, pointerFlags, point, rect, pressure](
           wil::com_ptr<ICoreWebView2PointerInfo> pointerInfo,
           std::unique_ptr<WebviewCreationError> error) {
@@ -598,13 +720,16 @@ void Webview::SetPointerUpdate(int32_t pointer,
           composition_controller_->SendPointerInput(event, pInfo);
         }
       });
-}
 
-void Webview::SetPointerButtonState(WebviewPointerButton button, bool is_down) {
-  if (!IsValid()) {
-    return;
+  // The contact ended, let another pointer reuse the object.
+  if (event == COREWEBVIEW2_POINTER_EVENT_KIND_UP ||
+      event == COREWEBVIEW2_POINTER_EVENT_KIND_LEAVE) {
+    host_->ReleaseWebViewPointerInfo(pointer);
   }
+}
 
+void Webview::SendPointerButtonState(WebviewPointerButton button,
+                                     bool is_down) {
   COREWEBVIEW2_MOUSE_EVENT_KIND kind;
   switch (button) {
     case WebviewPointerButton::Primary:
@@ -630,21 +755,9 @@ void Webview::SetPointerButtonState(WebviewPointerButton button, bool is_down) {
                                           last_cursor_pos_);
 }
 
-void Webview::SendScroll(double delta, bool horizontal) {
-  // clang-format off
-  //
-  // TODO:
-  // Using a fixed value here is certainly wrong. Flutter's calculation in flutter_window.cc
-  // needs to be inverted to get back the "native" value. See
-  // - https://github.com/flutter/engine/blob/82c1dfcf588c2669ca391134910d634ca31fddf1/shell/platform/windows/flutter_window.cc#L416-L426
-  // Related:
-  // - https://source.chromium.org/chromium/chromium/src/+/main:ui/events/blink/web_input_event_builders_win.cc
-  // - https://github.com/flutter/flutter/issues/107248
-  //
-  // clang-format on
-  constexpr auto kScrollMultiplier = 1.5;
-
-  auto offset = static_cast<short>(delta * kScrollMultiplier);
+void Webview::SendScroll(int32_t units, bool horizontal) {
+  // Wheel deltas are passed as a signed 16-bit value.
+  const auto offset = static_cast<UINT32>(static_cast<int16_t>(units));
 
   if (horizontal) {
     composition_controller_->SendMouseInput(
@@ -657,16 +770,14 @@ void Webview::SendScroll(double delta, bool horizontal) {
   }
 }
 
-void Webview::SetScrollDelta(double delta_x, double delta_y) {
-  if (!IsValid()) {
-    return;
-  }
-
-  if (delta_x != 0.0) {
-    SendScroll(delta_x, true);
+void Webview::SendScrollDelta(double delta_x, double delta_y) {
+  scroll_accumulator_.Add(delta_x, delta_y);
+  const auto units = scroll_accumulator_.Take();
+  if (units.x != 0) {
+    SendScroll(units.x, true);
   }
-  if (delta_y != 0.0) {
-    SendScroll(delta_y, false);
+  if (units.y != 0) {
+    SendScroll(units.y, false);
   }
 }
 
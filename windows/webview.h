@@ -6,7 +6,12 @@
 #include <windows.ui.composition.h>
 #include <winrt/base.h>
 
+#include <chrono>
 #include <functional>
+#include <optional>
+
+#include "input_coalescer.h"
+#include "scroll_accumulator.h"
 
 class WebviewHost;
 
@@ -51,6 +56,23 @@ struct WebviewDownloadEvent {
   INT64 totalBytesToReceive;
 };
 
+// Input waiting to be sent to the WebView.
+struct WebviewInputEvent {
+  enum class Kind { CursorPos, PointerUpdate, PointerButton, ScrollDelta };
+
+  Kind kind;
+  int32_t pointer = 0;
+  WebviewPointerEventKind pointer_event = WebviewPointerEventKind::Update;
+  WebviewPointerButton button = WebviewPointerButton::None;
+  bool is_down = false;
+  // The position, or the scroll delta in physical pixels for
+  // |Kind::ScrollDelta|.
+  double x = 0;
+  double y = 0;
+  double size = 0;
+  double pressure = 0;
+};
+
 struct VirtualKeyState {
  public:
   inline void set_isLeftButtonDown(bool is_down) {
@@ -134,6 +156,7 @@ class Webview {
   typedef std::function<void(bool contains_fullscreen_element)>
       ContainsFullScreenElementChangedCallback;
   typedef std::function<void(WebviewDownloadEvent)> DownloadEventCallback;
+  typedef std::function<void(bool injected)> InputDispatchedCallback;
 
   ~Webview();
 
@@ -148,7 +171,30 @@ class Webview {
   void SetPointerUpdate(int32_t pointer, WebviewPointerEventKind eventKind,
                         double x, double y, double size, double pressure);
   void SetPointerButtonState(WebviewPointerButton button, bool isDown);
+  // The delta is in physical pixels, as Flutter's embedder reported it.
+  // Fractions of a wheel notch are kept, and consecutive deltas are sent as
+  // one wheel event per axis.
   void SetScrollDelta(double delta_x, double delta_y);
+
+  // Cursor moves and touch point updates are queued and collapsed per
+  // pointer until the queue is flushed, which should happen whenever a frame
+  // was rendered and at the latest at |input_deadline|. Scroll deltas are
+  // queued as well, but only merged with directly preceding ones. Other
+  // input flushes the queue right away.
+  void FlushInput();
+  // Flushes the queue if |input_deadline| has passed.
+  void FlushInputIfDue();
+  std::optional<std::chrono::steady_clock::time_point> input_deadline()
+      const {
+    return input_queue_.deadline();
+  }
+  std::chrono::milliseconds input_max_delay() const {
+    return input_queue_.max_delay();
+  }
+  const InputCoalescer<WebviewInputEvent>::Stats& input_stats() const {
+    return input_queue_.stats();
+  }
+
   void LoadUrl(const std::string& url);
   void LoadStringContent(const std::string& content);
   bool Stop();
@@ -228,6 +274,12 @@ class Webview {
     devtools_protocol_event_callback_ = std::move(callback);
   }
 
+  // Called after queued input was sent to the WebView, with |injected| false
+  // if it was dropped because the WebView is gone.
+  void OnInputDispatched(InputDispatchedCallback callback) {
+    input_dispatched_callback_ = std::move(callback);
+  }
+
   void OnContainsFullScreenElementChanged(
       ContainsFullScreenElementChangedCallback callback) {
     contains_fullscreen_element_changed_callback_ = std::move(callback);
@@ -245,6 +297,8 @@ class Webview {
       devtools_protocol_event_receiver_;
   wil::com_ptr<ICoreWebView2Settings2> settings2_;
   POINT last_cursor_pos_ = {0, 0};
+  InputCoalescer<WebviewInputEvent> input_queue_;
+  ScrollAccumulator scroll_accumulator_;
   VirtualKeyState virtual_keys_;
   WebviewPopupWindowPolicy popup_window_policy_ =
       WebviewPopupWindowPolicy::Allow;
@@ -270,6 +324,7 @@ class Webview {
   DevtoolsProtocolEventCallback devtools_protocol_event_callback_;
   ContainsFullScreenElementChangedCallback
       contains_fullscreen_element_changed_callback_;
+  InputDispatchedCallback input_dispatched_callback_;
 
   Webview(
       wil::com_ptr<ICoreWebView2CompositionController> composition_controller,
@@ -280,5 +335,17 @@ class Webview {
       HWND hwnd, bool offscreen_only);
   void RegisterEventHandlers();
   void EnableSecurityUpdates();
-  void SendScroll(double offset, bool horizontal);
+  void SendScroll(int32_t units, bool horizontal);
+  // Returns false, and reports the input as dropped, if the WebView is gone.
+  bool AcceptsInput();
+  // Queues |event|, collapsing it with other events of the same |key|. Flushes
+  // right away if there is no key.
+  void QueueInput(const WebviewInputEvent& event, std::optional<int64_t> key);
+  void DispatchInput(const WebviewInputEvent& event);
+  void SendCursorPos(double x, double y);
+  void SendPointerUpdate(int32_t pointer, WebviewPointerEventKind eventKind,
+                         double x, double y, double size, double pressure);
+  void SendPointerButtonState(WebviewPointerButton button, bool isDown);
+  // Adds the delta to |scroll_accumulator_| and sends the whole wheel units.
+  void SendScrollDelta(double delta_x, double delta_y);
 };
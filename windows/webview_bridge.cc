@@ -3,9 +3,15 @@
 #include <flutter/event_stream_handler_functions.h>
 #include <flutter/method_result_functions.h>
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
 #include <format>
+#include <iostream>
 
 #include "texture_bridge_gpu.h"
+#include "texture_bridge_pixel_buffer.h"
 
 namespace {
 constexpr auto kErrorInvalidArgs = "invalidArguments";
@@ -27,6 +33,7 @@ constexpr auto kMethodSetCursorPos = "setCursorPos";
 constexpr auto kMethodSetPointerUpdate = "setPointerUpdate";
 constexpr auto kMethodSetPointerButton = "setPointerButton";
 constexpr auto kMethodSetScrollDelta = "setScrollDelta";
+constexpr auto kMethodSendInputBatch = "sendInputBatch";
 constexpr auto kMethodSetUserAgent = "setUserAgent";
 constexpr auto kMethodSetBackgroundColor = "setBackgroundColor";
 constexpr auto kMethodSetZoomFactor = "setZoomFactor";
@@ -41,6 +48,26 @@ constexpr auto kMethodClearCache = "clearCache";
 constexpr auto kMethodSetCacheDisabled = "setCacheDisabled";
 constexpr auto kMethodSetPopupWindowPolicy = "setPopupWindowPolicy";
 constexpr auto kMethodSetFpsLimit = "setFpsLimit";
+constexpr auto kMethodSetAdaptiveFps = "setAdaptiveFps";
+constexpr auto kMethodSetVisibleRect = "setVisibleRect";
+constexpr auto kMethodSetDynamicResolution = "setDynamicResolution";
+constexpr auto kMethodGetFrameStats = "getFrameStats";
+constexpr auto kMethodGetInputLatency = "getInputLatency";
+constexpr auto kMethodSetFrameStatsInterval = "setFrameStatsInterval";
+constexpr auto kMethodGetDirtyRects = "getDirtyRects";
+constexpr auto kMethodCapturePixels = "capturePixels";
+constexpr auto kMethodSetThumbnailMode = "setThumbnailMode";
+constexpr auto kMethodStartFrameRecording = "startFrameRecording";
+constexpr auto kMethodStopFrameRecording = "stopFrameRecording";
+constexpr auto kMethodDumpFrameRecording = "dumpFrameRecording";
+
+// GPU copies usually finish within a frame.
+constexpr auto kReadbackPollInterval = std::chrono::milliseconds(8);
+
+constexpr auto kRasterScalePollInterval = std::chrono::milliseconds(100);
+
+// Longer recordings are better served by a screen recorder.
+constexpr int32_t kMaxRecordingSeconds = 600;
 
 constexpr auto kEventType = "type";
 constexpr auto kEventValue = "value";
@@ -80,6 +107,154 @@ GetPointAndScaleFactorFromArgs(const flutter::EncodableValue* args) {
   return std::make_tuple(*x, *y, *z);
 }
 
+static flutter::EncodableValue EncodeLatencyHistogram(
+    const LatencyHistogram::Snapshot& histogram) {
+  flutter::EncodableList bucket_limits;
+  flutter::EncodableList bucket_counts;
+  for (size_t i = 0; i < LatencyHistogram::kBucketCount; i++) {
+    // The last bucket is open-ended.
+    if (i + 1 < LatencyHistogram::kBucketCount) {
+      bucket_limits.push_back(flutter::EncodableValue(
+          static_cast<int64_t>(LatencyHistogram::BucketLimit(i).count())));
+    }
+    bucket_counts.push_back(
+        flutter::EncodableValue(static_cast<int64_t>(histogram.counts[i])));
+  }
+
+  return flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("count"),
+       flutter::EncodableValue(static_cast<int64_t>(histogram.count))},
+      {flutter::EncodableValue("meanUs"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(histogram.mean().count()))},
+      {flutter::EncodableValue("maxUs"),
+       flutter::EncodableValue(static_cast<int64_t>(histogram.max.count()))},
+      {flutter::EncodableValue("p50Us"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(histogram.Percentile(50).count()))},
+      {flutter::EncodableValue("p90Us"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(histogram.Percentile(90).count()))},
+      {flutter::EncodableValue("p99Us"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(histogram.Percentile(99).count()))},
+      {flutter::EncodableValue("bucketLimitsUs"),
+       flutter::EncodableValue(std::move(bucket_limits))},
+      {flutter::EncodableValue("bucketCounts"),
+       flutter::EncodableValue(std::move(bucket_counts))},
+  });
+}
+
+static flutter::EncodableValue EncodeImage(
+    ReadbackScheduler<D3DReadbackDevice>::Image&& image) {
+  return flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("width"),
+       flutter::EncodableValue(static_cast<int32_t>(image.width))},
+      {flutter::EncodableValue("height"),
+       flutter::EncodableValue(static_cast<int32_t>(image.height))},
+      // Moved rather than copied.
+      {flutter::EncodableValue("pixels"),
+       flutter::EncodableValue(std::move(image.pixels))},
+  });
+}
+
+// Scales the mapped frame down to fit into |max_width| x |max_height|,
+// keeping the aspect ratio.
+static std::optional<ReadbackScheduler<D3DReadbackDevice>::Image> FitImage(
+    util::Downscaler& scaler, util::PixelFormat format,
+    const ReadbackMapping& mapping, size_t width, size_t height,
+    size_t max_width, size_t max_height) {
+  const auto scale =
+      std::min({1.0, static_cast<double>(max_width) / width,
+                static_cast<double>(max_height) / height});
+  const auto fitted_width =
+      std::max<size_t>(static_cast<size_t>(std::lround(width * scale)), 1);
+  const auto fitted_height =
+      std::max<size_t>(static_cast<size_t>(std::lround(height * scale)), 1);
+
+  ReadbackScheduler<D3DReadbackDevice>::Image image = {
+      fitted_width, fitted_height,
+      std::vector<uint8_t>(fitted_width * fitted_height * 4)};
+  if (!scaler.Scale(format, mapping.data, mapping.stride, width, height,
+                    image.pixels.data(), fitted_width * 4, fitted_width,
+                    fitted_height)) {
+    return std::nullopt;
+  }
+  return image;
+}
+
+static flutter::EncodableValue EncodeFrameStats(
+    const FrameStats::Snapshot& stats,
+    const ResizeCoalescer::Stats& resize_stats,
+    const InputCoalescer<WebviewInputEvent>::Stats& input_stats) {
+  return flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("framesArrived"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.frames_arrived))},
+      {flutter::EncodableValue("framesDropped"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.frames_dropped))},
+      {flutter::EncodableValue("framesSuppressed"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.frames_suppressed))},
+      {flutter::EncodableValue("framesSignaled"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.frames_signaled))},
+      {flutter::EncodableValue("signalsCoalesced"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.signals_coalesced))},
+      {flutter::EncodableValue("descriptorRequests"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(stats.descriptor_requests))},
+      {flutter::EncodableValue("copiesMade"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.copies_made))},
+      {flutter::EncodableValue("copiesSkipped"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.copies_skipped))},
+      {flutter::EncodableValue("resizeRecreations"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(stats.resize_recreations))},
+      {flutter::EncodableValue("tilesChecked"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.tiles_checked))},
+      {flutter::EncodableValue("tilesDirty"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.tiles_dirty))},
+      {flutter::EncodableValue("resizesRequested"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(resize_stats.resizes_requested))},
+      {flutter::EncodableValue("resizesCollapsed"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(resize_stats.resizes_collapsed))},
+      {flutter::EncodableValue("inputEventsQueued"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(input_stats.events_queued))},
+      {flutter::EncodableValue("inputEventsCoalesced"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(input_stats.events_coalesced))},
+      {flutter::EncodableValue("captureToDescriptorLatency"),
+       EncodeLatencyHistogram(stats.capture_to_descriptor_latency)},
+      {flutter::EncodableValue("heldFrameLatency"),
+       EncodeLatencyHistogram(stats.held_frame_latency)},
+  });
+}
+
+static flutter::EncodableValue EncodeInputLatency(
+    const InputLatencyTracker::Snapshot& latency) {
+  return flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("inputsReceived"),
+       flutter::EncodableValue(static_cast<int64_t>(latency.inputs_received))},
+      {flutter::EncodableValue("inputsMatched"),
+       flutter::EncodableValue(static_cast<int64_t>(latency.inputs_matched))},
+      {flutter::EncodableValue("inputsUnmatched"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(latency.inputs_unmatched))},
+      {flutter::EncodableValue("lastMatchedSequence"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(latency.last_matched_sequence))},
+      {flutter::EncodableValue("deliveryLatency"),
+       EncodeLatencyHistogram(latency.delivery_latency)},
+      {flutter::EncodableValue("queueLatency"),
+       EncodeLatencyHistogram(latency.queue_latency)},
+      {flutter::EncodableValue("renderLatency"),
+       EncodeLatencyHistogram(latency.render_latency)},
+      {flutter::EncodableValue("totalLatency"),
+       EncodeLatencyHistogram(latency.total_latency)},
+  });
+}
+
 static const std::string& GetCursorName(const HCURSOR cursor) {
   // The cursor names correspond to the Flutter Engine names:
   // in shell/platform/windows/flutter_window_win32.cc
@@ -138,23 +313,56 @@ static const std::string& GetCursorName(const HCURSOR cursor) {
 WebviewBridge::WebviewBridge(flutter::BinaryMessenger* messenger,
                              flutter::TextureRegistrar* texture_registrar,
                              GraphicsContext* graphics_context,
-                             std::unique_ptr<Webview> webview)
-    : webview_(std::move(webview)), texture_registrar_(texture_registrar) {
-  texture_bridge_ =
-      std::make_unique<TextureBridgeGpu>(graphics_context, webview_->surface());
-
-  flutter_texture_ =
-      std::make_unique<flutter::TextureVariant>(flutter::GpuSurfaceTexture(
-          kFlutterDesktopGpuSurfaceTypeDxgiSharedHandle,
-          [bridge = static_cast<TextureBridgeGpu*>(texture_bridge_.get())](
-              size_t width,
-              size_t height) -> const FlutterDesktopGpuSurfaceDescriptor* {
-            return bridge->GetSurfaceDescriptor(width, height);
-          }));
+                             TaskRunner* task_runner,
+                             std::unique_ptr<Webview> webview,
+                             const TextureBridgeOptions& texture_bridge_options)
+    : webview_(std::move(webview)),
+      texture_registrar_(texture_registrar),
+      task_runner_(task_runner),
+      graphics_context_(graphics_context) {
+  if (texture_bridge_options.texture_mode == TextureMode::kPixelBuffer) {
+    auto bridge = std::make_unique<TextureBridgePixelBuffer>(
+        graphics_context, webview_->surface(), task_runner,
+        texture_bridge_options);
+    flutter_texture_ =
+        std::make_unique<flutter::TextureVariant>(flutter::PixelBufferTexture(
+            [bridge = bridge.get()](
+                size_t width,
+                size_t height) -> const FlutterDesktopPixelBuffer* {
+              return bridge->CopyPixelBuffer(width, height);
+            }));
+    texture_bridge_ = std::move(bridge);
+  } else {
+    auto bridge = std::make_unique<TextureBridgeGpu>(
+        graphics_context, webview_->surface(), task_runner,
+        texture_bridge_options);
+    flutter_texture_ =
+        std::make_unique<flutter::TextureVariant>(flutter::GpuSurfaceTexture(
+            kFlutterDesktopGpuSurfaceTypeDxgiSharedHandle,
+            [bridge = bridge.get()](size_t width, size_t height)
+                -> const FlutterDesktopGpuSurfaceDescriptor* {
+              return bridge->GetSurfaceDescriptor(width, height);
+            }));
+    texture_bridge_ = std::move(bridge);
+  }
 
   texture_id_ = texture_registrar->RegisterTexture(flutter_texture_.get());
-  texture_bridge_->SetOnFrameAvailable(
-      [this]() { texture_registrar_->MarkTextureFrameAvailable(texture_id_); });
+  texture_bridge_->SetOnFrameAvailable([this]() {
+    // The page rendered, hand it the input collected in the meantime.
+    webview_->FlushInput();
+    texture_registrar_->MarkTextureFrameAvailable(texture_id_);
+  });
+  texture_bridge_->SetOnFrameArrived(
+      [this](std::chrono::steady_clock::time_point arrival_time) {
+        input_latency_tracker_.OnFrameArrived(arrival_time);
+      });
+  webview_->OnInputDispatched([this](bool injected) {
+    if (injected) {
+      input_latency_tracker_.OnInputInjected();
+    } else {
+      input_latency_tracker_.OnInputDropped();
+    }
+  });
   // texture_bridge_->SetOnSurfaceSizeChanged([this](Size size) {
   //  webview_->SetSurfaceSize(size.width, size.height);
   //});
@@ -194,6 +402,15 @@ WebviewBridge::WebviewBridge(flutter::BinaryMessenger* messenger,
 }
 
 WebviewBridge::~WebviewBridge() {
+  frame_stats_timer_ = nullptr;
+  resize_timer_ = nullptr;
+  input_timer_ = nullptr;
+  raster_scale_timer_ = nullptr;
+  thumbnail_timer_ = nullptr;
+  recording_timer_ = nullptr;
+  readback_timer_ = nullptr;
+  readback_scheduler_ = nullptr;
+  frame_recorder_ = nullptr;
   method_channel_->SetMethodCallHandler(nullptr);
   texture_registrar_->UnregisterTexture(texture_id_);
 }
@@ -219,6 +436,7 @@ void WebviewBridge::RegisterEventHandlers() {
   });
 
   webview_->OnLoadingStateChanged([this](WebviewLoadingState state) {
+    texture_bridge_->NotifyActivity();
     const auto event = flutter::EncodableValue(flutter::EncodableMap{
         {flutter::EncodableValue(kEventType),
          flutter::EncodableValue("loadingStateChanged")},
@@ -312,6 +530,24 @@ void WebviewBridge::RegisterEventHandlers() {
         OnPermissionRequested(url, kind, is_user_initiated, completer);
       });
 
+  texture_bridge_->SetOnFpsGovernorDecisionChanged(
+      [this](const FpsGovernor::Decision& decision) {
+        const auto event = flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue(kEventType),
+             flutter::EncodableValue("fpsGovernorChanged")},
+            {flutter::EncodableValue(kEventValue),
+             flutter::EncodableValue(flutter::EncodableMap{
+                 {flutter::EncodableValue("level"),
+                  flutter::EncodableValue(static_cast<int>(decision.level))},
+                 {flutter::EncodableValue("maxFps"),
+                  decision.max_fps.has_value()
+                      ? flutter::EncodableValue(*decision.max_fps)
+                      : flutter::EncodableValue()},
+             })},
+        });
+        EmitEvent(event);
+      });
+
   webview_->OnContainsFullScreenElementChanged(
       [this](bool contains_fullscreen_element) {
         const auto event = flutter::EncodableValue(flutter::EncodableMap{
@@ -323,6 +559,215 @@ void WebviewBridge::RegisterEventHandlers() {
       });
 }
 
+void WebviewBridge::ApplySurfaceSize(const ResizeCoalescer::Size& size) {
+  // The initial size isn't a resize.
+  if (applied_size_) {
+    raster_scale_policy_.OnResize();
+  }
+  applied_size_ = size;
+  ApplyRasterScale();
+}
+
+void WebviewBridge::ApplyRasterScale() {
+  if (!applied_size_) {
+    return;
+  }
+
+  // The texture gets upscaled while the scale is reduced.
+  const auto scale = static_cast<float>(raster_scale_policy_.scale());
+  webview_->SetSurfaceSize(applied_size_->width, applied_size_->height,
+                           applied_size_->scale_factor * scale);
+  ApplyVisibleRect();
+}
+
+void WebviewBridge::ApplyVisibleRect() {
+  if (!visible_rect_) {
+    return texture_bridge_->SetVisibleRect(std::nullopt);
+  }
+
+  // Round outwards so that partially covered pixels stay up to date.
+  const auto scale = raster_scale_policy_.scale();
+  const auto& rect = *visible_rect_;
+  const auto left = std::floor(rect.x * scale);
+  const auto top = std::floor(rect.y * scale);
+  const auto right = std::ceil((uint64_t{rect.x} + rect.width) * scale);
+  const auto bottom = std::ceil((uint64_t{rect.y} + rect.height) * scale);
+  texture_bridge_->SetVisibleRect(CopyRegionPlanner::Rect{
+      static_cast<uint32_t>(left), static_cast<uint32_t>(top),
+      static_cast<uint32_t>(right - left),
+      static_cast<uint32_t>(bottom - top)});
+}
+
+void WebviewBridge::SchedulePendingResize() {
+  if (!resize_coalescer_.deadline().has_value()) {
+    return;
+  }
+
+  if (resize_timer_) {
+    resize_timer_->Start();
+    return;
+  }
+
+  resize_timer_ =
+      task_runner_->CreateTimer(resize_coalescer_.interval(), [this]() {
+        if (const auto size = resize_coalescer_.Poll()) {
+          ApplySurfaceSize(*size);
+        }
+        if (!resize_coalescer_.deadline().has_value()) {
+          resize_timer_->Stop();
+        }
+      });
+  if (!resize_timer_) {
+    std::cerr << "Scheduling the pending resize failed." << std::endl;
+  }
+}
+
+void WebviewBridge::ScheduleInputFlush() {
+  if (!webview_->input_deadline().has_value()) {
+    return;
+  }
+
+  if (input_timer_) {
+    input_timer_->Start();
+    return;
+  }
+
+  input_timer_ =
+      task_runner_->CreateTimer(webview_->input_max_delay(), [this]() {
+        webview_->FlushInputIfDue();
+        if (!webview_->input_deadline().has_value()) {
+          input_timer_->Stop();
+        }
+      });
+  if (!input_timer_) {
+    std::cerr << "Scheduling the input flush failed." << std::endl;
+    webview_->FlushInput();
+  }
+}
+
+void WebviewBridge::CapturePixels(
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
+      shared_result = std::move(result);
+  const bool submitted = SubmitReadback(
+      [shared_result](std::optional<PixelReadback::Image> image) {
+        if (!image) {
+          return shared_result->Error(kMethodFailed,
+                                      "Reading back the frame failed.");
+        }
+        shared_result->Success(EncodeImage(std::move(*image)));
+      },
+      nullptr);
+  if (!submitted) {
+    return shared_result->Error(kMethodFailed, "No frame available.");
+  }
+}
+
+void WebviewBridge::CaptureThumbnail() {
+  // Skip a refresh rather than queueing up readbacks.
+  if (thumbnail_pending_ || !thumbnail_size_) {
+    return;
+  }
+
+  thumbnail_pending_ = SubmitReadback(
+      [this](std::optional<PixelReadback::Image> image) {
+        thumbnail_pending_ = false;
+        if (image) {
+          EmitEvent(flutter::EncodableValue(flutter::EncodableMap{
+              {flutter::EncodableValue(kEventType),
+               flutter::EncodableValue("thumbnail")},
+              {flutter::EncodableValue(kEventValue),
+               EncodeImage(std::move(*image))},
+          }));
+        }
+      },
+      [this](const ReadbackMapping& mapping, size_t width,
+             size_t height) -> std::optional<PixelReadback::Image> {
+        if (!thumbnail_size_) {
+          return std::nullopt;
+        }
+        return FitImage(thumbnail_scaler_, texture_bridge_->pixel_format(),
+                        mapping, width, height, thumbnail_size_->first,
+                        thumbnail_size_->second);
+      });
+}
+
+void WebviewBridge::RecordFrame() {
+  // Skip a frame rather than queueing up readbacks.
+  if (recording_pending_ || !frame_recorder_) {
+    return;
+  }
+
+  const int64_t timestamp_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  recording_pending_ = SubmitReadback(
+      [this, timestamp_us](std::optional<PixelReadback::Image> image) {
+        recording_pending_ = false;
+        if (image && frame_recorder_) {
+          // Only queues the frame for the recorder's writer thread.
+          frame_recorder_->Record(std::move(image->pixels),
+                                  static_cast<uint32_t>(image->width),
+                                  static_cast<uint32_t>(image->height),
+                                  timestamp_us);
+        }
+      },
+      [this](const ReadbackMapping& mapping, size_t width,
+             size_t height) -> std::optional<PixelReadback::Image> {
+        if (!frame_recorder_) {
+          return std::nullopt;
+        }
+        const auto& config = frame_recorder_->config();
+        return FitImage(recording_scaler_, texture_bridge_->pixel_format(),
+                        mapping, width, height, config.max_width,
+                        config.max_height);
+      });
+}
+
+bool WebviewBridge::SubmitReadback(PixelReadback::Callback callback,
+                                   PixelReadback::Converter converter) {
+  if (!readback_scheduler_) {
+    const auto pixel_format = texture_bridge_->pixel_format();
+    PixelReadback::Config config;
+    config.format = pixel_format;
+    readback_scheduler_ = std::make_unique<PixelReadback>(
+        D3DReadbackDevice(graphics_context_, pixel_format), config);
+  }
+  // The staging textures and converters assume the format they were created
+  // for, which is why the texture bridge may never change it.
+  assert(readback_scheduler_->config().format ==
+         texture_bridge_->pixel_format());
+
+  const bool submitted = texture_bridge_->ReadCurrentFrame(
+      [&](ID3D11Texture2D* texture, uint32_t width, uint32_t height) {
+        return readback_scheduler_->Submit(texture, width, height,
+                                           std::move(callback),
+                                           std::move(converter));
+      });
+  if (submitted) {
+    ScheduleReadbackPoll();
+  }
+  return submitted;
+}
+
+void WebviewBridge::ScheduleReadbackPoll() {
+  if (readback_timer_) {
+    readback_timer_->Start();
+    return;
+  }
+
+  readback_timer_ = task_runner_->CreateTimer(kReadbackPollInterval, [this]() {
+    if (readback_scheduler_->Poll() == 0) {
+      readback_timer_->Stop();
+    }
+  });
+  if (!readback_timer_) {
+    std::cerr << "Scheduling the readback failed." << std::endl;
+    readback_scheduler_->CancelAll();
+  }
+}
+
 void WebviewBridge::OnPermissionRequested(
     const std::string& url,
     WebviewPermissionKind permissionKind,
@@ -352,6 +797,23 @@ void WebviewBridge::OnPermissionRequested(
           [completer]() { completer(WebviewPermissionState::Default); }));
 }
 
+void WebviewBridge::ReplayInput(const InputBatch::Record& record) {
+  switch (record.kind) {
+    case InputBatch::Kind::kCursorPos:
+      return webview_->SetCursorPos(record.x, record.y);
+    case InputBatch::Kind::kPointerUpdate:
+      return webview_->SetPointerUpdate(
+          record.pointer, static_cast<WebviewPointerEventKind>(record.event),
+          record.x, record.y, record.size, record.pressure);
+    case InputBatch::Kind::kPointerButton:
+      return webview_->SetPointerButtonState(
+          static_cast<WebviewPointerButton>(record.event),
+          (record.buttons & InputBatch::ButtonMask(record.event)) != 0);
+    case InputBatch::Kind::kScrollDelta:
+      return webview_->SetScrollDelta(record.x, record.y);
+  }
+}
+
 void WebviewBridge::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
@@ -361,7 +823,10 @@ void WebviewBridge::HandleMethodCall(
   if (method_name.compare(kMethodSetCursorPos) == 0) {
     const auto point = GetPointFromArgs(method_call.arguments());
     if (point) {
+      texture_bridge_->NotifyActivity();
+      input_latency_tracker_.OnInputReceived(0, std::nullopt);
       webview_->SetCursorPos(point->first, point->second);
+      ScheduleInputFlush();
       return result->Success();
     }
     return result->Error(kErrorInvalidArgs);
@@ -384,19 +849,25 @@ void WebviewBridge::HandleMethodCall(
     const auto pressure = std::get_if<double>(&(*list)[5]);
 
     if (pointer && event && x && y && size && pressure) {
+      texture_bridge_->NotifyActivity();
+      input_latency_tracker_.OnInputReceived(0, std::nullopt);
       webview_->SetPointerUpdate(*pointer,
                                  static_cast<WebviewPointerEventKind>(*event),
                                  *x, *y, *size, *pressure);
+      ScheduleInputFlush();
       return result->Success();
     }
     return result->Error(kErrorInvalidArgs);
   }
 
-  // setScrollDelta: [double dx, double dy]
+  // setScrollDelta: [double dx, double dy] in physical pixels
   if (method_name.compare(kMethodSetScrollDelta) == 0) {
     const auto delta = GetPointFromArgs(method_call.arguments());
     if (delta) {
+      texture_bridge_->NotifyActivity();
+      input_latency_tracker_.OnInputReceived(0, std::nullopt);
       webview_->SetScrollDelta(delta->first, delta->second);
+      ScheduleInputFlush();
       return result->Success();
     }
     return result->Error(kErrorInvalidArgs);
@@ -412,6 +883,8 @@ void WebviewBridge::HandleMethodCall(
       const auto buttonValue = std::get_if<int32_t>(&button->second);
       const auto isDownValue = std::get_if<bool>(&isDown->second);
       if (buttonValue && isDownValue) {
+        texture_bridge_->NotifyActivity();
+        input_latency_tracker_.OnInputReceived(0, std::nullopt);
         webview_->SetPointerButtonState(
             static_cast<WebviewPointerButton>(*buttonValue), *isDownValue);
         return result->Success();
@@ -420,15 +893,51 @@ void WebviewBridge::HandleMethodCall(
     return result->Error(kErrorInvalidArgs);
   }
 
+  // sendInputBatch: Uint8List of records, see input_batch.h
+  if (method_name.compare(kMethodSendInputBatch) == 0) {
+    const auto bytes =
+        std::get_if<std::vector<uint8_t>>(method_call.arguments());
+    input_records_.clear();
+    if (!bytes ||
+        !InputBatch::Decode(bytes->data(), bytes->size(), input_records_)) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    if (!input_records_.empty()) {
+      texture_bridge_->NotifyActivity();
+    }
+    for (const auto& record : input_records_) {
+      // The engine timestamps events with the same monotonic clock (QPC) as
+      // steady_clock, implausible ones are dropped by the tracker.
+      input_latency_tracker_.OnInputReceived(
+          record.sequence,
+          record.timestamp_us > 0
+              ? std::make_optional(InputLatencyTracker::TimePoint(
+                    std::chrono::microseconds(record.timestamp_us)))
+              : std::nullopt);
+      ReplayInput(record);
+    }
+    ScheduleInputFlush();
+    return result->Success();
+  }
+
   // setSize: [double width, double height, double scale_factor]
   if (method_name.compare(kMethodSetSize) == 0) {
     auto size = GetPointAndScaleFactorFromArgs(method_call.arguments());
     if (size) {
       const auto [width, height, scale_factor] = size.value();
 
-      webview_->SetSurfaceSize(static_cast<size_t>(width),
-                               static_cast<size_t>(height),
-                               static_cast<float>(scale_factor));
+      // Window drags cause bursts of resizes, each of which recreates the
+      // capture pool, so apply at most one per frame.
+      const bool had_pending_resize = resize_coalescer_.deadline().has_value();
+      if (const auto resize = resize_coalescer_.Request(
+              {static_cast<size_t>(width), static_cast<size_t>(height),
+               static_cast<float>(scale_factor)})) {
+        ApplySurfaceSize(*resize);
+      }
+      if (!had_pending_resize) {
+        SchedulePendingResize();
+      }
 
       texture_bridge_->Start();
       return result->Success();
@@ -695,5 +1204,258 @@ void WebviewBridge::HandleMethodCall(
     }
   }
 
+  // setAdaptiveFps: bool
+  if (method_name.compare(kMethodSetAdaptiveFps) == 0) {
+    if (const auto enabled = std::get_if<bool>(method_call.arguments())) {
+      texture_bridge_->SetAdaptiveFpsEnabled(*enabled);
+      return result->Success();
+    }
+    return result->Error(kErrorInvalidArgs);
+  }
+
+  // setVisibleRect: [x, y, width, height] or null
+  if (method_name.compare(kMethodSetVisibleRect) == 0) {
+    if (method_call.arguments()->IsNull()) {
+      visible_rect_.reset();
+      ApplyVisibleRect();
+      return result->Success();
+    }
+
+    const auto list =
+        std::get_if<flutter::EncodableList>(method_call.arguments());
+    if (!list || list->size() != 4) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    int32_t values[4];
+    for (size_t i = 0; i < 4; i++) {
+      const auto value = std::get_if<int32_t>(&(*list)[i]);
+      if (!value || *value < 0) {
+        return result->Error(kErrorInvalidArgs);
+      }
+      values[i] = *value;
+    }
+    visible_rect_ = CopyRegionPlanner::Rect{
+        static_cast<uint32_t>(values[0]), static_cast<uint32_t>(values[1]),
+        static_cast<uint32_t>(values[2]), static_cast<uint32_t>(values[3])};
+    ApplyVisibleRect();
+    return result->Success();
+  }
+
+  // setDynamicResolution: bool
+  if (method_name.compare(kMethodSetDynamicResolution) == 0) {
+    const auto enabled = std::get_if<bool>(method_call.arguments());
+    if (!enabled) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    raster_scale_timer_ = nullptr;
+    if (raster_scale_policy_.SetEnabled(*enabled)) {
+      ApplyRasterScale();
+    }
+    if (*enabled) {
+      raster_scale_timer_ =
+          task_runner_->CreateTimer(kRasterScalePollInterval, [this]() {
+            const auto stats = texture_bridge_->GetFrameStats();
+            // Suppressed and dropped frames never reach the consumer.
+            const RasterScalePolicy::FrameCounts counts = {
+                stats.frames_arrived - stats.frames_dropped -
+                    stats.frames_suppressed,
+                stats.copies_made};
+            if (raster_scale_policy_.Update(counts)) {
+              ApplyRasterScale();
+            }
+          });
+      if (!raster_scale_timer_) {
+        raster_scale_policy_.SetEnabled(false);
+        return result->Error(kMethodFailed, "Creating the timer failed.");
+      }
+    }
+    return result->Success();
+  }
+
+  // getFrameStats
+  if (method_name.compare(kMethodGetFrameStats) == 0) {
+    return result->Success(EncodeFrameStats(texture_bridge_->GetFrameStats(),
+                                            resize_coalescer_.stats(),
+                                            webview_->input_stats()));
+  }
+
+  // getInputLatency
+  if (method_name.compare(kMethodGetInputLatency) == 0) {
+    return result->Success(
+        EncodeInputLatency(input_latency_tracker_.GetSnapshot()));
+  }
+
+  // setFrameStatsInterval: int milliseconds, 0 disables
+  if (method_name.compare(kMethodSetFrameStatsInterval) == 0) {
+    if (const auto interval = std::get_if<int32_t>(method_call.arguments())) {
+      if (*interval < 0) {
+        return result->Error(kErrorInvalidArgs);
+      }
+
+      frame_stats_timer_ = nullptr;
+      if (*interval > 0) {
+        frame_stats_timer_ = task_runner_->CreateTimer(
+            std::chrono::milliseconds(*interval), [this]() {
+              const auto event = flutter::EncodableValue(flutter::EncodableMap{
+                  {flutter::EncodableValue(kEventType),
+                   flutter::EncodableValue("frameStats")},
+                  {flutter::EncodableValue(kEventValue),
+                   EncodeFrameStats(texture_bridge_->GetFrameStats(),
+                                    resize_coalescer_.stats(),
+                                    webview_->input_stats())},
+              });
+              EmitEvent(event);
+            });
+        if (!frame_stats_timer_) {
+          return result->Error(kMethodFailed, "Creating the timer failed.");
+        }
+      }
+      return result->Success();
+    }
+    return result->Error(kErrorInvalidArgs);
+  }
+
+  // capturePixels
+  if (method_name.compare(kMethodCapturePixels) == 0) {
+    return CapturePixels(std::move(result));
+  }
+
+  // setThumbnailMode: [int maxWidth, int maxHeight, int intervalMs], null
+  // disables
+  if (method_name.compare(kMethodSetThumbnailMode) == 0) {
+    if (method_call.arguments()->IsNull()) {
+      thumbnail_timer_ = nullptr;
+      thumbnail_size_.reset();
+      return result->Success();
+    }
+
+    const auto list =
+        std::get_if<flutter::EncodableList>(method_call.arguments());
+    if (!list || list->size() != 3) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    const auto max_width = std::get_if<int32_t>(&(*list)[0]);
+    const auto max_height = std::get_if<int32_t>(&(*list)[1]);
+    const auto interval = std::get_if<int32_t>(&(*list)[2]);
+    if (!max_width || !max_height || !interval || *max_width <= 0 ||
+        *max_height <= 0 || *interval <= 0) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    thumbnail_size_ = std::make_pair(static_cast<size_t>(*max_width),
+                                     static_cast<size_t>(*max_height));
+    thumbnail_timer_ = task_runner_->CreateTimer(
+        std::chrono::milliseconds(*interval), [this]() { CaptureThumbnail(); });
+    if (!thumbnail_timer_) {
+      thumbnail_size_.reset();
+      return result->Error(kMethodFailed, "Creating the timer failed.");
+    }
+    CaptureThumbnail();
+    return result->Success();
+  }
+
+  // startFrameRecording: [path, maxWidth, maxHeight, fps, seconds]
+  if (method_name.compare(kMethodStartFrameRecording) == 0) {
+    const auto list =
+        std::get_if<flutter::EncodableList>(method_call.arguments());
+    if (!list || list->size() != 5) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    const auto path = std::get_if<std::string>(&(*list)[0]);
+    const auto max_width = std::get_if<int32_t>(&(*list)[1]);
+    const auto max_height = std::get_if<int32_t>(&(*list)[2]);
+    const auto fps = std::get_if<int32_t>(&(*list)[3]);
+    const auto seconds = std::get_if<int32_t>(&(*list)[4]);
+    if (!path || !max_width || !max_height || !fps || !seconds ||
+        *max_width <= 0 || *max_height <= 0 || *fps <= 0 || *fps > 60 ||
+        *seconds <= 0 || *seconds > kMaxRecordingSeconds) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    FrameRecorder::Config config;
+    config.path = *path;
+    config.max_width = static_cast<uint32_t>(*max_width);
+    config.max_height = static_cast<uint32_t>(*max_height);
+    config.slot_count = static_cast<uint32_t>(*fps * *seconds);
+    if (!FrameRecorder::IsValid(config)) {
+      return result->Error(kErrorInvalidArgs);
+    }
+
+    // The previous recording may use the same file.
+    recording_timer_ = nullptr;
+    frame_recorder_ = nullptr;
+    frame_recorder_ = FrameRecorder::Create(config);
+    if (!frame_recorder_) {
+      return result->Error(kMethodFailed, "Creating the file failed.");
+    }
+
+    recording_timer_ = task_runner_->CreateTimer(
+        std::chrono::milliseconds(1000 / *fps), [this]() { RecordFrame(); });
+    if (!recording_timer_) {
+      frame_recorder_ = nullptr;
+      return result->Error(kMethodFailed, "Creating the timer failed.");
+    }
+    RecordFrame();
+    return result->Success();
+  }
+
+  // stopFrameRecording
+  if (method_name.compare(kMethodStopFrameRecording) == 0) {
+    recording_timer_ = nullptr;
+    frame_recorder_ = nullptr;
+    return result->Success();
+  }
+
+  // dumpFrameRecording: string
+  if (method_name.compare(kMethodDumpFrameRecording) == 0) {
+    const auto path = std::get_if<std::string>(method_call.arguments());
+    if (!path) {
+      return result->Error(kErrorInvalidArgs);
+    }
+    if (!frame_recorder_) {
+      return result->Error(kMethodFailed, "Not recording.");
+    }
+
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
+        shared_result = std::move(result);
+    auto task_runner = task_runner_;
+    // Runs on the recorder's writer thread.
+    frame_recorder_->Dump(*path, [task_runner, shared_result](bool success) {
+      task_runner->PostTask([shared_result, success]() {
+        if (!success) {
+          return shared_result->Error(kMethodFailed,
+                                      "Writing the file failed.");
+        }
+        shared_result->Success();
+      });
+    });
+    return;
+  }
+
+  // getDirtyRects
+  if (method_name.compare(kMethodGetDirtyRects) == 0) {
+    const auto rects = texture_bridge_->GetDirtyRects();
+    if (!rects) {
+      return result->Success();
+    }
+
+    flutter::EncodableList list;
+    list.reserve(rects->size());
+    for (const auto& rect : *rects) {
+      list.push_back(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("x"),
+           flutter::EncodableValue(static_cast<int32_t>(rect.x))},
+          {flutter::EncodableValue("y"),
+           flutter::EncodableValue(static_cast<int32_t>(rect.y))},
+          {flutter::EncodableValue("width"),
+           flutter::EncodableValue(static_cast<int32_t>(rect.width))},
+          {flutter::EncodableValue("height"),
+           flutter::EncodableValue(static_cast<int32_t>(rect.height))},
+      }));
+    }
+    return result->Success(flutter::EncodableValue(std::move(list)));
+  }
+
   result->NotImplemented();
 }
@@ -6,17 +6,30 @@
 #include <flutter/texture_registrar.h>
 
 #include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
+#include "d3d_readback_device.h"
+#include "frame_recorder.h"
 #include "graphics_context.h"
+#include "input_batch.h"
+#include "input_latency_tracker.h"
+#include "raster_scale_policy.h"
+#include "readback_scheduler.h"
+#include "resize_coalescer.h"
+#include "task_runner.h"
 #include "texture_bridge.h"
+#include "util/downscale.h"
 #include "webview.h"
 
 class WebviewBridge {
  public:
   WebviewBridge(flutter::BinaryMessenger* messenger,
                 flutter::TextureRegistrar* texture_registrar,
-                GraphicsContext* graphics_context,
-                std::unique_ptr<Webview> webview);
+                GraphicsContext* graphics_context, TaskRunner* task_runner,
+                std::unique_ptr<Webview> webview,
+                const TextureBridgeOptions& texture_bridge_options);
   ~WebviewBridge();
 
   TextureBridge* texture_bridge() const { return texture_bridge_.get(); }
@@ -24,6 +37,8 @@ class WebviewBridge {
   int64_t texture_id() const { return texture_id_; }
 
  private:
+  // Outlives |texture_bridge_|, whose capture thread reports frames to it.
+  InputLatencyTracker input_latency_tracker_;
   std::unique_ptr<flutter::TextureVariant> flutter_texture_;
   std::unique_ptr<TextureBridge> texture_bridge_;
   std::unique_ptr<Webview> webview_;
@@ -34,12 +49,66 @@ class WebviewBridge {
       method_channel_;
 
   flutter::TextureRegistrar* texture_registrar_;
+  TaskRunner* task_runner_;
+  // Periodically emits frame statistics while set.
+  std::unique_ptr<TaskRunner::Timer> frame_stats_timer_;
+  // Reused across input batches to avoid allocating per call.
+  std::vector<InputBatch::Record> input_records_;
+  // Flushes input the webview queued if no frame arrives in time.
+  std::unique_ptr<TaskRunner::Timer> input_timer_;
+  ResizeCoalescer resize_coalescer_;
+  // Applies the final size of a burst of resizes.
+  std::unique_ptr<TaskRunner::Timer> resize_timer_;
+  // The size last applied, at full scale.
+  std::optional<ResizeCoalescer::Size> applied_size_;
+  RasterScalePolicy raster_scale_policy_;
+  // Samples frame counters for |raster_scale_policy_| while it's enabled.
+  std::unique_ptr<TaskRunner::Timer> raster_scale_timer_;
+  // In physical pixels, see |ApplyVisibleRect|.
+  std::optional<CopyRegionPlanner::Rect> visible_rect_;
+  typedef ReadbackScheduler<D3DReadbackDevice> PixelReadback;
+
+  GraphicsContext* graphics_context_;
+  // Created on first use.
+  std::unique_ptr<PixelReadback> readback_scheduler_;
+  // Polls |readback_scheduler_| while readbacks are pending.
+  std::unique_ptr<TaskRunner::Timer> readback_timer_;
+  // The bounds of thumbnails while thumbnail mode is enabled.
+  std::optional<std::pair<size_t, size_t>> thumbnail_size_;
+  bool thumbnail_pending_ = false;
+  util::Downscaler thumbnail_scaler_;
+  // Refreshes the thumbnail at the rate set by |setThumbnailMode|.
+  std::unique_ptr<TaskRunner::Timer> thumbnail_timer_;
+  // Set while frames are recorded for diagnostics.
+  std::unique_ptr<FrameRecorder> frame_recorder_;
+  bool recording_pending_ = false;
+  util::Downscaler recording_scaler_;
+  // Feeds |frame_recorder_| at the rate set by |startFrameRecording|.
+  std::unique_ptr<TaskRunner::Timer> recording_timer_;
   int64_t texture_id_;
 
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void RegisterEventHandlers();
+  void ReplayInput(const InputBatch::Record& record);
+  void ScheduleInputFlush();
+  void ApplySurfaceSize(const ResizeCoalescer::Size& size);
+  // Applies |applied_size_| at the scale chosen by |raster_scale_policy_|.
+  void ApplyRasterScale();
+  // Hands |visible_rect_| to the texture bridge in texture pixels, which
+  // differ from physical pixels while the rasterization scale is reduced.
+  void ApplyVisibleRect();
+  void SchedulePendingResize();
+  void CapturePixels(
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void CaptureThumbnail();
+  void RecordFrame();
+  // Reads back the newest captured frame. Returns false, without invoking
+  // |callback|, if there is none.
+  bool SubmitReadback(PixelReadback::Callback callback,
+                      PixelReadback::Converter converter);
+  void ScheduleReadbackPoll();
 
   template <typename T>
   void EmitEvent(const T& value) {
@@ -51,7 +51,29 @@ std::unique_ptr<WebviewHost> WebviewHost::Create(
 
 WebviewHost::WebviewHost(WebviewPlatform* platform,
                          wil::com_ptr<ICoreWebView2Environment3> webview_env)
-    : webview_env_(webview_env) {
+    : webview_env_(webview_env),
+      pointer_info_pool_(
+          [this]() {
+            wil::com_ptr<ICoreWebView2PointerInfo> pointer_info;
+            pointer_info_error_ =
+                webview_env_->CreateCoreWebView2PointerInfo(pointer_info.put());
+            return SUCCEEDED(pointer_info_error_) ? pointer_info : nullptr;
+          },
+          [](const wil::com_ptr<ICoreWebView2PointerInfo>& pointer_info) {
+            // Clear whatever the previous pointer may have set.
+            pointer_info->put_PointerFlags(POINTER_FLAG_NONE);
+            pointer_info->put_FrameId(0);
+            pointer_info->put_Time(0);
+            pointer_info->put_HistoryCount(0);
+            pointer_info->put_PerformanceCount(0);
+            pointer_info->put_KeyStates(0);
+            pointer_info->put_ButtonChangeKind(POINTER_CHANGE_NONE);
+            pointer_info->put_TouchFlags(TOUCH_FLAG_NONE);
+            pointer_info->put_TouchMask(TOUCH_MASK_NONE);
+            pointer_info->put_TouchPressure(0);
+            pointer_info->put_PixelLocationRaw(POINT{});
+            pointer_info->put_TouchContactRaw(RECT{});
+          }) {
   compositor_ = platform->graphics_context()->CreateCompositor();
 }
 
@@ -72,18 +94,22 @@ void WebviewHost::CreateWebview(HWND hwnd, bool offscreen_only,
       });
 }
 
-void WebviewHost::CreateWebViewPointerInfo(PointerInfoCreationCallback callback) {
-
-  ICoreWebView2PointerInfo *pointer;
-  auto hr = webview_env_->CreateCoreWebView2PointerInfo(&pointer);
-
-  if (FAILED(hr)) {
-    callback(nullptr, WebviewCreationError::create(hr, "CreateWebViewPointerInfo failed."));
-  } else if (SUCCEEDED(hr)) {
-    callback(std::move(wil::com_ptr<ICoreWebView2PointerInfo>(pointer)), nullptr);
+void WebviewHost::CreateWebViewPointerInfo(
+    int32_t pointer_id, PointerInfoCreationCallback callback) {
+  auto pointer_info = pointer_info_pool_.Acquire(pointer_id);
+  if (!pointer_info) {
+    callback(nullptr, WebviewCreationError::create(
+                          pointer_info_error_,
+                          "CreateWebViewPointerInfo failed."));
+  } else {
+    callback(std::move(pointer_info), nullptr);
   }
 }
 
+void WebviewHost::ReleaseWebViewPointerInfo(int32_t pointer_id) {
+  pointer_info_pool_.Release(pointer_id);
+}
+
 void WebviewHost::CreateWebViewCompositionController(
     HWND hwnd, CompositionControllerCreationCallback callback) {
   auto hr = webview_env_->CreateCoreWebView2CompositionController(
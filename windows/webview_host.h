@@ -7,6 +7,7 @@
 #include <functional>
 
 #include "graphics_context.h"
+#include "keyed_object_pool.h"
 #include "webview.h"
 #include "webview_platform.h"
 #include "windows.ui.composition.h"
@@ -35,6 +36,8 @@ class WebviewHost {
   typedef std::function<void(wil::com_ptr<ICoreWebView2PointerInfo>,
                              std::unique_ptr<WebviewCreationError>)>
       PointerInfoCreationCallback;
+  typedef KeyedObjectPool<int32_t, wil::com_ptr<ICoreWebView2PointerInfo>>
+      PointerInfoPool;
 
   static std::unique_ptr<WebviewHost> Create(
       WebviewPlatform* platform,
@@ -45,7 +48,14 @@ class WebviewHost {
   void CreateWebview(HWND hwnd, bool offscreen_only, bool owns_window,
                      WebviewCreationCallback callback);
 
-  void CreateWebViewPointerInfo(PointerInfoCreationCallback cb);
+  // Hands out the same object for |pointer_id| until it's released via
+  // |ReleaseWebViewPointerInfo|, after which it's reused for other pointers.
+  void CreateWebViewPointerInfo(int32_t pointer_id,
+                                PointerInfoCreationCallback cb);
+  void ReleaseWebViewPointerInfo(int32_t pointer_id);
+  PointerInfoPool::Stats pointer_info_pool_stats() const {
+    return pointer_info_pool_.stats();
+  }
 
   winrt::com_ptr<ABI::Windows::UI::Composition::ICompositor> compositor()
       const {
@@ -55,6 +65,9 @@ class WebviewHost {
  private:
   winrt::com_ptr<ABI::Windows::UI::Composition::ICompositor> compositor_;
   wil::com_ptr<ICoreWebView2Environment3> webview_env_;
+  PointerInfoPool pointer_info_pool_;
+  // The error of the last failed pointer info creation.
+  HRESULT pointer_info_error_ = S_OK;
 
   WebviewHost(WebviewPlatform* platform,
               wil::com_ptr<ICoreWebView2Environment3> webview_env);
@@ -19,6 +19,14 @@ WebviewPlatform::WebviewPlatform()
       return;
     }
 
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueue> dispatcher_queue;
+    if (FAILED(dispatcher_queue_controller_->get_DispatcherQueue(
+            dispatcher_queue.put()))) {
+      std::cerr << "Retrieving DispatcherQueue failed." << std::endl;
+      return;
+    }
+    task_runner_ = std::make_unique<TaskRunner>(std::move(dispatcher_queue));
+
     if (!IsGraphicsCaptureSessionSupported()) {
       std::cerr << "Windows::Graphics::Capture::GraphicsCaptureSession is not "
                    "supported."
@@ -7,6 +7,7 @@
 #include <string>
 
 #include "graphics_context.h"
+#include "task_runner.h"
 #include "util/rohelper.h"
 
 class WebviewPlatform {
@@ -21,10 +22,14 @@ class WebviewPlatform {
 
   rx::RoHelper* rohelper() const { return rohelper_.get(); }
 
+  // Runs tasks on the platform thread.
+  TaskRunner* task_runner() const { return task_runner_.get(); }
+
  private:
   std::unique_ptr<rx::RoHelper> rohelper_;
   winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController>
       dispatcher_queue_controller_;
+  std::unique_ptr<TaskRunner> task_runner_;
   std::unique_ptr<GraphicsContext> graphics_context_;
   bool valid_ = false;
 };
@@ -5,10 +5,12 @@
 #include <flutter/standard_method_codec.h>
 #include <windows.h>
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
+#include "gpu_memory_budget.h"
 #include "util/string_converter.h"
 #include "webview_bridge.h"
 #include "webview_host.h"
@@ -23,8 +25,14 @@ constexpr auto kMethodInitialize = "initialize";
 constexpr auto kMethodDispose = "dispose";
 constexpr auto kMethodInitializeEnvironment = "initializeEnvironment";
 constexpr auto kMethodGetWebViewVersion = "getWebViewVersion";
+constexpr auto kMethodSetGpuMemoryBudget = "setGpuMemoryBudget";
+constexpr auto kMethodGetGpuMemoryUsage = "getGpuMemoryUsage";
+constexpr auto kMethodGetPointerInfoPoolStats = "getPointerInfoPoolStats";
+
+constexpr auto kGpuMemoryBudgetUpdateInterval = std::chrono::milliseconds(1000);
 
 constexpr auto kErrorCodeInvalidId = "invalid_id";
+constexpr auto kErrorCodeInvalidArgs = "invalid_arguments";
 constexpr auto kErrorCodeEnvironmentCreationFailed =
     "environment_creation_failed";
 constexpr auto kErrorCodeEnvironmentAlreadyInitialized =
@@ -58,14 +66,19 @@ class WebviewWindowsPlugin : public flutter::Plugin {
   std::unique_ptr<WebviewPlatform> platform_;
   std::unique_ptr<WebviewHost> webview_host_;
   std::unordered_map<int64_t, std::unique_ptr<WebviewBridge>> instances_;
+  GpuMemoryBudget gpu_memory_budget_;
+  // Enforces |gpu_memory_budget_| while a budget is set.
+  std::unique_ptr<TaskRunner::Timer> gpu_memory_budget_timer_;
 
   WNDCLASS window_class_ = {};
   flutter::TextureRegistrar* textures_;
   flutter::BinaryMessenger* messenger_;
 
   bool InitPlatform();
+  void UpdateGpuMemoryBudgetTimer();
 
   void CreateWebviewInstance(
+      const TextureBridgeOptions& texture_bridge_options,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>);
   // Called when a method is called on this plugin's channel from Dart.
   void HandleMethodCall(
@@ -101,6 +114,7 @@ WebviewWindowsPlugin::WebviewWindowsPlugin(flutter::TextureRegistrar* textures,
 }
 
 WebviewWindowsPlugin::~WebviewWindowsPlugin() {
+  gpu_memory_budget_timer_ = nullptr;
   instances_.clear();
   UnregisterClass(window_class_.lpszClassName, nullptr);
 }
@@ -162,14 +176,132 @@ void WebviewWindowsPlugin::HandleMethodCall(
   }
 
   if (method_call.method_name().compare(kMethodInitialize) == 0) {
-    return CreateWebviewInstance(std::move(result));
+    TextureBridgeOptions options;
+    if (const auto map =
+            std::get_if<flutter::EncodableMap>(method_call.arguments())) {
+      const auto frame_buffer_count =
+          GetOptionalValue<int32_t>(*map, "frameBufferCount");
+      if (frame_buffer_count) {
+        if (*frame_buffer_count < 1 ||
+            static_cast<size_t>(*frame_buffer_count) >
+                TextureBridge::kMaxFrameBufferCount) {
+          return result->Error(kErrorCodeInvalidArgs,
+                               "frameBufferCount is out of range");
+        }
+        options.frame_buffer_count = static_cast<size_t>(*frame_buffer_count);
+      }
+
+      const auto free_threaded_capture =
+          GetOptionalValue<bool>(*map, "freeThreadedCapture");
+      if (free_threaded_capture) {
+        options.free_threaded_capture = *free_threaded_capture;
+      }
+
+      const auto texture_mode = GetOptionalValue<int32_t>(*map, "textureMode");
+      if (texture_mode) {
+        if (*texture_mode < 0 ||
+            *texture_mode > static_cast<int32_t>(TextureMode::kPixelBuffer)) {
+          return result->Error(kErrorCodeInvalidArgs,
+                               "textureMode is out of range");
+        }
+        options.texture_mode = static_cast<TextureMode>(*texture_mode);
+      }
+
+      const auto suppress_static_frames =
+          GetOptionalValue<bool>(*map, "suppressStaticFrames");
+      if (suppress_static_frames) {
+        options.suppress_static_frames = *suppress_static_frames;
+      }
+
+      const auto pixel_format = GetOptionalValue<int32_t>(*map, "pixelFormat");
+      if (pixel_format) {
+        if (*pixel_format < 0 ||
+            *pixel_format >
+                static_cast<int32_t>(util::PixelFormat::kRgba16Float)) {
+          return result->Error(kErrorCodeInvalidArgs,
+                               "pixelFormat is out of range");
+        }
+        options.pixel_format = static_cast<util::PixelFormat>(*pixel_format);
+      }
+    }
+    return CreateWebviewInstance(options, std::move(result));
+  }
+
+  // setGpuMemoryBudget: int bytes, null for no limit
+  if (method_call.method_name().compare(kMethodSetGpuMemoryBudget) == 0) {
+    const auto args = method_call.arguments();
+    std::optional<int64_t> budget;
+    if (const auto value = std::get_if<int32_t>(args)) {
+      budget = *value;
+    } else if (const auto value = std::get_if<int64_t>(args)) {
+      budget = *value;
+    } else if (args && !args->IsNull()) {
+      return result->Error(kErrorCodeInvalidArgs);
+    }
+
+    if (budget.has_value() && *budget < 0) {
+      return result->Error(kErrorCodeInvalidArgs, "The budget is negative");
+    }
+
+    gpu_memory_budget_.SetBudget(budget.has_value()
+                                     ? std::make_optional<size_t>(*budget)
+                                     : std::nullopt);
+    gpu_memory_budget_.Update();
+    UpdateGpuMemoryBudgetTimer();
+    return result->Success();
+  }
+
+  if (method_call.method_name().compare(kMethodGetGpuMemoryUsage) == 0) {
+    gpu_memory_budget_.Update();
+
+    flutter::EncodableMap instances;
+    for (const auto& [texture_id, bytes] : gpu_memory_budget_.GetUsage()) {
+      instances[flutter::EncodableValue(texture_id)] =
+          flutter::EncodableValue(static_cast<int64_t>(bytes));
+    }
+
+    const auto budget = gpu_memory_budget_.budget();
+    return result->Success(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("budget"),
+         budget.has_value()
+             ? flutter::EncodableValue(static_cast<int64_t>(*budget))
+             : flutter::EncodableValue()},
+        {flutter::EncodableValue("total"),
+         flutter::EncodableValue(
+             static_cast<int64_t>(gpu_memory_budget_.total_usage()))},
+        {flutter::EncodableValue("instances"),
+         flutter::EncodableValue(std::move(instances))},
+    }));
+  }
+
+  if (method_call.method_name().compare(kMethodGetPointerInfoPoolStats) ==
+      0) {
+    if (!webview_host_) {
+      return result->Success();
+    }
+
+    const auto stats = webview_host_->pointer_info_pool_stats();
+    return result->Success(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("hits"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.hits))},
+        {flutter::EncodableValue("misses"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.misses))},
+        {flutter::EncodableValue("failures"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.failures))},
+        {flutter::EncodableValue("active"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.active))},
+        {flutter::EncodableValue("idle"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.idle))},
+    }));
   }
 
   if (method_call.method_name().compare(kMethodDispose) == 0) {
     if (const auto texture_id = std::get_if<int64_t>(method_call.arguments())) {
       const auto it = instances_.find(*texture_id);
       if (it != instances_.end()) {
+        gpu_memory_budget_.RemoveClient(*texture_id);
         instances_.erase(it);
+        UpdateGpuMemoryBudgetTimer();
         return result->Success();
       }
     }
@@ -180,6 +312,7 @@ void WebviewWindowsPlugin::HandleMethodCall(
 }
 
 void WebviewWindowsPlugin::CreateWebviewInstance(
+    const TextureBridgeOptions& texture_bridge_options,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
   if (!InitPlatform()) {
     return result->Error(kErrorUnsupportedPlatform,
@@ -202,8 +335,9 @@ void WebviewWindowsPlugin::CreateWebviewInstance(
       shared_result = std::move(result);
   webview_host_->CreateWebview(
       hwnd, true, true,
-      [shared_result, this](std::unique_ptr<Webview> webview,
-                            std::unique_ptr<WebviewCreationError> error) {
+      [shared_result, texture_bridge_options, this](
+          std::unique_ptr<Webview> webview,
+          std::unique_ptr<WebviewCreationError> error) {
         if (!webview) {
           if (error) {
             return shared_result->Error(
@@ -218,19 +352,38 @@ void WebviewWindowsPlugin::CreateWebviewInstance(
 
         auto bridge = std::make_unique<WebviewBridge>(
             messenger_, textures_, platform_->graphics_context(),
-            std::move(webview));
+            platform_->task_runner(), std::move(webview),
+            texture_bridge_options);
         auto texture_id = bridge->texture_id();
+        const auto pixel_format = bridge->texture_bridge()->pixel_format();
+        gpu_memory_budget_.AddClient(texture_id, bridge->texture_bridge());
         instances_[texture_id] = std::move(bridge);
+        UpdateGpuMemoryBudgetTimer();
 
         auto response = flutter::EncodableValue(flutter::EncodableMap{
             {flutter::EncodableValue("textureId"),
              flutter::EncodableValue(texture_id)},
+            {flutter::EncodableValue("pixelFormat"),
+             flutter::EncodableValue(static_cast<int32_t>(pixel_format))},
         });
 
         shared_result->Success(response);
       });
 }
 
+void WebviewWindowsPlugin::UpdateGpuMemoryBudgetTimer() {
+  if (!gpu_memory_budget_.budget().has_value() || instances_.empty()) {
+    gpu_memory_budget_timer_ = nullptr;
+    return;
+  }
+
+  if (!gpu_memory_budget_timer_) {
+    gpu_memory_budget_timer_ = platform_->task_runner()->CreateTimer(
+        kGpuMemoryBudgetUpdateInterval,
+        [this]() { gpu_memory_budget_.Update(); });
+  }
+}
+
 bool WebviewWindowsPlugin::InitPlatform() {
   if (!platform_) {
     platform_ = std::make_unique<WebviewPlatform>();